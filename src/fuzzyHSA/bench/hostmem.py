@@ -0,0 +1,254 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+CPU access bandwidth and latency of memory allocated with each flag combination.
+
+Every combination of FLAG_COMBINATIONS is allocated through allocate_memory
+and CPU mapped through its buffer object, then measured with:
+
+- seq_read, seq_write: memmove between the buffer and cached host memory, GB/s,
+- stream_write: the streaming copy of streaming.py into the buffer, GB/s,
+- rand_read, rand_write: independent 8-byte accesses to random 64-byte lines,
+  millions per second,
+- latency: a dependent chain of loads through random lines, ns per load.
+
+Plain anonymous memory is always measured as the baseline, so the harness
+runs without a GPU. Random accesses need the native helper; without a C
+compiler those columns are None. The CSV output (``fuzzyHSA bench hostmem
+--csv``) is meant to be read back when choosing allocation flags.
+"""
+
+import array
+import ctypes
+import mmap
+import random
+import time
+from contextlib import contextmanager
+from typing import Any, Callable, Dict, Iterator, List, Optional, Tuple
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from fuzzyHSA.kfd import libc, native
+from fuzzyHSA.kfd.streaming import copier, PythonCopier
+
+LINE = 64
+RANDOM_ACCESSES = 1 << 20
+COLUMNS = [
+    "seq_read",
+    "seq_write",
+    "stream_write",
+    "rand_read",
+    "rand_write",
+    "latency",
+]
+
+_VRAM = kfd.KFD_IOC_ALLOC_MEM_FLAGS_VRAM | kfd.KFD_IOC_ALLOC_MEM_FLAGS_PUBLIC
+_GTT = kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT
+_W = kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE
+_C = kfd.KFD_IOC_ALLOC_MEM_FLAGS_COHERENT
+_U = kfd.KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED
+
+# UNCACHED is only meaningful together with COHERENT, and VRAM needs PUBLIC to be CPU visible
+FLAG_COMBINATIONS: List[Tuple[str, int]] = [
+    ("gtt", _GTT),
+    ("gtt_w", _GTT | _W),
+    ("gtt_w_coherent", _GTT | _W | _C),
+    ("gtt_w_uncached", _GTT | _W | _C | _U),
+    ("vram", _VRAM),
+    ("vram_w", _VRAM | _W),
+    ("vram_w_coherent", _VRAM | _W | _C),
+    ("vram_w_uncached", _VRAM | _W | _C | _U),
+]
+
+SOURCE = r"""
+#include <stddef.h>
+#include <stdint.h>
+
+/* follows the chain of line indices stored in the first word of each line */
+uint64_t fz_chase(const volatile uint64_t *buf, uint64_t line, size_t steps) {
+    for (size_t i = 0; i < steps; i++)
+        line = buf[line * 8];
+    return line;
+}
+
+uint64_t fz_random_read(const volatile uint64_t *buf, const uint32_t *lines, size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += buf[(size_t)lines[i] * 8 + 1];
+    return sum;
+}
+
+void fz_random_write(volatile uint64_t *buf, const uint32_t *lines, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        buf[(size_t)lines[i] * 8 + 1] = i;
+}
+"""
+
+PLAIN = PythonCopier()
+
+
+def _load_native() -> Any:
+    lib = native.build("hostmem", SOURCE)
+    if lib is None:
+        return None
+    ptr, size, u64 = ctypes.c_void_p, ctypes.c_size_t, ctypes.c_uint64
+    for fn, argtypes, restype in [
+        (lib.fz_chase, [ptr, u64, size], u64),
+        (lib.fz_random_read, [ptr, ptr, size], u64),
+        (lib.fz_random_write, [ptr, ptr, size], None),
+    ]:
+        fn.argtypes, fn.restype = argtypes, restype
+    return lib
+
+
+def _best(fn: Callable[[], Any], repeat: int) -> float:
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+@contextmanager
+def anonymous_buffer(size: int) -> Iterator[int]:
+    addr = libc.mmap(
+        size, mmap.PROT_READ | mmap.PROT_WRITE, mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS
+    )
+    try:
+        yield addr
+    finally:
+        libc.munmap(addr, size)
+
+
+@contextmanager
+def device_buffer(device: Any, kfd_flags: int, size: int) -> Iterator[int]:
+    """Allocates ``size`` bytes with ``kfd_flags`` and maps the buffer object for the CPU."""
+    config = {
+        "mmap_prot": 0,
+        "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS | libc.MAP_NORESERVE,
+        "kfd_flags": kfd_flags,
+        "host_map": True,
+    }
+    mem = device.allocate_memory(size, config)
+    try:
+        yield mem.va_addr
+    finally:
+        device.free_gpu_memory(mem)
+
+
+def measure(
+    addr: int, size: int, repeat: int = 3, lib: Any = None
+) -> Dict[str, Optional[float]]:
+    """Measures the buffer of ``size`` bytes at ``addr``, see the module docstring for the columns."""
+    lines = size // LINE
+    stream = copier()
+    results: Dict[str, Optional[float]] = dict.fromkeys(COLUMNS)
+    with anonymous_buffer(size) as host:
+        ctypes.memset(host, 1, size)
+        ctypes.memset(addr, 1, size)
+        results["seq_read"] = (
+            size / _best(lambda: PLAIN.read(host, addr, size), repeat) / 1e9
+        )
+        results["seq_write"] = (
+            size / _best(lambda: PLAIN.copy(addr, host, size), repeat) / 1e9
+        )
+        results["stream_write"] = (
+            size / _best(lambda: stream.copy(addr, host, size), repeat) / 1e9
+        )
+    if lib is None or lines < 2:
+        return results
+    order = list(range(lines))
+    random.Random(0).shuffle(order)
+    chain = array.array("Q", bytes(size))
+    for line, successor in zip(order, order[1:] + order[:1]):
+        chain[line * 8] = successor
+    stream.copy(addr, chain, size)
+    rng = random.Random(1)
+    picks = array.array("I", (rng.randrange(lines) for _ in range(RANDOM_ACCESSES)))
+    picks_addr = picks.buffer_info()[0]
+    n = len(picks)
+    results["rand_read"] = (
+        n / _best(lambda: lib.fz_random_read(addr, picks_addr, n), repeat) / 1e6
+    )
+    results["rand_write"] = (
+        n / _best(lambda: lib.fz_random_write(addr, picks_addr, n), repeat) / 1e6
+    )
+    # random accesses use the second word of each line, the chain is intact
+    steps = min(n, lines * 4)
+    results["latency"] = (
+        _best(lambda: lib.fz_chase(addr, order[0], steps), repeat) / steps * 1e9
+    )
+    return results
+
+
+def run(
+    device: Any = None,
+    size: int = 16 << 20,
+    repeat: int = 3,
+    combinations: Optional[List[Tuple[str, int]]] = None,
+) -> List[Dict[str, Any]]:
+    """
+    Measures anonymous memory and, given a device, every flag combination.
+
+    Combinations the device refuses to allocate or map are reported with an
+    ``error`` instead of measurements.
+
+    Returns:
+        List[Dict[str, Any]]: One row per buffer kind with ``name``, ``kfd_flags`` and COLUMNS.
+    """
+    lib = _load_native()
+    rows = []
+    with anonymous_buffer(size) as addr:
+        rows.append(
+            {"name": "anonymous", "kfd_flags": 0, **measure(addr, size, repeat, lib)}
+        )
+    if device is None:
+        return rows
+    for name, flags in combinations or FLAG_COMBINATIONS:
+        row: Dict[str, Any] = {"name": name, "kfd_flags": flags}
+        try:
+            with device_buffer(device, flags, size) as addr:
+                row.update(measure(addr, size, repeat, lib))
+        except (OSError, RuntimeError) as e:
+            row["error"] = str(e)
+        rows.append(row)
+    return rows
+
+
+def _cell(value: Optional[float]) -> str:
+    return "-" if value is None else f"{value:.2f}"
+
+
+def format_table(rows: List[Dict[str, Any]]) -> str:
+    header = f"{'name':<18}{'kfd_flags':>12}" + "".join(f"{c:>14}" for c in COLUMNS)
+    lines = [header, "-" * len(header)]
+    for row in rows:
+        line = f"{row['name']:<18}{row['kfd_flags']:>#12x}"
+        if "error" in row:
+            line += f"  error: {row['error']}"
+        else:
+            line += "".join(f"{_cell(row[c]):>14}" for c in COLUMNS)
+        lines.append(line)
+    units = (
+        "GB/s: seq_read seq_write stream_write, M/s: rand_read rand_write, ns: latency"
+    )
+    return "\n".join(lines + ["", units])
+
+
+def format_csv(rows: List[Dict[str, Any]]) -> str:
+    lines = [",".join(["name", "kfd_flags", *COLUMNS, "error"])]
+    for row in rows:
+        cells = [row["name"], f"{row['kfd_flags']:#x}"]
+        cells += ["" if row.get(c) is None else f"{row[c]:.4f}" for c in COLUMNS]
+        lines.append(",".join(cells + [row.get("error", "")]))
+    return "\n".join(lines)
@@ -0,0 +1,84 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Testcases per second of a queue-using program with and without a QueuePool.
+
+Runs on the emulated backend by default, where create_queue and
+destroy_queue sleep for a configurable time to stand in for their kernel
+cost, so the result shows what pooling saves independently of the hardware.
+The testcase stands in for the engine as well and consumes what it submits,
+so released queues are idle and the pool reuses them.
+"""
+
+import time
+from typing import Callable, Dict, Optional
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from fuzzyHSA.kfd.emulated import EmulatedKFD, EmulatedKFDDevice, emulated_context
+from fuzzyHSA.kfd.ops import KFDDevice
+from fuzzyHSA.kfd.queues import Queue, QueuePool, create_sdma_queue
+
+# rough kernel cost of the queue ioctls, create_queue maps an MQD and the HQD
+DEFAULT_LATENCY = {"create_queue": 1e-3, "destroy_queue": 5e-4}
+
+
+def _testcase(queue: Queue) -> None:
+    queue.write_pointer.value += 64
+    queue.read_pointer.value = queue.write_pointer.value
+
+
+def testcases_per_second(
+    device: KFDDevice,
+    count: int,
+    pooled: bool,
+    testcase: Callable[[Queue], None] = _testcase,
+) -> float:
+    """Runs ``count`` testcases that each need one SDMA queue and returns their rate."""
+    sdma = kfd.KFD_IOC_QUEUE_TYPE_SDMA
+    start = time.perf_counter()
+    if pooled:
+        with QueuePool(device, {sdma: 1}) as pool:
+            for _ in range(count):
+                with pool.lease(sdma) as queue:
+                    testcase(queue)
+    else:
+        for _ in range(count):
+            queue = create_sdma_queue(device)
+            try:
+                testcase(queue)
+            finally:
+                queue.destroy()
+    return count / (time.perf_counter() - start)
+
+
+def run(
+    count: int = 200, latency: Optional[Dict[str, float]] = None
+) -> Dict[str, float]:
+    """Benchmarks both modes on an emulated device and returns testcases/sec for each."""
+    context = emulated_context(ioctls=EmulatedKFD(latency or DEFAULT_LATENCY))
+    with EmulatedKFDDevice(context=context) as device:
+        return {
+            mode: testcases_per_second(device, count, pooled=mode == "pooled")
+            for mode in ("unpooled", "pooled")
+        }
+
+
+def main() -> None:
+    rates = run()
+    for mode, rate in rates.items():
+        print(f"{mode:>8}: {rate:10.1f} testcases/s")
+    print(f" speedup: {rates['pooled'] / rates['unpooled']:10.1f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,269 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+SDMA copy bandwidth and completion latency, the numbers transfer chunking is tuned from.
+
+Every measurement submits COPY_LINEAR packets followed by a FENCE to one
+SDMA queue and polls the fence value from the CPU:
+
+- latency: doorbell to fence of a single copy, best of ``repeat``, in us,
+- bandwidth: ``repeat`` copies submitted back to back with one fence, GB/s,
+- the queue-depth sweep keeps ``depth`` fenced copies of one size in flight
+  and reports GB/s, which shows how many submissions hide the per-packet
+  and doorbell overhead.
+
+Sizes go from 4 KiB to 1 GiB in steps of 4x, for the directions of
+DIRECTIONS. "host" is anonymous memory registered as userptr.
+
+Without a device, or on an EmulatedKFDDevice, the packets are executed on
+the CPU by sdma_emu.SDMAEngine, which exercises the harness in tests; the
+numbers then describe memmove, not the engine.
+"""
+
+import contextlib
+import ctypes
+import mmap
+import time
+from typing import Any, Dict, Iterator, List, Sequence, Tuple
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from fuzzyHSA.kfd import libc
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.sdma import SDMAStream
+from fuzzyHSA.kfd.sdma_emu import SDMAEngine
+
+SIZES = [4096 << 2 * i for i in range(10)]  # 4 KiB .. 1 GiB
+DEPTHS = [1, 2, 4, 8, 16, 32]
+DEPTH_SIZE = 1 << 20
+DIRECTIONS = ["host_gtt", "gtt_vram", "vram_vram"]
+COLUMNS = ["latency_us", "bandwidth"]
+
+FENCE_MASK = 0xFFFFFFFF
+
+
+class CopyBench:
+    """
+    One SDMA queue and fence page submitting fenced copies.
+
+    Args:
+        device (KFDDevice): The device to create the queue on.
+        emulate (bool): Whether the copies are executed by an SDMAEngine on the CPU.
+        timeout (float): Seconds to wait for a fence before giving up.
+    """
+
+    def __init__(self, device: Any, emulate: bool = False, timeout: float = 10.0):
+        self.device = device
+        self.emulate = emulate
+        self.timeout = timeout
+        self.queue = device.create_queue(kfd.KFD_IOC_QUEUE_TYPE_SDMA)
+        self.writer = self.queue.ring_writer()
+        self.fence_page = device.allocate_memory(
+            mmap.PAGESIZE,
+            _config(kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT, host_map=True),
+            map_to_gpu=True,
+        )
+        self.fence = ctypes.c_uint32.from_address(self.fence_page.va_addr)
+        # an EmulatedKFD created with sdma_engine=True already runs the queue
+        running = getattr(device.KFD_IOCTL, "sdma_engines", {})
+        self.engine = None
+        if emulate and self.queue.queue_id not in running:
+            self.engine = SDMAEngine.for_queue(self.queue)
+        self.seq = 0
+
+    def submit(self, dst: int, src: int, size: int, count: int = 1) -> int:
+        """Submits ``count`` copies of ``size`` bytes and a fence; returns the fence value."""
+        self.seq = (self.seq + 1) & FENCE_MASK
+        stream = SDMAStream()
+        stream.copy_linear([dst] * count, [src] * count, [size] * count)
+        stream.fence([self.fence_page.va_addr], [self.seq])
+        self.writer.submit(stream, self.timeout)
+        return self.seq
+
+    def wait(self, seq: int) -> None:
+        """Polls until the fence reached ``seq``, executing the ring when emulating."""
+        deadline = time.monotonic() + self.timeout
+        while (self.fence.value - seq) & FENCE_MASK > FENCE_MASK >> 1:
+            if self.engine is not None:
+                self.engine.process()
+            else:
+                time.sleep(0)  # lets an engine thread of the emulated driver run
+            if time.monotonic() > deadline:
+                raise TimeoutError(f"SDMA fence {seq} not reached")
+
+    def latency(self, dst: int, src: int, size: int, repeat: int) -> float:
+        best = float("inf")
+        for _ in range(repeat):
+            start = time.perf_counter()
+            self.wait(self.submit(dst, src, size))
+            best = min(best, time.perf_counter() - start)
+        return best
+
+    def bandwidth(self, dst: int, src: int, size: int, repeat: int) -> float:
+        start = time.perf_counter()
+        self.wait(self.submit(dst, src, size, repeat))
+        return size * repeat / (time.perf_counter() - start) / 1e9
+
+    def depth(self, dst: int, src: int, size: int, depth: int, count: int) -> float:
+        """GB/s of ``count`` fenced copies with at most ``depth`` of them outstanding."""
+        in_flight: List[int] = []
+        start = time.perf_counter()
+        for _ in range(count):
+            if len(in_flight) == depth:
+                self.wait(in_flight.pop(0))
+            in_flight.append(self.submit(dst, src, size))
+        self.wait(in_flight[-1])
+        return size * count / (time.perf_counter() - start) / 1e9
+
+
+def _config(kfd_flags: int, host_map: bool = False) -> Dict[str, Any]:
+    if kfd_flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_VRAM:
+        # the anonymous mapping only reserves the range, unless the emulation maps the BO
+        prot, flags = 0, mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS | libc.MAP_NORESERVE
+    else:
+        prot, flags = (
+            mmap.PROT_READ | mmap.PROT_WRITE,
+            mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
+        )
+    return {
+        "mmap_prot": prot,
+        "mmap_flags": flags,
+        "kfd_flags": kfd_flags | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE,
+        "host_map": host_map,
+    }
+
+
+def _buffer(bench: CopyBench, scope: Any, kind: str, size: int) -> int:
+    device = bench.device
+    if kind == "host":
+        addr = device.mmap(
+            size,
+            mmap.PROT_READ | mmap.PROT_WRITE,
+            mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+            -1,
+        )
+        try:
+            mem = device.allocate_userptr(addr, size)
+        except Exception:
+            device.munmap(addr, size)
+            raise
+        # the device now unmaps the pages, after the userptr BO is freed
+        mem.host_owned = True
+        device.map_memory_to_gpu(mem)
+        return addr
+    flags = {
+        "gtt": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT,
+        "vram": kfd.KFD_IOC_ALLOC_MEM_FLAGS_VRAM,
+    }
+    mem = device.allocate_memory(
+        size, _config(flags[kind], host_map=bench.emulate), map_to_gpu=True
+    )
+    return mem.va_addr
+
+
+@contextlib.contextmanager
+def buffers(bench: CopyBench, direction: str, size: int) -> Iterator[Tuple[int, int]]:
+    """Allocates the destination and source of a direction, e.g. "gtt_vram", in an arena."""
+    src_kind, dst_kind = direction.split("_")
+    with bench.device.arena() as scope:
+        src = _buffer(bench, scope, src_kind, size)
+        yield _buffer(bench, scope, dst_kind, size), src
+
+
+def run(
+    device: Any = None,
+    sizes: Sequence[int] = SIZES,
+    directions: Sequence[str] = DIRECTIONS,
+    depths: Sequence[int] = DEPTHS,
+    depth_size: int = DEPTH_SIZE,
+    repeat: int = 5,
+) -> Dict[str, List[Dict[str, Any]]]:
+    """
+    Measures every direction over ``sizes`` and the queue-depth sweep at ``depth_size``.
+
+    Returns:
+        Dict[str, List[Dict[str, Any]]]: ``sizes`` rows with ``direction``, ``size`` and
+        COLUMNS, and ``depths`` rows with ``direction``, ``size``, ``depth`` and ``bandwidth``.
+    """
+    owned = device is None
+    if owned:
+        device = EmulatedKFDDevice()
+    results: Dict[str, List[Dict[str, Any]]] = {"sizes": [], "depths": []}
+    try:
+        with device.arena():
+            bench = CopyBench(device, emulate=isinstance(device, EmulatedKFDDevice))
+            for direction in directions:
+                with buffers(bench, direction, max([*sizes, depth_size])) as (dst, src):
+                    for size in sizes:
+                        results["sizes"].append(
+                            {
+                                "direction": direction,
+                                "size": size,
+                                "latency_us": bench.latency(dst, src, size, repeat)
+                                * 1e6,
+                                "bandwidth": bench.bandwidth(dst, src, size, repeat),
+                            }
+                        )
+                    for depth in depths:
+                        results["depths"].append(
+                            {
+                                "direction": direction,
+                                "size": depth_size,
+                                "depth": depth,
+                                "bandwidth": bench.depth(
+                                    dst, src, depth_size, depth, depth * repeat
+                                ),
+                            }
+                        )
+    finally:
+        if owned:
+            device.close()
+    return results
+
+
+def _size(size: int) -> str:
+    for unit, shift in (("G", 30), ("M", 20), ("K", 10)):
+        if size >= 1 << shift and size % (1 << shift) == 0:
+            return f"{size >> shift}{unit}"
+    return str(size)
+
+
+def format_table(results: Dict[str, List[Dict[str, Any]]]) -> str:
+    lines = [f"{'direction':<12}{'size':>8}{'latency us':>14}{'GB/s':>10}"]
+    for row in results["sizes"]:
+        lines.append(
+            f"{row['direction']:<12}{_size(row['size']):>8}"
+            f"{row['latency_us']:>14.1f}{row['bandwidth']:>10.2f}"
+        )
+    lines += ["", f"{'direction':<12}{'size':>8}{'depth':>8}{'GB/s':>10}"]
+    for row in results["depths"]:
+        lines.append(
+            f"{row['direction']:<12}{_size(row['size']):>8}"
+            f"{row['depth']:>8}{row['bandwidth']:>10.2f}"
+        )
+    return "\n".join(lines)
+
+
+def format_csv(results: Dict[str, List[Dict[str, Any]]]) -> str:
+    """One CSV table for both sweeps, told apart by the ``sweep`` column."""
+    lines = ["sweep,direction,size,depth,latency_us,bandwidth"]
+    for row in results["sizes"]:
+        lines.append(
+            f"size,{row['direction']},{row['size']},1,"
+            f"{row['latency_us']:.3f},{row['bandwidth']:.4f}"
+        )
+    for row in results["depths"]:
+        lines.append(
+            f"depth,{row['direction']},{row['size']},{row['depth']},,"
+            f"{row['bandwidth']:.4f}"
+        )
+    return "\n".join(lines)
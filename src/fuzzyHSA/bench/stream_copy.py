@@ -0,0 +1,98 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+GB/s of the streaming copies of streaming.py against memmove and memset.
+
+The destination is anonymous host memory by default. Given a device and
+memory flags, e.g. UNCACHED GTT or host visible VRAM, it is allocated with
+allocate_memory instead, which is where streaming stores pay off the most;
+on cached memory they mainly avoid evicting the caches.
+"""
+
+import ctypes
+import mmap
+import time
+from typing import Any, Callable, Dict, Optional
+
+from fuzzyHSA.kfd import libc
+from fuzzyHSA.kfd.streaming import copier, PythonCopier
+
+PLAIN = PythonCopier()
+
+
+def _best_gbps(fn: Callable[[], None], size: int, repeat: int) -> float:
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        best = min(best, time.perf_counter() - start)
+    return size / best / 1e9
+
+
+def run(
+    size: int = 64 << 20,
+    repeat: int = 5,
+    device: Any = None,
+    memory_flags: Optional[Dict[str, int]] = None,
+) -> Dict[str, float]:
+    """
+    Measures host to destination copies, fills and reads back of ``size`` bytes.
+
+    Returns:
+        Dict[str, float]: The best GB/s over ``repeat`` runs per operation.
+    """
+    prot, flags = (
+        mmap.PROT_READ | mmap.PROT_WRITE,
+        mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+    )
+    src = libc.mmap(size, prot, flags)
+    back = libc.mmap(size, prot, flags)
+    mem = None
+    if device is not None:
+        mem = device.allocate_memory(size, memory_flags, map_to_gpu=False)
+        dst = mem.va_addr
+    else:
+        dst = libc.mmap(size, prot, flags)
+    try:
+        for addr in (src, back, dst):
+            ctypes.memset(addr, 1, size)  # fault every page in before timing
+        stream = copier()
+        ops = {
+            "memmove": lambda: PLAIN.copy(dst, src, size),
+            "stream_copy": lambda: stream.copy(dst, src, size),
+            "memset": lambda: PLAIN.fill(dst, 0, size),
+            "stream_fill": lambda: stream.fill(dst, 0, size),
+            "memmove_read": lambda: PLAIN.read(back, dst, size),
+            "stream_read": lambda: stream.read(back, dst, size),
+        }
+        return {name: _best_gbps(fn, size, repeat) for name, fn in ops.items()}
+    finally:
+        if mem is not None:
+            device.free_gpu_memory(mem)
+        else:
+            libc.munmap(dst, size)
+        libc.munmap(src, size)
+        libc.munmap(back, size)
+
+
+def main() -> None:
+    print(f"copier: {type(copier()).__name__}")
+    results = run()
+    for name, gbps in results.items():
+        print(f"{name:>12}: {gbps:8.2f} GB/s")
+    for plain, streamed in [("memmove", "stream_copy"), ("memset", "stream_fill")]:
+        print(f"{streamed:>12}: {results[streamed] / results[plain]:8.2f}x {plain}")
+
+
+if __name__ == "__main__":
+    main()
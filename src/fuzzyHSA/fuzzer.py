@@ -10,20 +10,111 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import argparse
+from typing import List, Optional
+
 from .utils import check_generated_files
 from fuzzyHSA.kfd.ops import KFDDevice
 
 REQUIRED_FILES = ["kfd.py", "hsa.py", "amd_gpu.py"]
 
 
-def main():
+def parse_size(text: str) -> int:
+    """Parses a byte count with an optional K, M or G suffix, e.g. "16M"."""
+    units = {"K": 1 << 10, "M": 1 << 20, "G": 1 << 30}
+    suffix = text[-1:].upper()
+    return int(text[:-1]) * units[suffix] if suffix in units else int(text)
+
+
+def bench_hostmem(args: argparse.Namespace) -> None:
+    from fuzzyHSA.bench import hostmem
+
+    device = KFDDevice(args.device) if args.device else None
+    try:
+        rows = hostmem.run(device, size=args.size, repeat=args.repeat)
+    finally:
+        if device is not None:
+            device.close()
+    print(hostmem.format_csv(rows) if args.csv else hostmem.format_table(rows))
+
+
+def bench_sdma(args: argparse.Namespace) -> None:
+    from fuzzyHSA.bench import sdma_copy
+
+    sizes = [s for s in sdma_copy.SIZES if args.min_size <= s <= args.max_size]
+    device = KFDDevice(args.device) if args.device else None
+    try:
+        results = sdma_copy.run(
+            device,
+            sizes=sizes,
+            directions=args.directions or sdma_copy.DIRECTIONS,
+            depths=args.depths or sdma_copy.DEPTHS,
+            depth_size=args.depth_size,
+            repeat=args.repeat,
+        )
+    finally:
+        if device is not None:
+            device.close()
+    print(
+        sdma_copy.format_csv(results) if args.csv else sdma_copy.format_table(results)
+    )
+
+
+def build_parser() -> argparse.ArgumentParser:
+    parser = argparse.ArgumentParser(prog="fuzzyHSA")
+    commands = parser.add_subparsers(dest="command")
+    bench = commands.add_parser("bench", help="run a benchmark")
+    suites = bench.add_subparsers(dest="suite", required=True)
+
+    hostmem = suites.add_parser(
+        "hostmem", help="CPU bandwidth and latency per allocation flag combination"
+    )
+    hostmem.add_argument(
+        "--device",
+        help='GPU to allocate on, e.g. "KFD:0"; anonymous memory only without',
+    )
+    hostmem.add_argument("--size", type=parse_size, default=16 << 20)
+    hostmem.add_argument("--repeat", type=int, default=3)
+    hostmem.add_argument(
+        "--csv", action="store_true", help="print CSV instead of a table"
+    )
+    hostmem.set_defaults(run=bench_hostmem)
+
+    sdma = suites.add_parser(
+        "sdma", help="SDMA copy bandwidth, latency and queue-depth sweep"
+    )
+    sdma.add_argument(
+        "--device",
+        help='GPU to copy on, e.g. "KFD:0"; an engine emulated on the CPU without',
+    )
+    sdma.add_argument("--min-size", type=parse_size, default=4 << 10)
+    sdma.add_argument("--max-size", type=parse_size, default=1 << 30)
+    sdma.add_argument("--depth-size", type=parse_size, default=1 << 20)
+    sdma.add_argument("--depths", type=int, nargs="+", help="default 1 to 32")
+    sdma.add_argument(
+        "--directions",
+        nargs="+",
+        choices=["host_gtt", "gtt_vram", "vram_vram"],
+        help="default all",
+    )
+    sdma.add_argument("--repeat", type=int, default=5)
+    sdma.add_argument("--csv", action="store_true", help="print CSV instead of a table")
+    sdma.set_defaults(run=bench_sdma)
+    return parser
+
+
+def main(argv: Optional[List[str]] = None):
+    args = build_parser().parse_args(argv)
     try:
         check_generated_files(REQUIRED_FILES)
-        print("All required files are present. Continuing with main execution.")
-        # TODO: continue main execution here
     except RuntimeError as e:
         print(f"Startup Error: {e}")
         return
+    if args.command is None:
+        print("All required files are present. Continuing with main execution.")
+        # TODO: continue main execution here
+        return
+    args.run(args)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,163 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+asyncio API of a KFDDevice.
+
+ioctls block, so every call issuing one runs on a dedicated ioctl thread
+of the device and the event loop only awaits its result. The thread is a
+single worker: calls of one device keep their order, as they would on a
+synchronous device. Event waits go through an EventWaiter, whose futures
+are awaited directly. Queue submissions only write memory and never wait
+for a thread; a full ring is retried from the loop instead of spinning.
+
+Example:
+    async with KFDDevice("KFD:0") as device:
+        mem = await device.allocate_memory(size, config, map_to_gpu=True)
+        queue = await device.create_queue(kfd.KFD_IOC_QUEUE_TYPE_SDMA)
+        await device.submit(queue, stream)
+        await device.wait_event(event_id, check=lambda: fence.value >= 1)
+"""
+
+import asyncio
+import concurrent.futures
+import functools
+import time
+from typing import Any, Callable, Dict, Optional
+
+from .events import Check, EventWaiter
+from .ops import KFDDevice
+
+# first and longest sleep while waiting for ring space
+SUBMIT_BACKOFF = (5e-5, 2e-3)
+
+
+class AsyncKFDDevice:
+    """
+    Awaitable versions of the KFDDevice calls that block.
+
+    Attributes not defined here are forwarded to the wrapped device, so
+    non-blocking ones like ``gpu_id`` or ``context`` stay available.
+
+    Args:
+        device (KFDDevice): The device to drive.
+        owns_device (bool): Whether aclose also closes the device.
+        waiter_timeout_ms (int): Longest single wait of the event waiter thread.
+    """
+
+    def __init__(
+        self,
+        device: KFDDevice,
+        owns_device: bool = False,
+        waiter_timeout_ms: int = 1000,
+    ):
+        self.device = device
+        self.owns_device = owns_device
+        self.waiter_timeout_ms = waiter_timeout_ms
+        self._ioctl_thread = concurrent.futures.ThreadPoolExecutor(
+            max_workers=1, thread_name_prefix="kfd-ioctl"
+        )
+        self._waiter: Optional[EventWaiter] = None
+        self._writers: Dict[int, Any] = {}
+
+    def __getattr__(self, name: str) -> Any:
+        return getattr(self.device, name)
+
+    async def __aenter__(self) -> "AsyncKFDDevice":
+        return self
+
+    async def __aexit__(self, exc_type, exc_value, traceback) -> None:
+        await self.aclose()
+
+    async def run(self, fn: Callable[..., Any], *args, **kwargs) -> Any:
+        """Runs a blocking call on the device's ioctl thread."""
+        loop = asyncio.get_running_loop()
+        return await loop.run_in_executor(
+            self._ioctl_thread, functools.partial(fn, *args, **kwargs)
+        )
+
+    async def allocate_memory(
+        self, size: int, memory_flags: Dict[str, int], map_to_gpu: Optional[bool] = None
+    ) -> Any:
+        return await self.run(
+            self.device.allocate_memory, size, memory_flags, map_to_gpu
+        )
+
+    async def map_memory_to_gpu(self, mem: Any, gpu_ids: Optional[list] = None) -> None:
+        await self.run(self.device.map_memory_to_gpu, mem, gpu_ids)
+
+    async def free_gpu_memory(self, mem: Any) -> None:
+        await self.run(self.device.free_gpu_memory, mem)
+
+    async def create_queue(self, queue_type: Optional[int] = None, **kwargs) -> Any:
+        return await self.run(self.device.create_queue, queue_type, **kwargs)
+
+    async def destroy_queue(self, queue: Any) -> None:
+        self._writers.pop(id(queue), None)
+        await self.run(queue.destroy)
+
+    async def create_event(self, auto_reset: bool = True) -> Any:
+        return await self.run(self.device.create_event, auto_reset)
+
+    async def destroy_event(self, event_id: int) -> None:
+        await self.run(self.device.destroy_event, event_id)
+
+    async def submit(self, queue: Any, packets: Any, timeout: float = 10.0) -> int:
+        """
+        Submits packets (an AQL packet list or an SDMA stream) to a queue.
+
+        Returns:
+            int: What the queue's ring writer returns for the submission.
+
+        Raises:
+            TimeoutError: If the ring stays full for ``timeout`` seconds.
+        """
+        writer = self._writers.get(id(queue))
+        if writer is None:
+            writer = self._writers[id(queue)] = queue.ring_writer()
+        deadline = time.monotonic() + timeout
+        delay = SUBMIT_BACKOFF[0]
+        while True:
+            try:
+                # a zero timeout makes the writer fail at once instead of spinning
+                return writer.submit(packets, timeout=0)
+            except TimeoutError:
+                if time.monotonic() + delay > deadline:
+                    raise
+            await asyncio.sleep(delay)
+            delay = min(delay * 2, SUBMIT_BACKOFF[1])
+
+    async def wait_event(
+        self, event_id: int, check: Check = None, timeout: Optional[float] = None
+    ) -> int:
+        """
+        Waits for an event through the device's EventWaiter, see EventWaiter.watch.
+
+        Raises:
+            asyncio.TimeoutError: If the event does not fire within ``timeout`` seconds.
+        """
+        if self._waiter is None:
+            # creating the waiter creates its wake event, an ioctl
+            self._waiter = await self.run(
+                EventWaiter, self.device, self.waiter_timeout_ms
+            )
+        future = asyncio.wrap_future(self._waiter.watch(event_id, check))
+        return await asyncio.wait_for(future, timeout)
+
+    async def aclose(self) -> None:
+        """Stops the event waiter and the ioctl thread, and closes an owned device."""
+        if self._waiter is not None:
+            await self.run(self._waiter.close)
+            self._waiter = None
+        if self.owns_device:
+            await self.run(self.device.close)
+        self._ioctl_thread.shutdown(wait=True)
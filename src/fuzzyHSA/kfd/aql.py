@@ -0,0 +1,137 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import ctypes
+import time
+from typing import Sequence, Union
+
+import fuzzyHSA.kfd.autogen.hsa as hsa  # importing generated files via the fuzzyHSA package
+from .signals import default_atomics
+from .streaming import copier
+
+AQL_PACKET_SIZE = 64
+
+Packet = Union[bytes, bytearray, ctypes.Structure]
+
+
+def packet_header(
+    packet_type: int,
+    barrier: bool = False,
+    acquire: int = hsa.HSA_FENCE_SCOPE_SYSTEM,
+    release: int = hsa.HSA_FENCE_SCOPE_SYSTEM,
+) -> int:
+    """Builds the 16-bit AQL packet header."""
+    return (
+        packet_type << hsa.HSA_PACKET_HEADER_TYPE
+        | int(barrier) << hsa.HSA_PACKET_HEADER_BARRIER
+        | acquire << hsa.HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE
+        | release << hsa.HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE
+    )
+
+
+INVALID_HEADER = hsa.HSA_PACKET_TYPE_INVALID << hsa.HSA_PACKET_HEADER_TYPE
+
+
+def barrier_and_packet(completion_signal: int = 0, barrier: bool = True) -> Packet:
+    """A barrier-AND packet without dependencies, e.g. to signal completion of earlier work."""
+    pkt = hsa.hsa_barrier_and_packet_t()
+    pkt.header = packet_header(hsa.HSA_PACKET_TYPE_BARRIER_AND, barrier)
+    pkt.completion_signal.handle = completion_signal
+    return pkt
+
+
+def invalidate_ring(addr: int, size: int) -> None:
+    """Marks every packet slot of an AQL ring as INVALID, as the packet processor expects."""
+    for offset in range(0, size, AQL_PACKET_SIZE):
+        ctypes.c_uint16.from_address(addr + offset).value = INVALID_HEADER
+
+
+class AQLRingWriter:
+    """
+    Writes batches of AQL packets into a ring and rings the doorbell once per batch.
+
+    The packet processor may pick a slot up as soon as its header stops being
+    INVALID, so every packet is written in two steps: its body (bytes 8-63)
+    first, then its first 8 bytes, header and setup included, as one aligned
+    64-bit store. Headers are published in ring order after all bodies of the
+    batch are written, then ``write_dispatch_id`` is advanced and the doorbell
+    is written with the index of the last packet. These three stores are
+    release stores from signals.default_atomics(), so the ordering holds on
+    any CPU rather than relying on x86 and on how ctypes stores; bodies are
+    written with streaming stores, which each copy fences before returning.
+
+    All state is in memory given by address, so the writer works on a real
+    queue as well as on plain host buffers in tests.
+
+    Args:
+        ring_addr (int): Address of the ring, whose size is a power of two multiple of 64 bytes.
+        ring_size (int): Ring size in bytes.
+        write_ptr_addr (int): Address of the 64-bit write_dispatch_id.
+        read_ptr_addr (int): Address of the 64-bit read_dispatch_id the packet processor advances.
+        doorbell_addr (int): Address of the 64-bit doorbell.
+    """
+
+    def __init__(
+        self,
+        ring_addr: int,
+        ring_size: int,
+        write_ptr_addr: int,
+        read_ptr_addr: int,
+        doorbell_addr: int,
+    ):
+        self.slots = ring_size // AQL_PACKET_SIZE
+        assert (
+            self.slots and self.slots & (self.slots - 1) == 0
+        ), "ring must hold a power of two number of packets"
+        self.ring_addr = ring_addr
+        self.write_ptr = ctypes.c_uint64.from_address(write_ptr_addr)
+        self.read_ptr = ctypes.c_uint64.from_address(read_ptr_addr)
+        self.doorbell = ctypes.c_uint64.from_address(doorbell_addr)
+        self.doorbell_writes = 0
+        self.atomics = default_atomics()
+
+    def _slot(self, index: int) -> int:
+        return self.ring_addr + (index & (self.slots - 1)) * AQL_PACKET_SIZE
+
+    def wait_for_space(self, count: int, timeout: float = 10.0) -> None:
+        """Waits until the packet processor has consumed enough packets to write ``count`` more."""
+        assert count <= self.slots, "batch larger than the ring"
+        deadline = time.monotonic() + timeout
+        while self.write_ptr.value + count - self.read_ptr.value > self.slots:
+            if time.monotonic() > deadline:
+                raise TimeoutError("AQL ring is full, the queue is not making progress")
+            time.sleep(0)
+
+    def submit(self, packets: Sequence[Packet], timeout: float = 10.0) -> int:
+        """
+        Writes the packets and rings the doorbell once.
+
+        Returns:
+            int: The dispatch id of the first packet of the batch.
+        """
+        if not packets:
+            return self.write_ptr.value
+        self.wait_for_space(len(packets), timeout)
+        first = self.write_ptr.value
+        headers = []
+        for index, pkt in enumerate(packets, first):
+            raw = bytes(pkt)
+            assert len(raw) == AQL_PACKET_SIZE, "AQL packets are 64 bytes"
+            copier().copy(self._slot(index) + 8, raw[8:], AQL_PACKET_SIZE - 8)
+            headers.append(int.from_bytes(raw[:8], "little", signed=True))
+        store = self.atomics.store
+        for index, header in enumerate(headers, first):
+            store(self._slot(index), header)
+        store(ctypes.addressof(self.write_ptr), first + len(packets))
+        store(ctypes.addressof(self.doorbell), first + len(packets) - 1)
+        self.doorbell_writes += 1
+        return first
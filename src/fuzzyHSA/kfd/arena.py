@@ -0,0 +1,216 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Scoped resource arenas releasing everything created in a with block.
+
+Fuzz programs create buffers, mappings, events and queues per testcase and
+must tear all of them down before the next one. Freeing them one by one in
+reverse is slow (every free is an unmap, a munmap and a free) and leaks
+whatever a failing testcase did not get to. Inside ``with device.arena()``
+the device records each resource it creates, and on exit the arena releases
+them in dependency order:
+
+1. queues, before the rings and pointer pages the engines still read,
+2. events, before the event page could go away,
+3. GPU mappings of memory allocated outside the arena,
+4. the arena's allocations: all unmaps first, grouped by the set of GPUs
+   they are mapped on, then the frees, then the host ranges, with adjacent
+   ranges released by a single munmap.
+
+KFD unmaps one handle per ioctl (from all its GPUs at once), so the unmap
+batching is an ordering rather than fewer ioctls: no free runs until every
+GPU mapping is gone. Resources released explicitly inside the arena are
+forgotten by it. The context's event and signal pages outlive any arena.
+Teardown continues past failures and raises the first one at the end.
+
+Example:
+    with device.arena():
+        mem = device.allocate_memory(size, config, map_to_gpu=True)
+        queue = device.create_queue(kfd.KFD_IOC_QUEUE_TYPE_SDMA)
+        ...  # no cleanup needed
+"""
+
+import ctypes
+import mmap
+import threading
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+from .registry import owns_host_range
+
+
+def _page_round(size: int) -> int:
+    return (size + mmap.PAGESIZE - 1) & ~(mmap.PAGESIZE - 1)
+
+
+def coalesce(ranges: List[Tuple[int, int]]) -> List[Tuple[int, int]]:
+    """Merges (addr, size) host ranges that touch into single ranges, sorted by address."""
+    merged: List[Tuple[int, int]] = []
+    for addr, size in sorted(ranges):
+        size = _page_round(size)
+        if merged and merged[-1][0] + merged[-1][1] == addr:
+            merged[-1] = (merged[-1][0], merged[-1][1] + size)
+        else:
+            merged.append((addr, size))
+    return merged
+
+
+class Arena:
+    """
+    The resources a device created inside one with block, see the module docstring.
+
+    Arenas of a device nest; resources are recorded in the innermost one.
+    Recording is per device, not per thread, so resources other threads
+    create on the device while the arena is open belong to it as well.
+
+    Args:
+        device (KFDDevice): The device whose resources are recorded.
+    """
+
+    def __init__(self, device: Any):
+        self.device = device
+        self.queues: Dict[int, Any] = {}
+        self.events: Dict[int, int] = {}
+        self.mappings: Dict[int, Tuple[Any, List[int]]] = {}
+        self.allocations: Dict[int, Any] = {}
+        self.callbacks: List[Callable[[], None]] = []
+        self._lock = threading.Lock()
+
+    def __enter__(self) -> "Arena":
+        self.device._arenas.append(self)
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback) -> None:
+        self.close()
+
+    def defer(self, fn: Callable[[], None]) -> None:
+        """Runs ``fn`` first on exit, e.g. to release something made by a raw ioctl."""
+        with self._lock:
+            self.callbacks.append(fn)
+
+    def add_queue(self, queue: Any) -> None:
+        with self._lock:
+            self.queues[id(queue)] = queue
+
+    def add_event(self, event_id: int) -> None:
+        with self._lock:
+            self.events[event_id] = event_id
+
+    def add_allocation(self, mem: Any) -> None:
+        with self._lock:
+            self.allocations[mem.handle] = mem
+
+    def add_mapping(self, mem: Any, gpu_ids: List[int]) -> None:
+        """Records a mapping; mappings of the arena's own allocations need no record."""
+        with self._lock:
+            if mem.handle in self.allocations:
+                return
+            _, mapped = self.mappings.get(mem.handle, (mem, []))
+            self.mappings[mem.handle] = (
+                mem,
+                mapped + [g for g in gpu_ids if g not in mapped],
+            )
+
+    def forget(self, kind: str, key: int) -> None:
+        """Drops a resource released explicitly; ``kind`` names one of the record dicts."""
+        with self._lock:
+            getattr(self, kind).pop(key, None)
+
+    def _unmap(self, mem: Any, gpu_ids: List[int]) -> None:
+        device = self.device
+        ids = (ctypes.c_int32 * len(gpu_ids))(*gpu_ids)
+        result = device.KFD_IOCTL.unmap_memory_from_gpu(
+            device.kfd,
+            handle=mem.handle,
+            device_ids_array_ptr=ctypes.addressof(ids),
+            n_devices=len(gpu_ids),
+        )
+        if result.n_success != len(gpu_ids):
+            raise OSError(
+                f"unmapped handle {mem.handle:#x} from {result.n_success} GPUs"
+            )
+
+    def close(self) -> None:
+        """Releases every recorded resource; the arena is empty and inactive afterwards."""
+        device = self.device
+        if self in device._arenas:
+            device._arenas.remove(self)
+        with self._lock:
+            callbacks, self.callbacks = self.callbacks, []
+            queues, self.queues = list(self.queues.values()), {}
+            events, self.events = list(self.events.values()), {}
+            mappings, self.mappings = list(self.mappings.values()), {}
+            allocations, self.allocations = list(self.allocations.values()), {}
+        errors: List[Exception] = []
+
+        def attempt(fn: Callable, *args) -> bool:
+            try:
+                fn(*args)
+                return True
+            except Exception as e:
+                errors.append(e)
+                return False
+
+        for fn in reversed(callbacks):
+            attempt(fn)
+        for queue in reversed(queues):
+            attempt(queue.destroy, False)
+        for event_id in events:
+            attempt(device.destroy_event, event_id)
+        registry = device.context.allocations
+        for mem, gpu_ids in mappings:
+            if attempt(self._unmap, mem, gpu_ids):
+                registry.remove_mappings(mem, gpu_ids)
+
+        context_pages = (device.context.event_page, device.context.signals_page)
+        owned = [
+            m
+            for m in allocations
+            if not any(m is page for page in context_pages)
+            and attempt(registry.claim, m)
+        ]
+        by_gpus: Dict[Tuple[int, ...], List[Any]] = {}
+        for mem in owned:
+            gpu_ids = tuple(getattr(mem, "mapped_gpu_ids", ()))
+            if gpu_ids:
+                by_gpus.setdefault(gpu_ids, []).append(mem)
+        still_mapped = set()
+        for gpu_ids, group in by_gpus.items():
+            for mem in group:
+                if attempt(self._unmap, mem, list(gpu_ids)):
+                    registry.remove_mappings(mem, list(gpu_ids))
+                else:
+                    still_mapped.add(mem.handle)
+        host_ranges = []
+        for mem in owned:
+            freed = mem.handle not in still_mapped and attempt(
+                lambda: device.KFD_IOCTL.free_memory_of_gpu(
+                    device.kfd, handle=mem.handle
+                )
+            )
+            if not freed:
+                # the buffer object still exists, keep it recorded for a later free
+                registry.add(mem)
+            # the host range stays reserved until KFD dropped the GPU VA on it;
+            # userptr memory belongs to the caller
+            elif owns_host_range(mem):
+                host_ranges.append((mem.va_addr, mem.size))
+        for addr, size in coalesce(host_ranges):
+            attempt(device.munmap, addr, size)
+        if errors:
+            raise OSError(f"arena teardown failed: {errors[0]}") from errors[0]
+
+
+def current(device: Any) -> Optional[Arena]:
+    """Returns the innermost open arena of a device, or None."""
+    arenas = getattr(device, "_arenas", None)
+    return arenas[-1] if arenas else None
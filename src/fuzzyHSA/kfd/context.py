@@ -0,0 +1,157 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import threading
+import weakref
+from typing import Any, Callable, List, Optional, Set
+
+from .registry import AllocationRegistry
+from .topology import Topology, TopologyNode
+from .utils import ioctls_from_header
+
+
+def open_kfd() -> int:
+    return os.open("/dev/kfd", os.O_RDWR | os.O_CLOEXEC)
+
+
+class KFDContext:
+    """
+    The per-process KFD state shared by KFDDevice instances.
+
+    KFD binds a process to the /dev/kfd file descriptor it opened, and the
+    event and signal pages live in that process' address space. A context owns
+    this state and is shared explicitly: ``KFDContext.default()`` returns the
+    process-wide context, and ``duplicate()`` opens an independent one.
+    Devices ``acquire`` the context and ``release`` it on close; the fd is
+    closed when the last reference goes away, so closing one device no longer
+    breaks the others.
+
+    After ``fork`` the child must not use the parent's fd. An at-fork hook
+    drops the default context in the child, and every inherited context
+    reopens /dev/kfd and forgets the parent's pages and VMs; devices reset
+    their own state in a hook of their own, see KFDDevice._after_fork_in_child.
+
+    Attributes:
+        topology (Topology): The topology snapshot the context enumerates GPUs from.
+        gpus (List[TopologyNode]): The usable GPU nodes.
+        KFD_IOCTL (object): The ioctl functions used by devices of this context.
+        event_page (Any): The process' event page allocation, created by the first user.
+        signals_page (Any): The process' signal page allocation, created by the first user.
+        allocations (AllocationRegistry): The live allocations made through the context.
+        vms (Set[int]): gpu_ids whose GPU VM was acquired for the process, see KFDDevice.acquire_vm.
+    """
+
+    _default: Optional["KFDContext"] = None
+    _default_lock = threading.Lock()
+    # every open context, reset in the child after fork
+    _live: "weakref.WeakSet[KFDContext]" = weakref.WeakSet()
+
+    def __init__(
+        self,
+        topology: Optional[Topology] = None,
+        opener: Callable[[], int] = open_kfd,
+        ioctls: Any = None,
+    ):
+        self.topology = topology or Topology.load()
+        self.gpus: List[TopologyNode] = list(self.topology.gpus)
+        self.KFD_IOCTL = ioctls or ioctls_from_header()
+        self.event_page: Any = None
+        self.signals_page: Any = None
+        self.allocations = AllocationRegistry()
+        self.vms: Set[int] = set()
+        self._opener = opener
+        self._lock = threading.RLock()
+        self._refs = 0
+        try:
+            self._fd = opener()
+        except Exception as e:
+            raise RuntimeError(
+                f"Failed to initialize KFDContext with error: {e}"
+            ) from e
+        self._live.add(self)
+
+    @classmethod
+    def default(cls) -> "KFDContext":
+        """Returns the process-wide context, creating it on first use in this process."""
+        with cls._default_lock:
+            if cls._default is None or cls._default.closed:
+                cls._default = cls()
+            return cls._default
+
+    @classmethod
+    def _after_fork_in_child(cls) -> None:
+        cls._default = None
+        cls._default_lock = threading.Lock()
+        for context in list(cls._live):
+            context._reinitialize()
+
+    @property
+    def closed(self) -> bool:
+        return self._fd is None
+
+    @property
+    def kfd(self) -> int:
+        """The /dev/kfd file descriptor of the current process."""
+        if self._fd is None:
+            raise RuntimeError("KFDContext is closed")
+        return self._fd
+
+    def _reinitialize(self) -> None:
+        # the inherited fd, pages and VMs belong to the parent process; the
+        # child runs a single thread here, so the locks are simply replaced
+        self._lock = threading.RLock()
+        with self._lock:
+            if self._fd is not None and self._fd >= 0:
+                os.close(self._fd)
+            self.event_page = self.signals_page = None
+            self.allocations = AllocationRegistry()
+            self.vms = set()
+            try:
+                self._fd = self._opener() if self._fd is not None else None
+            except OSError:
+                self._fd = None  # the child cannot use KFD, so the context is closed
+
+    def acquire(self) -> "KFDContext":
+        """Adds a reference; every acquire must be paired with a release."""
+        with self._lock:
+            if self.closed:
+                raise RuntimeError("KFDContext is closed")
+            self._refs += 1
+            return self
+
+    def release(self) -> None:
+        """Drops a reference and closes the context when none are left."""
+        with self._lock:
+            assert self._refs > 0, "KFDContext released more often than acquired"
+            self._refs -= 1
+            if self._refs == 0:
+                self.close()
+
+    @property
+    def refcount(self) -> int:
+        return self._refs
+
+    def duplicate(self) -> "KFDContext":
+        """Opens an independent context sharing this context's topology snapshot."""
+        return type(self)(self.topology, self._opener, self.KFD_IOCTL)
+
+    def close(self) -> None:
+        """Closes the file descriptor; devices still using the context start failing."""
+        with self._lock:
+            if self._fd is not None and self._fd >= 0:
+                os.close(self._fd)
+            self._fd = None
+            self.event_page = self.signals_page = None
+
+
+os.register_at_fork(after_in_child=KFDContext._after_fork_in_child)
@@ -0,0 +1,246 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Decoder for SDMA and PM4 packet streams, e.g. ring snapshots taken after a hang.
+
+Decoding only walks the packet headers: every packet becomes a compact
+Record (offset, name, length), so a megabyte ring is scanned in a few
+milliseconds. Field values are decoded on demand for the packets of
+interest with Decoded.fields. Runs of zero dwords, as left by ring padding
+and never written slots, are collapsed into a single record.
+
+Example:
+    decoded = decode_ring(snapshot, rptr, wptr, "sdma")
+    hung = decoded.at(rptr % len(snapshot))
+    print(decoded.format())
+"""
+
+import bisect
+import re
+from array import array
+from typing import Dict, Iterator, List, NamedTuple, Optional, Union
+
+import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu  # importing generated files via the fuzzyHSA package
+from .sdma import SDMA_PKTS
+
+Buffer = Union[bytes, bytearray, memoryview]
+
+ENGINES = ("sdma", "pm4")
+
+
+class Record(NamedTuple):
+    offset: int  # byte offset of the packet in the decoded buffer
+    name: str
+    dwords: int
+    header: int
+    complete: bool = True  # False if the buffer ends inside the packet
+
+
+# (op, sub_op) of the SDMA packets in SDMA_PKTS; None matches every sub_op
+SDMA_OPCODES = {
+    "copy_linear": (amd_gpu.SDMA_OP_COPY, amd_gpu.SDMA_SUBOP_COPY_LINEAR),
+    "indirect": (amd_gpu.SDMA_OP_INDIRECT, None),
+    "fence": (amd_gpu.SDMA_OP_FENCE, None),
+    "trap": (amd_gpu.SDMA_OP_TRAP, None),
+    "poll_regmem": (amd_gpu.SDMA_OP_POLL_REGMEM, None),
+    "atomic": (amd_gpu.SDMA_OP_ATOMIC, None),
+    "constant_fill": (amd_gpu.SDMA_OP_CONST_FILL, None),
+    "timestamp": (amd_gpu.SDMA_OP_TIMESTAMP, None),
+}
+
+_SDMA_BY_OP, _SDMA_BY_OP_SUB = {}, {}
+for _name, (_op, _sub_op) in SDMA_OPCODES.items():
+    _info = (_name, len(bytes(getattr(SDMA_PKTS, _name)())) // 4)
+    if _sub_op is None:
+        _SDMA_BY_OP[_op] = _info
+    else:
+        _SDMA_BY_OP_SUB[_op | _sub_op << 8] = _info
+
+PM4_OPCODES = {
+    value: name[len("PACKET3_") :].lower()
+    for name, value in reversed(vars(amd_gpu).items())
+    if name.startswith("PACKET3_") and isinstance(value, int) and value < 0x100
+}
+
+_ZERO_RUN = re.compile(b"(?:\0\0\0\0)+")
+
+
+def _words(data: Buffer) -> array:
+    words = array("I")
+    words.frombytes(data)
+    return words
+
+
+def _zero_run(data: Buffer, start: int, end: int) -> int:
+    return (_ZERO_RUN.match(data, start, end).end() - start) // 4
+
+
+def sdma_packet(header: int) -> tuple:
+    """Returns the name and length in dwords of the SDMA packet starting with ``header``."""
+    if header & 0xFF == amd_gpu.SDMA_OP_NOP:
+        return "nop", 1 + (header >> 16 & 0x3FFF)
+    info = _SDMA_BY_OP_SUB.get(header & 0xFFFF) or _SDMA_BY_OP.get(header & 0xFF)
+    if info is None:
+        return "unknown", 1  # resynchronize on the next dword
+    if info[0] == "poll_regmem" and header >> 26 & 1:
+        return "hdp_flush", info[1]
+    return info
+
+
+def _pm4_packet(header: int) -> tuple:
+    packet_type, count = header >> 30, header >> 16 & 0x3FFF
+    if packet_type == 3:
+        opcode = header >> 8 & 0xFF
+        return PM4_OPCODES.get(opcode, f"packet3_0x{opcode:02x}"), count + 2
+    if packet_type == 2:
+        return "type2", 1
+    if packet_type == 0:
+        return "type0", count + 2
+    return "unknown", 1
+
+
+def _decode(data: Buffer, engine: str, start: int, end: int) -> List[Record]:
+    # start and end are dword aligned byte offsets
+    assert engine in ENGINES, f"engine must be one of {ENGINES}"
+    packet = sdma_packet if engine == "sdma" else _pm4_packet
+    zero_name = "nop" if engine == "sdma" else "zero"
+    words = _words(data[start:end])
+    records, index, count = [], 0, len(words)
+    append = records.append
+    while index < count:
+        header = words[index]
+        if header == 0:
+            dwords = _zero_run(data, start + index * 4, end)
+            append(Record(start + index * 4, zero_name, dwords, 0))
+        else:
+            name, dwords = packet(header)
+            if index + dwords > count:
+                append(Record(start + index * 4, name, count - index, header, False))
+                break
+            append(Record(start + index * 4, name, dwords, header))
+        index += dwords
+    return records
+
+
+class Decoded:
+    """
+    The records of a decoded buffer, in stream order, with lookups for forensics.
+
+    Attributes:
+        engine (str): "sdma" or "pm4".
+        data (bytes): The decoded buffer; record offsets index into it.
+        records (List[Record]): The packets in stream order.
+    """
+
+    def __init__(self, engine: str, data: Buffer, records: List[Record]):
+        self.engine = engine
+        self.data = data
+        self.records = records
+        # a wrapped ring window is decoded as two runs, so offsets are sorted separately
+        self._by_offset = sorted(records)
+        self._starts = [r.offset for r in self._by_offset]
+
+    def __len__(self) -> int:
+        return len(self.records)
+
+    def __iter__(self) -> Iterator[Record]:
+        return iter(self.records)
+
+    def __getitem__(self, index: int) -> Record:
+        return self.records[index]
+
+    def at(self, offset: int) -> Optional[Record]:
+        """Returns the record containing a byte offset, e.g. the read pointer of a hung queue."""
+        index = bisect.bisect_right(self._starts, offset) - 1
+        if index >= 0:
+            record = self._by_offset[index]
+            if offset < record.offset + record.dwords * 4:
+                return record
+        return None
+
+    def fields(self, record: Record) -> Dict[str, int]:
+        """
+        Decodes the fields of one record.
+
+        SDMA packets known to SDMA_PKTS are decoded into their named fields,
+        without reserved bits. Other packets give their ``header`` and
+        ``payload`` dwords.
+        """
+        raw = bytes(self.data[record.offset : record.offset + record.dwords * 4])
+        pkt_type = (
+            getattr(SDMA_PKTS, record.name, None) if self.engine == "sdma" else None
+        )
+        if pkt_type is None or not record.complete:
+            return {"header": record.header, "payload": list(_words(raw)[1:])}
+        pkt = pkt_type.from_buffer_copy(raw)
+        return {
+            f[0]: getattr(pkt, f[0])
+            for f in pkt_type._fields_
+            if "reserved" not in f[0] and not f[0].startswith("pad")
+        }
+
+    def format(self, records: Optional[List[Record]] = None) -> str:
+        """One line per record: offset, name, length in dwords and fields."""
+        lines = []
+        for record in self.records if records is None else records:
+            fields = (
+                ""
+                if record.name in ("nop", "zero")
+                else " ".join(
+                    f"{k}={v:#x}" if isinstance(v, int) else f"{k}={v}"
+                    for k, v in self.fields(record).items()
+                )
+            )
+            truncated = "" if record.complete else " (truncated)"
+            lines.append(
+                f"{record.offset:#08x} {record.name:<14} {record.dwords:>4}dw{truncated} {fields}".rstrip()
+            )
+        return "\n".join(lines)
+
+
+def decode(data: Buffer, engine: str = "sdma") -> Decoded:
+    """
+    Decodes a buffer holding a packet stream from its first byte.
+
+    Args:
+        data (Buffer): The stream, e.g. an indirect buffer; its size must be a multiple of 4.
+        engine (str): "sdma" or "pm4".
+    """
+    assert len(data) % 4 == 0, "packet streams are made of dwords"
+    return Decoded(engine, data, _decode(data, engine, 0, len(data)))
+
+
+def decode_ring(ring: Buffer, rptr: int, wptr: int, engine: str = "sdma") -> Decoded:
+    """
+    Decodes the packets between the read and write pointers of a ring snapshot.
+
+    Pointers are the byte based 64-bit values of the queue, so they may be
+    larger than the ring. Packets never wrap around the end of the ring (the
+    ring writers pad the end instead), so a window that wraps is decoded as
+    two runs and record offsets are offsets into ``ring``.
+
+    Args:
+        ring (Buffer): A copy of the whole ring.
+        rptr (int): The read pointer, where the engine is fetching or stuck.
+        wptr (int): The write pointer.
+        engine (str): "sdma" or "pm4".
+    """
+    size = len(ring)
+    assert size & (size - 1) == 0, "ring size must be a power of two"
+    assert 0 <= wptr - rptr <= size, "pointers are more than a ring apart"
+    start, end = rptr % size, wptr % size
+    if wptr - rptr == size or (end <= start and wptr != rptr):
+        records = _decode(ring, engine, start, size) + _decode(ring, engine, 0, end)
+    else:
+        records = _decode(ring, engine, start, end)
+    return Decoded(engine, ring, records)
@@ -0,0 +1,393 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import ctypes
+import functools
+import itertools
+import mmap
+import os
+import pathlib
+import tempfile
+import threading
+import time
+from typing import Any, Dict, List, Optional, Tuple
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from .context import KFDContext
+from .ops import DOORBELL_PAGE_SIZE, KFDDevice, MemoryManager, _live_devices
+from .sdma_emu import SDMAEngine
+from .topology import Topology
+
+
+class EmulatedKFD:
+    """
+    A software stand-in for the KFD_IOCTL object returned by ioctls_from_header.
+
+    Every ioctl is exposed under the same name and calling convention as the
+    generated functions (``fn(fd, made_struct=None, **kwargs)``) and returns the
+    same kfd argument structure, so code written against a real device runs
+    unchanged. Calls are recorded in ``calls`` for tests that assert on ordering.
+    ioctls without an emulation handler simply echo their arguments back.
+    Like the driver, which takes the process' mutex for these ioctls, calls
+    from several threads are serialized, except for wait_events, which
+    blocks without holding it so other threads can set the awaited events.
+
+    Buffer objects get an ``mmap_offset`` into a temporary file standing in
+    for the render node and /dev/kfd, see ``bo_file``, so CPU mappings made
+    through the offset share their bytes the way mappings of one BO do.
+
+    With ``sdma_engine``, every SDMA queue gets an sdma_emu.SDMAEngine running
+    on its own thread from create_queue to destroy_queue, whose traps
+    ``interrupt`` the driver, so packet streams execute without a GPU.
+
+    Args:
+        latency (Optional[Dict[str, float]]): Seconds to sleep in the named ioctls,
+            to model their kernel cost in benchmarks.
+        sdma_engine (bool): Whether SDMA queues execute their packets on the CPU.
+    """
+
+    def __init__(
+        self, latency: Optional[Dict[str, float]] = None, sdma_engine: bool = False
+    ):
+        self.calls: List[Tuple[str, Dict[str, Any]]] = []
+        self.allocations: Dict[int, Any] = {}
+        self.mappings: Dict[int, List[int]] = {}
+        self.svm_pages: Dict[int, Dict[Any, Any]] = {}
+        self.queues: Dict[int, Any] = {}
+        self.events: Dict[int, Dict[str, Any]] = {}
+        self.event_page_handle = 0
+        self.latency = latency or {}
+        self.sdma_engine = sdma_engine
+        self.sdma_engines: Dict[int, SDMAEngine] = {}
+        self._handles = itertools.count(1)
+        self._bo_end = 0
+        self._bo_file: Any = None
+        self._queue_ids = itertools.count()
+        self._lock = threading.Lock()
+        self._events_changed = threading.Condition()
+
+    def __getattr__(self, name: str) -> Any:
+        user_struct = getattr(kfd, f"struct_kfd_ioctl_{name}_args", None)
+        if user_struct is None:
+            raise AttributeError(name)
+        handler = getattr(self, f"_{name}", None)
+
+        def ioctl(fd: int, made_struct: ctypes.Structure = None, **kwargs):
+            made = made_struct or user_struct(**kwargs)
+            if name in self.latency:
+                time.sleep(self.latency[name])
+            with self._lock:
+                self.calls.append((name, kwargs))
+                if name != "wait_events":
+                    return handler(made) if handler else made
+            return handler(made)
+
+        return ioctl
+
+    def call_names(self) -> List[str]:
+        """Returns the names of all recorded ioctls in issue order."""
+        return [name for name, _ in self.calls]
+
+    def bo_file(self) -> Any:
+        """The file backing every buffer object, grown to cover all offsets handed out."""
+        with self._lock:
+            if self._bo_file is None:
+                self._bo_file = tempfile.TemporaryFile()
+            if os.fstat(self._bo_file.fileno()).st_size < self._bo_end:
+                os.ftruncate(self._bo_file.fileno(), self._bo_end)
+            return self._bo_file
+
+    def _alloc_memory_of_gpu(self, args):
+        args.handle = next(self._handles)
+        if not args.flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_USERPTR:
+            args.mmap_offset = self._bo_end
+            self._bo_end += -(-args.size // mmap.PAGESIZE) * mmap.PAGESIZE
+        self.allocations[args.handle] = args
+        return args
+
+    def _free_memory_of_gpu(self, args):
+        if args.handle not in self.allocations:
+            raise RuntimeError("IOCTL operation failed with system error: EINVAL")
+        if self.mappings.get(args.handle):
+            raise RuntimeError("IOCTL operation failed with system error: EBUSY")
+        del self.allocations[args.handle]
+        self.mappings.pop(args.handle, None)
+        return args
+
+    def _device_ids(self, args) -> List[int]:
+        ids = (ctypes.c_int32 * args.n_devices).from_address(args.device_ids_array_ptr)
+        return list(ids)
+
+    def _map_memory_to_gpu(self, args):
+        if args.handle not in self.allocations:
+            raise RuntimeError("IOCTL operation failed with system error: EINVAL")
+        mapped = self.mappings.setdefault(args.handle, [])
+        mapped.extend(g for g in self._device_ids(args) if g not in mapped)
+        args.n_success = args.n_devices
+        return args
+
+    def _unmap_memory_from_gpu(self, args):
+        mapped = self.mappings.get(args.handle, [])
+        for gpu_id in self._device_ids(args):
+            if gpu_id in mapped:
+                mapped.remove(gpu_id)
+        args.n_success = args.n_devices
+        return args
+
+    def _create_queue(self, args):
+        if args.ring_size == 0 or args.ring_size & (args.ring_size - 1):
+            raise RuntimeError("IOCTL operation failed with system error: EINVAL")
+        args.queue_id = next(self._queue_ids)
+        args.doorbell_offset = args.queue_id * 8
+        self.queues[args.queue_id] = args
+        if self.sdma_engine and args.queue_type == kfd.KFD_IOC_QUEUE_TYPE_SDMA:
+            engine = SDMAEngine(
+                args.ring_base_address,
+                args.ring_size,
+                args.write_pointer_address,
+                args.read_pointer_address,
+                self.interrupt,
+            )
+            self.sdma_engines[args.queue_id] = engine
+            engine.start()
+        return args
+
+    def _destroy_queue(self, args):
+        if self.queues.pop(args.queue_id, None) is None:
+            raise RuntimeError("IOCTL operation failed with system error: EINVAL")
+        engine = self.sdma_engines.pop(args.queue_id, None)
+        if engine is not None:
+            engine.stop()
+        return args
+
+    def _update_queue(self, args):
+        queue = self.queues.get(args.queue_id)
+        if queue is None:
+            raise RuntimeError("IOCTL operation failed with system error: EINVAL")
+        queue.ring_base_address, queue.ring_size = (
+            args.ring_base_address,
+            args.ring_size,
+        )
+        if args.queue_id in self.sdma_engines:
+            self.sdma_engines[args.queue_id].retarget(
+                args.ring_base_address, args.ring_size
+            )
+        return args
+
+    def _event(self, event_id: int) -> Dict[str, Any]:
+        event = self.events.get(event_id)
+        if event is None:
+            raise RuntimeError("IOCTL operation failed with system error: EINVAL")
+        return event
+
+    def _create_event(self, args):
+        if args.event_page_offset:
+            if self.event_page_handle:
+                raise RuntimeError("IOCTL operation failed with system error: EINVAL")
+            self.event_page_handle = args.event_page_offset
+        # signal event ids are their slot on the event page
+        event_id = next(
+            i for i in range(kfd.KFD_SIGNAL_EVENT_LIMIT) if i not in self.events
+        )
+        with self._events_changed:
+            self.events[event_id] = {
+                "signaled": False,
+                "auto_reset": args.auto_reset,
+                "type": args.event_type,
+            }
+        args.event_id = args.event_slot_index = event_id
+        return args
+
+    def _destroy_event(self, args):
+        self._event(args.event_id)
+        with self._events_changed:
+            del self.events[args.event_id]
+            self._events_changed.notify_all()
+        return args
+
+    def _set_event(self, args):
+        with self._events_changed:
+            self._event(args.event_id)["signaled"] = True
+            self._events_changed.notify_all()
+        return args
+
+    def interrupt(self, context_id: int) -> None:
+        """
+        Signals events the way an interrupt from the GPU does, e.g. an SDMA TRAP.
+
+        Like kfd_signal_event_interrupt, the event whose id is ``context_id`` is
+        signaled if there is one, otherwise every signal event.
+        """
+        with self._events_changed:
+            if context_id in self.events:
+                self.events[context_id]["signaled"] = True
+            else:
+                for event in self.events.values():
+                    if event["type"] == kfd.KFD_IOC_EVENT_SIGNAL:
+                        event["signaled"] = True
+            self._events_changed.notify_all()
+
+    def _reset_event(self, args):
+        with self._events_changed:
+            self._event(args.event_id)["signaled"] = False
+        return args
+
+    def _wait_events(self, args):
+        data = (kfd.struct_kfd_event_data * args.num_events).from_address(
+            args.events_ptr
+        )
+        ids = [d.event_id for d in data]
+        test = all if args.wait_for_all else any
+        timeout = None if args.timeout == 0xFFFFFFFF else args.timeout / 1000
+        with self._events_changed:
+            events = [self._event(i) for i in ids]
+            done = self._events_changed.wait_for(
+                lambda: test(e["signaled"] for e in events)
+                or any(i not in self.events for i in ids),
+                timeout,
+            )
+            if any(i not in self.events for i in ids):
+                raise RuntimeError("IOCTL operation failed with system error: EINVAL")
+            for event in events:
+                if done and event["signaled"] and event["auto_reset"]:
+                    event["signaled"] = False
+        args.wait_result = (
+            kfd.KFD_IOC_WAIT_RESULT_COMPLETE
+            if done
+            else kfd.KFD_IOC_WAIT_RESULT_TIMEOUT
+        )
+        return args
+
+    def _svm_page(self, addr: int) -> Dict[str, Any]:
+        return self.svm_pages.setdefault(
+            addr,
+            {
+                kfd.KFD_IOCTL_SVM_ATTR_PREFERRED_LOC: kfd.KFD_IOCTL_SVM_LOCATION_UNDEFINED,
+                kfd.KFD_IOCTL_SVM_ATTR_PREFETCH_LOC: kfd.KFD_IOCTL_SVM_LOCATION_UNDEFINED,
+                kfd.KFD_IOCTL_SVM_ATTR_GRANULARITY: 9,
+                "flags": kfd.KFD_IOCTL_SVM_FLAG_HOST_ACCESS
+                | kfd.KFD_IOCTL_SVM_FLAG_COHERENT,
+                "access": {},
+            },
+        )
+
+    def _svm(self, args):
+        pages = [
+            self._svm_page(addr)
+            for addr in range(
+                args.start_addr, args.start_addr + args.size, mmap.PAGESIZE
+            )
+        ]
+        attrs = [args.attrs[i] for i in range(args.nattr)]
+        access_types = (
+            kfd.KFD_IOCTL_SVM_ATTR_ACCESS,
+            kfd.KFD_IOCTL_SVM_ATTR_ACCESS_IN_PLACE,
+            kfd.KFD_IOCTL_SVM_ATTR_NO_ACCESS,
+        )
+        if args.op == kfd.KFD_IOCTL_SVM_OP_SET_ATTR:
+            for page in pages:
+                for attr in attrs:
+                    if attr.type in access_types:
+                        page["access"][attr.value] = attr.type
+                    elif attr.type == kfd.KFD_IOCTL_SVM_ATTR_SET_FLAGS:
+                        page["flags"] |= attr.value
+                    elif attr.type == kfd.KFD_IOCTL_SVM_ATTR_CLR_FLAGS:
+                        page["flags"] &= ~attr.value
+                    else:
+                        page[attr.type] = attr.value
+            return args
+
+        for attr in attrs:
+            if attr.type in access_types:
+                seen = {p["access"].get(attr.value, access_types[2]) for p in pages}
+                attr.type = seen.pop() if len(seen) == 1 else access_types[2]
+            elif attr.type == kfd.KFD_IOCTL_SVM_ATTR_SET_FLAGS:
+                attr.value = functools.reduce(lambda a, p: a & p["flags"], pages, ~0)
+            elif attr.type == kfd.KFD_IOCTL_SVM_ATTR_CLR_FLAGS:
+                attr.value = ~functools.reduce(lambda a, p: a | p["flags"], pages, 0)
+            elif attr.type == kfd.KFD_IOCTL_SVM_ATTR_GRANULARITY:
+                attr.value = min(p[attr.type] for p in pages)
+            else:
+                seen = {p[attr.type] for p in pages}
+                attr.value = (
+                    seen.pop()
+                    if len(seen) == 1
+                    else kfd.KFD_IOCTL_SVM_LOCATION_UNDEFINED
+                )
+        return args
+
+
+def emulated_context(
+    topology: Optional[Topology] = None, ioctls: Optional[EmulatedKFD] = None
+) -> KFDContext:
+    """
+    Creates a KFDContext backed by an EmulatedKFD, a fresh one by default.
+
+    Devices sharing the returned context share one emulated driver, which is
+    how several GPUs of one process are emulated.
+    """
+    return KFDContext(
+        topology or Topology(pathlib.Path("emulated"), ()),
+        opener=lambda: -1,
+        ioctls=ioctls or EmulatedKFD(),
+    )
+
+
+class EmulatedKFDDevice(KFDDevice):
+    """
+    A KFDDevice backed by EmulatedKFD instead of /dev/kfd.
+
+    Host memory management (mmap/munmap) is real, so buffers handed out by the
+    emulated device can be read and written from the CPU. Nothing is opened
+    under /dev or /sys, which makes this suitable for hermetic tests.
+    """
+
+    def __init__(
+        self,
+        gpu_id: int = 0x1000,
+        properties: Optional[Dict[str, int]] = None,
+        numa_node: Optional[int] = None,
+        context: Optional[KFDContext] = None,
+    ):
+        MemoryManager.__init__(self)
+        self.context = (context or emulated_context()).acquire()
+        self.KFD_IOCTL = self.context.KFD_IOCTL
+        self.device_id = 0
+        self.node_id = 1
+        self.numa_node = numa_node
+        self.gpu_id = gpu_id
+        self.properties = properties or {}
+        self.drm_fd = -1
+        self.arch = "gfx000"
+        self._doorbell_page = None
+        self._doorbell_lock = threading.Lock()
+        self._arenas = []
+        self._mmio_page = None
+        self._hdp = None
+        _live_devices.add(self)
+        self.acquire_vm()
+
+    def mmap_fd(self, kfd_flags: int) -> int:
+        """Buffer objects are mapped from the emulated driver's backing file."""
+        return self.KFD_IOCTL.bo_file().fileno()
+
+    def map_doorbell(self, doorbell_offset: int) -> int:
+        """Backs the doorbells with an anonymous page, so doorbell writes can be inspected."""
+        with self._doorbell_lock:
+            if self._doorbell_page is None:
+                self._doorbell_page = self.mmap(
+                    DOORBELL_PAGE_SIZE,
+                    mmap.PROT_READ | mmap.PROT_WRITE,
+                    mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
+                    -1,
+                )
+        return self._doorbell_page + doorbell_offset % DOORBELL_PAGE_SIZE
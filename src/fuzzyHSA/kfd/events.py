@@ -0,0 +1,296 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Pooled KFD signal events and a thread waiting on many of them at once.
+
+Waiting with one thread per event does not scale to thousands of operations
+in flight. An EventWaiter instead issues a single wait-any ``wait_events``
+over every watched event and completes one Future per event.
+
+wait_events only reports that *some* event fired, so after each wakeup the
+waiter finds out which ones did: with the ``check`` given to watch, e.g. a
+fence value in memory written before the event, or otherwise by a
+zero-timeout wait on each pending event. Checks cost no ioctl and should be
+used when many events are pending. Probing needs events that stay signaled,
+so the waiter expects manual-reset events, as EventPool creates by default.
+A manual-reset event that is signaled while its check still fails would end
+every following wait at once; when a wait completes without anything to
+dispatch, the waiter resets such events and checks them once more.
+
+Example:
+    with EventPool(device, 64) as pool, EventWaiter(device) as waiter:
+        event = pool.acquire()
+        future = waiter.watch(event.event_id, check=lambda: fence.value >= 1)
+        ...  # submit work ending in a fence and a trap raising the event
+        future.result(timeout=1)
+        pool.release(event)
+"""
+
+import concurrent.futures
+import threading
+from dataclasses import dataclass
+from typing import Callable, Dict, List, Optional, Tuple
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from .ops import KFDDevice
+
+Check = Optional[Callable[[], bool]]
+
+
+@dataclass(frozen=True)
+class Event:
+    event_id: int
+    slot_index: int
+    auto_reset: bool
+
+
+class EventPool:
+    """
+    Signal events created up front on the context's shared event page and reused.
+
+    Released events are reset, so they come back unsignaled. The pool may be
+    shared by threads.
+
+    Args:
+        device (KFDDevice): The device the events are created through.
+        count (int): Events created up front; more are created when the pool runs dry.
+        auto_reset (bool): Whether the events are auto-reset.
+    """
+
+    def __init__(self, device: KFDDevice, count: int = 64, auto_reset: bool = False):
+        self.device = device
+        self.auto_reset = auto_reset
+        self._idle: List[Event] = []
+        self._all: List[Event] = []
+        self._lock = threading.Lock()
+        self._idle.extend(self._create() for _ in range(count))
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def __len__(self) -> int:
+        return len(self._all)
+
+    def _create(self) -> Event:
+        args = self.device.create_event(auto_reset=self.auto_reset)
+        event = Event(args.event_id, args.event_slot_index, self.auto_reset)
+        with self._lock:
+            self._all.append(event)
+        return event
+
+    def acquire(self) -> Event:
+        """Returns an unsignaled event."""
+        with self._lock:
+            if self._idle:
+                return self._idle.pop()
+        return self._create()
+
+    def release(self, event: Event) -> None:
+        """Resets an event nobody waits on anymore and makes it available again."""
+        self.device.reset_event(event.event_id)
+        with self._lock:
+            self._idle.append(event)
+
+    def close(self) -> None:
+        """Destroys every event of the pool."""
+        with self._lock:
+            events, self._all, self._idle = self._all, [], []
+        for event in events:
+            self.device.destroy_event(event.event_id)
+
+
+class EventWaiter:
+    """
+    One thread multiplexing a wait-any wait_events over all watched events.
+
+    A private auto-reset event is part of every wait, so watching a new event
+    or closing interrupts the wait in progress. Futures complete with their
+    event id, and are cancelled when the waiter closes before their event fires.
+    Cancelling a future, e.g. when an asyncio wait on it times out, stops
+    watching its event.
+
+    When waiting fails, the pending futures fail with the error. Errors that
+    recur with nothing pending are retried with a growing delay, and the
+    thread ends once the device is closed.
+
+    Args:
+        device (KFDDevice): The device the events belong to.
+        timeout_ms (int): Longest single wait, bounding how long a missed
+            wakeup can delay a completion.
+    """
+
+    def __init__(self, device: KFDDevice, timeout_ms: int = 1000):
+        self.device = device
+        self.timeout_ms = timeout_ms
+        self.wakeups = 0
+        self._wake = device.create_event(auto_reset=True).event_id
+        self._pending: Dict[int, Tuple[concurrent.futures.Future, Check]] = {}
+        self._lock = threading.Lock()
+        self._changed = True
+        self._closed = False
+        self._retry = threading.Event()
+        self._thread = threading.Thread(
+            target=self._run, name="kfd-event-waiter", daemon=True
+        )
+        self._thread.start()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def __len__(self) -> int:
+        return len(self._pending)
+
+    def watch(self, event_id: int, check: Check = None) -> concurrent.futures.Future:
+        """
+        Returns a Future completed with ``event_id`` once the event has fired.
+
+        Args:
+            event_id (int): A manual-reset event, or an auto-reset one when ``check`` is given.
+            check (Check): Returns True once the operation behind the event is done.
+        """
+        future = concurrent.futures.Future()
+        with self._lock:
+            assert not self._closed, "EventWaiter is closed"
+            assert event_id not in self._pending, f"event {event_id} already watched"
+            self._pending[event_id] = (future, check)
+            self._changed = True
+        future.add_done_callback(lambda f: self._unwatch(event_id, f))
+        self._retry.set()
+        self.device.set_event(self._wake)
+        return future
+
+    def _unwatch(self, event_id: int, future: concurrent.futures.Future) -> None:
+        # completed futures were popped already, cancelled ones are dropped here
+        with self._lock:
+            if self._pending.get(event_id, (None,))[0] is future:
+                del self._pending[event_id]
+                self._changed = True
+
+    @staticmethod
+    def _settle(
+        future: concurrent.futures.Future,
+        result: Optional[int] = None,
+        error: Optional[BaseException] = None,
+    ) -> None:
+        # marking the future running first loses no race against a concurrent cancel
+        if not future.done() and future.set_running_or_notify_cancel():
+            if error is not None:
+                future.set_exception(error)
+            else:
+                future.set_result(result)
+
+    def _fired(self, event_id: int, check: Check) -> bool:
+        if check is not None:
+            return check()
+        result = self.device.wait_events([event_id], timeout_ms=0)
+        return result == kfd.KFD_IOC_WAIT_RESULT_COMPLETE
+
+    def _complete(self, fired: List[Tuple[int, concurrent.futures.Future]]) -> int:
+        with self._lock:
+            # close may have taken and cancelled the futures meanwhile
+            fired = [f for f in fired if self._pending.pop(f[0], None)]
+            self._changed = self._changed or bool(fired)
+        for event_id, future in fired:
+            self._settle(future, event_id)
+        return len(fired)
+
+    def _dispatch(self) -> int:
+        with self._lock:
+            pending = list(self._pending.items())
+        return self._complete(
+            [
+                (event_id, future)
+                for event_id, (future, check) in pending
+                if self._fired(event_id, check)
+            ]
+        )
+
+    def _rearm(self) -> None:
+        """Resets signaled events whose check still fails, see the module docstring."""
+        with self._lock:
+            if self._changed:
+                return  # the wake event ended the wait
+            checked = [
+                (event_id, future, check)
+                for event_id, (future, check) in self._pending.items()
+                if check is not None
+            ]
+        fired = []
+        for event_id, future, check in checked:
+            result = self.device.wait_events([event_id], timeout_ms=0)
+            if result == kfd.KFD_IOC_WAIT_RESULT_COMPLETE:
+                self.device.reset_event(event_id)
+                # the operation may have finished between the check and the reset
+                if check():
+                    fired.append((event_id, future))
+        self._complete(fired)
+
+    def _device_closed(self) -> bool:
+        context = self.device.context
+        return context is None or context.closed
+
+    def _run(self) -> None:
+        events, backoff = None, 0.0
+        while True:
+            with self._lock:
+                if self._closed:
+                    break
+                changed, self._changed = self._changed, False
+                watched = [self._wake, *self._pending]
+            try:
+                # the array is rebuilt only when the watched set changes
+                if changed:
+                    events = self.device.event_data_array(watched)
+                # timeouts dispatch too, which picks up completions whose event was lost
+                result = self.device.wait_events(events, timeout_ms=self.timeout_ms)
+                self.wakeups += 1
+                backoff = 0.0
+                if self._pending and not self._dispatch():
+                    if result == kfd.KFD_IOC_WAIT_RESULT_COMPLETE:
+                        self._rearm()
+            except Exception as e:
+                # e.g. a watched event was destroyed; its waiters learn why
+                with self._lock:
+                    pending, self._pending = self._pending, {}
+                    self._changed = True
+                    if self._device_closed():
+                        self._closed = True
+                for future, _ in pending.values():
+                    self._settle(future, error=e)
+                if self._closed:
+                    break
+                if not pending:
+                    # an error no watched event explains would repeat at once
+                    backoff = min(max(2 * backoff, 1e-3), self.timeout_ms / 1000)
+                    self._retry.wait(backoff)
+                    self._retry.clear()
+
+    def close(self) -> None:
+        """Stops the thread, cancels the futures still pending and destroys the wake event."""
+        with self._lock:
+            if self._closed:
+                return
+            self._closed = True
+            pending, self._pending = self._pending, {}
+        self._retry.set()
+        self.device.set_event(self._wake)
+        self._thread.join()
+        for future, _ in pending.values():
+            future.cancel()
+        self.device.destroy_event(self._wake)
@@ -0,0 +1,95 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+HDP flushes through the MMIO remap page.
+
+Host writes to VRAM pass the GPU's host data path (HDP), which buffers
+them. Before the GPU reads such data the HDP must be flushed. Instead of a
+heavyweight synchronization (or an hdp_flush packet on a queue), KFD remaps
+one page of HDP registers into the process: an allocation with
+KFD_IOC_ALLOC_MEM_FLAGS_MMIO_REMAP, CPU mapped through /dev/kfd. Writing 1 to
+HDP_MEM_FLUSH_CNTL in it flushes, which is a single MMIO write.
+
+Host writes to a write-combined VRAM mapping may still sit in the CPU's
+write-combining buffers, so the flush is preceded by a store fence. The
+native helper issues sfence. The Python fallback issues no fence and is
+correct only because PythonCopier writes with ordinary stores through memmove
+and memset, which x86 keeps in order with the flush write that follows.
+"""
+
+import ctypes
+import mmap
+from typing import Any, Dict, Optional
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from . import libc, native
+
+# register offsets in the remapped page, see KFD_MMIO_REMAP_* in amdgpu
+HDP_MEM_FLUSH_CNTL = 0x0
+HDP_REG_FLUSH_CNTL = 0x4
+
+MMIO_REMAP_SIZE = 4096
+
+SOURCE = r"""
+#include <stdint.h>
+
+void fz_hdp_flush(volatile uint32_t *reg) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_sfence();
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+    *reg = 1;
+}
+"""
+
+
+def mmio_remap_config() -> Dict[str, int]:
+    """Memory flags of the MMIO remap page; the anonymous mapping only reserves its range."""
+    return {
+        "mmap_prot": 0,
+        "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS | libc.MAP_NORESERVE,
+        "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_MMIO_REMAP
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_COHERENT,
+        "host_map": True,
+    }
+
+
+class HDPFlush:
+    """
+    Flushes the HDP with one write to a mapped MMIO remap page.
+
+    Args:
+        mmio_addr (int): CPU address of the mapped page, any writable page in tests.
+        use_native (bool): Whether to flush through the native helper when it builds.
+    """
+
+    def __init__(self, mmio_addr: int, use_native: bool = True):
+        self.mmio_addr = mmio_addr
+        self.flushes = 0
+        lib = native.build("hdp", SOURCE) if use_native else None
+        self._flush: Optional[Any] = None
+        if lib is not None:
+            self._flush = lib.fz_hdp_flush
+            self._flush.argtypes = [ctypes.c_void_p]
+            self._flush.restype = None
+        self._reg = ctypes.c_uint32.from_address(mmio_addr + HDP_MEM_FLUSH_CNTL)
+
+    def flush(self) -> None:
+        """Makes preceding host writes to VRAM visible to the GPU."""
+        if self._flush is not None:
+            self._flush(self.mmio_addr + HDP_MEM_FLUSH_CNTL)
+        else:
+            self._reg.value = 1
+        self.flushes += 1
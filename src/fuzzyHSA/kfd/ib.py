@@ -0,0 +1,273 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Indirect buffers (IBs): packet streams kept outside the ring and run from it.
+
+A stream is written into IBs carved out of pooled GTT memory, and the ring
+only receives one small indirect packet per IB: an SDMA ``indirect`` packet
+or a PM4 INDIRECT_BUFFER packet. A 1 MiB SDMA ring then runs up to 32768
+IBs instead of a megabyte of packets, and IB contents never wrap.
+
+Example:
+    pool = IBPool(device)
+    chain = IBChain(pool, "sdma")
+    chain.append(stream)
+    chain.submit(queue.ring_writer())
+    ...  # wait for the fence at the end of the stream
+    chain.release()
+"""
+
+import bisect
+import mmap
+import struct
+import threading
+from dataclasses import dataclass
+from typing import Any, Dict, List, Union
+
+import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu  # importing generated files via the fuzzyHSA package
+from . import decoder, sdma
+from .ops import KFDDevice
+from .queues import RING_FLAGS
+from .streaming import copier
+
+IB_SIZE = 0x10000
+IBS_PER_BLOCK = 16
+
+# SDMA fetches IBs in 8-dword units, and its indirect packet must end on an
+# 8-dword boundary of the ring, see sdma_v5_0_ring_emit_ib
+IB_ALIGNMENT = 32
+
+Stream = Union[sdma.SDMAStream, bytes, bytearray, memoryview]
+
+
+def sdma_indirect(addr: int, size: int, vmid: int = 0) -> bytes:
+    """
+    The ring packets running one SDMA IB: two NOP dwords and the 6-dword indirect
+    packet, 32 bytes that end on an 8-dword boundary when written 32-byte aligned.
+    """
+    pkt = sdma.packet("indirect", vmid=vmid, ib_base=addr, ib_size=size // 4)
+    return bytes(8) + bytes(pkt)
+
+
+def pm4_indirect_buffer(addr: int, size: int, vmid: int = 0) -> bytes:
+    """A PM4 INDIRECT_BUFFER packet running ``size`` bytes at ``addr``."""
+    return struct.pack(
+        "<4I",
+        amd_gpu.PACKET3(amd_gpu.PACKET3_INDIRECT_BUFFER, 2),
+        addr & 0xFFFFFFFC,
+        addr >> 32,
+        # nvd.h has no macro for the VMID in bits 24..27
+        size // 4 | amd_gpu.INDIRECT_BUFFER_VALID | vmid << 24,
+    )
+
+
+INDIRECT_PACKETS = {"sdma": sdma_indirect, "pm4": pm4_indirect_buffer}
+
+
+@dataclass
+class IndirectBuffer:
+    """
+    One IB of an IBPool.
+
+    Attributes:
+        addr (int): CPU and GPU address of the IB.
+        size (int): Capacity in bytes.
+        used (int): Bytes written so far.
+    """
+
+    addr: int
+    size: int
+    used: int = 0
+
+    @property
+    def space(self) -> int:
+        return self.size - self.used
+
+    def write(self, data: Any) -> None:
+        """Appends whole packets."""
+        size = len(data)
+        assert size <= self.space, "IB overflow"
+        copier().copy(self.addr + self.used, data, size)
+        self.used += size
+
+    def pad(self) -> None:
+        """Pads SDMA contents with NOP dwords to a multiple of 8 dwords, as the engine fetches them."""
+        pad = -self.used % IB_ALIGNMENT
+        copier().fill(self.addr + self.used, 0, pad)
+        self.used += pad
+
+
+def _ib_config() -> Dict[str, int]:
+    return {
+        "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+        "mmap_flags": mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
+        "kfd_flags": RING_FLAGS,
+        "host_map": True,
+    }
+
+
+class IBPool:
+    """
+    Fixed size IBs carved out of GTT allocations and reused.
+
+    Memory is allocated and mapped to the GPU one block of IBs at a time
+    when the pool runs dry. The pool may be shared by threads.
+
+    Args:
+        device (KFDDevice): The device whose GTT memory holds the IBs.
+        ib_size (int): Capacity of every IB, a multiple of IB_ALIGNMENT.
+        ibs_per_block (int): IBs per GTT allocation.
+    """
+
+    def __init__(
+        self,
+        device: KFDDevice,
+        ib_size: int = IB_SIZE,
+        ibs_per_block: int = IBS_PER_BLOCK,
+    ):
+        assert (
+            ib_size % IB_ALIGNMENT == 0
+        ), f"IB size must be a multiple of {IB_ALIGNMENT}"
+        self.device = device
+        self.ib_size = ib_size
+        self.ibs_per_block = ibs_per_block
+        self.blocks: List[Any] = []
+        self._idle: List[IndirectBuffer] = []
+        self._lock = threading.Lock()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def _grow(self) -> None:
+        # called with the lock held, allocations are rare enough to not matter
+        mem = self.device.allocate_memory(
+            self.ib_size * self.ibs_per_block, _ib_config(), map_to_gpu=True
+        )
+        self.blocks.append(mem)
+        self._idle.extend(
+            IndirectBuffer(mem.va_addr + i * self.ib_size, self.ib_size)
+            for i in reversed(range(self.ibs_per_block))
+        )
+
+    def acquire(self) -> IndirectBuffer:
+        """Returns an empty IB."""
+        with self._lock:
+            if not self._idle:
+                self._grow()
+            return self._idle.pop()
+
+    def release(self, ib: IndirectBuffer) -> None:
+        """Returns an IB the engine is done with."""
+        ib.used = 0
+        with self._lock:
+            self._idle.append(ib)
+
+    def close(self) -> None:
+        """Frees all memory of the pool; its IBs must not be used afterwards."""
+        with self._lock:
+            blocks, self.blocks, self._idle = self.blocks, [], []
+        for mem in blocks:
+            self.device.free_gpu_memory(mem)
+
+
+class IBChain:
+    """
+    A packet stream spread over IBs of a pool, and the ring packets that run them.
+
+    Streams are split between IBs at packet boundaries only. The IBs stay
+    owned by the chain until release, which the caller does once the engine
+    is known to be done with them, e.g. after a fence at the end.
+
+    Args:
+        pool (IBPool): Where IBs come from.
+        engine (str): "sdma" or "pm4", the packet format of the stream.
+        vmid (int): VMID put in the indirect packets; 0 lets the engine use the queue's.
+    """
+
+    def __init__(self, pool: IBPool, engine: str = "sdma", vmid: int = 0):
+        assert (
+            engine in INDIRECT_PACKETS
+        ), f"engine must be one of {list(INDIRECT_PACKETS)}"
+        self.pool = pool
+        self.engine = engine
+        self.vmid = vmid
+        self.ibs: List[IndirectBuffer] = []
+
+    def __len__(self) -> int:
+        return len(self.ibs)
+
+    def _seal(self) -> None:
+        # PM4 IBs are not padded, zero dwords would decode as type-0 packets
+        if self.ibs and self.engine == "sdma":
+            self.ibs[-1].pad()
+
+    def _next_ib(self) -> IndirectBuffer:
+        self._seal()
+        self.ibs.append(self.pool.acquire())
+        return self.ibs[-1]
+
+    def append(self, stream: Stream) -> None:
+        """
+        Appends whole packets, starting new IBs as they fill up.
+
+        Raises:
+            ValueError: If a single packet is larger than an IB.
+        """
+        data = memoryview(
+            stream.dwords if isinstance(stream, sdma.SDMAStream) else stream
+        ).cast("B")
+        ib = self.ibs[-1] if self.ibs else self._next_ib()
+        boundaries, start = None, 0
+        while len(data) - start > ib.space:
+            if boundaries is None:
+                # only streams that do not fit are decoded, for their packet offsets
+                boundaries = [r.offset for r in decoder.decode(data, self.engine)]
+                boundaries.append(len(data))
+            cut = boundaries[bisect.bisect_right(boundaries, start + ib.space) - 1]
+            if cut <= start:
+                if ib.used == 0:
+                    self.pool.release(self.ibs.pop())
+                    raise ValueError("packet larger than an IB")
+            else:
+                ib.write(data[start:cut])
+                start = cut
+            ib = self._next_ib()
+        ib.write(data[start:])
+
+    def ring_stream(self) -> bytes:
+        """The indirect packets running every IB of the chain, in order."""
+        self._seal()
+        packet = INDIRECT_PACKETS[self.engine]
+        return b"".join(packet(ib.addr, ib.used, self.vmid) for ib in self.ibs)
+
+    def submit(self, writer: sdma.SDMARingWriter, timeout: float = 10.0) -> int:
+        """
+        Writes the indirect packets into an SDMA ring and rings the doorbell once.
+
+        PM4 chains are not submitted to a ring here, as there are no PM4
+        queues; embed their ring_stream in another stream instead.
+
+        Returns:
+            int: The write pointer the indirect packets start at.
+        """
+        assert self.engine == "sdma", "only SDMA chains are submitted to a ring"
+        return writer.submit(self.ring_stream(), timeout, align=IB_ALIGNMENT)
+
+    def release(self) -> None:
+        """Returns the IBs to the pool; the engine must be done with them."""
+        for ib in self.ibs:
+            self.pool.release(ib)
+        self.ibs = []
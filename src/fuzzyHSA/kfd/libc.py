@@ -0,0 +1,114 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Process-wide libc bindings.
+
+libc is loaded once per process with ``use_errno=True`` so ``ctypes.get_errno``
+reports the errno of the failing call, and the prototypes are configured once
+instead of on every MemoryManager construction.
+"""
+
+import ctypes
+import errno
+import mmap as _mmap
+import os
+from typing import Optional
+
+libc = ctypes.CDLL("libc.so.6", use_errno=True)
+
+libc.mmap.argtypes = [
+    ctypes.c_void_p,
+    ctypes.c_size_t,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_int,
+    ctypes.c_long,
+]
+libc.mmap.restype = ctypes.c_void_p
+libc.munmap.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+libc.munmap.restype = ctypes.c_int
+libc.madvise.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_int]
+libc.madvise.restype = ctypes.c_int
+
+MAP_FAILED = ctypes.c_void_p(-1).value
+MAP_POPULATE = getattr(_mmap, "MAP_POPULATE", 0x8000)
+MAP_FIXED = getattr(_mmap, "MAP_FIXED", 0x10)
+MAP_NORESERVE = getattr(_mmap, "MAP_NORESERVE", 0x4000)
+MADV_DONTNEED = _mmap.MADV_DONTNEED
+MADV_WILLNEED = _mmap.MADV_WILLNEED
+MADV_HUGEPAGE = getattr(_mmap, "MADV_HUGEPAGE", 14)
+MADV_POPULATE_READ = 22  # Linux 5.14+
+MADV_POPULATE_WRITE = 23  # Linux 5.14+
+
+
+def raise_errno(what: str) -> None:
+    """Raises OSError for the errno left behind by the last libc call."""
+    err = ctypes.get_errno()
+    raise OSError(err, f"{what} failed: {os.strerror(err)}")
+
+
+def mmap(
+    size: int,
+    prot: int,
+    flags: int,
+    fd: int = -1,
+    start_addr: Optional[int] = None,
+    offset: int = 0,
+) -> int:
+    """Calls mmap(2) and returns the mapped address, raising OSError on failure."""
+    addr = libc.mmap(start_addr, size, prot, flags, fd, offset)
+    if addr == MAP_FAILED:
+        raise_errno("mmap")
+    return addr
+
+
+def munmap(addr: int, size: int) -> None:
+    """Calls munmap(2), raising OSError on failure."""
+    if libc.munmap(addr, size) != 0:
+        raise_errno("munmap")
+
+
+def madvise(addr: int, size: int, advice: int) -> None:
+    """Calls madvise(2), raising OSError on failure."""
+    if libc.madvise(addr, size, advice) != 0:
+        raise_errno("madvise")
+
+
+def prefault(
+    addr: int, size: int, prot: int = _mmap.PROT_READ | _mmap.PROT_WRITE
+) -> None:
+    """
+    Faults in every page of a mapping ahead of time.
+
+    Uses MADV_POPULATE_WRITE for writable and MADV_POPULATE_READ for read-only
+    mappings, so later accesses in timed sections take no demand paging
+    faults. The pages are never touched from Python, which would kill the
+    process on a mapping it may not access.
+
+    Args:
+        addr: The page aligned start of the region.
+        size: The size of the region.
+        prot: The PROT_* protection the region was mapped with.
+
+    Raises:
+        OSError: If the mapping is inaccessible (EACCES) or the kernel cannot
+            populate it, e.g. before Linux 5.14.
+    """
+    if prot & _mmap.PROT_WRITE:
+        advice = MADV_POPULATE_WRITE
+    elif prot & _mmap.PROT_READ:
+        advice = MADV_POPULATE_READ
+    else:
+        raise OSError(errno.EACCES, "prefault failed: mapping is not accessible")
+    if libc.madvise(addr, size, advice) != 0:
+        raise_errno("prefault")
@@ -0,0 +1,70 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Small native helpers compiled on first use.
+
+Some operations have no Python equivalent, e.g. atomic 64-bit accesses or
+a spin loop with a pause instruction. Their C sources live next to the
+Python code using them and are compiled with the system C compiler into the
+fuzzyHSA cache directory, keyed by a hash of the source, so a build happens
+once per source change. Without a working compiler ``build`` returns None
+and callers fall back to Python implementations.
+"""
+
+import ctypes
+import functools
+import hashlib
+import os
+import shutil
+import subprocess
+import tempfile
+from typing import Optional
+
+from fuzzyHSA.utils import create_cache_directory
+
+CFLAGS = ["-O2", "-shared", "-fPIC", "-std=gnu11"]
+
+
+@functools.lru_cache(maxsize=None)
+def build(name: str, source: str) -> Optional[ctypes.CDLL]:
+    """
+    Compiles C source into a shared library and loads it.
+
+    Args:
+        name (str): Library name, used in the file name.
+        source (str): The C source.
+
+    Returns:
+        Optional[ctypes.CDLL]: The library, or None if it could not be built.
+    """
+    digest = hashlib.sha256((source + " ".join(CFLAGS)).encode()).hexdigest()[:16]
+    try:
+        path = create_cache_directory() / f"{name}-{digest}.so"
+        if not path.exists():
+            compiler = os.environ.get("CC") or shutil.which("cc")
+            if compiler is None:
+                return None
+            with tempfile.TemporaryDirectory(dir=path.parent) as tmp:
+                src, out = os.path.join(tmp, f"{name}.c"), os.path.join(tmp, "lib.so")
+                with open(src, "w") as f:
+                    f.write(source)
+                subprocess.run(
+                    [compiler, *CFLAGS, "-o", out, src],
+                    check=True,
+                    capture_output=True,
+                )
+                # concurrent builds of the same source produce the same file
+                os.replace(out, path)
+        return ctypes.CDLL(str(path))
+    except (OSError, subprocess.CalledProcessError):
+        return None
@@ -0,0 +1,142 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import ctypes
+import os
+import pathlib
+import platform
+from typing import Iterable, List, Optional, Set, Tuple
+
+from . import libc
+from .topology import Topology
+
+SYSFS_NUMA_NODES = pathlib.Path("/sys/devices/system/node")
+
+MPOL_PREFERRED, MPOL_BIND = 1, 2
+MPOL_MF_STRICT, MPOL_MF_MOVE = 1 << 0, 1 << 1
+MPOL_F_ADDR = 1 << 1
+
+# mbind(2), set_mempolicy(2) and get_mempolicy(2) have no glibc wrappers, only syscall numbers
+_SYSCALLS = {
+    "x86_64": {"mbind": 237, "set_mempolicy": 238, "get_mempolicy": 239},
+    "aarch64": {"mbind": 235, "get_mempolicy": 236, "set_mempolicy": 237},
+}
+
+
+def parse_cpulist(text: str) -> Set[int]:
+    """Parses a sysfs cpulist such as ``0-3,8,10-11``."""
+    cpus: Set[int] = set()
+    for part in text.strip().split(","):
+        if not part:
+            continue
+        lo, _, hi = part.partition("-")
+        cpus.update(range(int(lo), int(hi or lo) + 1))
+    return cpus
+
+
+def nearest_cpu_node(
+    node_id: int, topology_root: Optional[pathlib.Path] = None
+) -> Optional[int]:
+    """
+    Finds the NUMA node closest to a KFD topology node, see Topology.nearest_cpu_node.
+
+    Args:
+        node_id (int): The KFD topology node of the GPU.
+        topology_root (Optional[pathlib.Path]): The ``topology/nodes`` directory to read.
+    """
+    return Topology.load(topology_root).nearest_cpu_node(node_id)
+
+
+def numa_cpus(numa_node: int, sysfs_root: pathlib.Path = SYSFS_NUMA_NODES) -> Set[int]:
+    """Returns the CPUs belonging to a NUMA node."""
+    return parse_cpulist((sysfs_root / f"node{numa_node}" / "cpulist").read_text())
+
+
+def pin_to_numa_node(
+    numa_node: int, pid: int = 0, sysfs_root: pathlib.Path = SYSFS_NUMA_NODES
+) -> Set[int]:
+    """
+    Restricts a process (default: the caller) to the CPUs of a NUMA node.
+
+    Returns:
+        Set[int]: The CPUs the process is now allowed to run on.
+    """
+    cpus = numa_cpus(numa_node, sysfs_root) & os.sched_getaffinity(pid)
+    if cpus:
+        os.sched_setaffinity(pid, cpus)
+    return os.sched_getaffinity(pid)
+
+
+def _nodemask(nodes: Iterable[int]):
+    nodes = list(nodes)
+    bits = ctypes.sizeof(ctypes.c_ulong) * 8
+    mask = (ctypes.c_ulong * (max(nodes) // bits + 1))()
+    for node in nodes:
+        mask[node // bits] |= 1 << (node % bits)
+    return mask, len(mask) * bits + 1
+
+
+def _syscall(name: str, *args) -> None:
+    number = _SYSCALLS.get(platform.machine(), {}).get(name)
+    if number is None:
+        raise OSError(f"{name} is not supported on {platform.machine()}")
+    if libc.libc.syscall(number, *args) != 0:
+        libc.raise_errno(name)
+
+
+def bind_memory(
+    addr: int, size: int, nodes: List[int], mode: int = MPOL_BIND, move: bool = True
+) -> None:
+    """
+    Applies a NUMA memory policy to a mapped range with mbind(2).
+
+    Pages faulted in afterwards are placed on ``nodes``; with ``move`` pages
+    already resident elsewhere are migrated.
+    """
+    mask, maxnode = _nodemask(nodes)
+    _syscall(
+        "mbind",
+        ctypes.c_void_p(addr),
+        ctypes.c_ulong(size),
+        ctypes.c_int(mode),
+        mask,
+        ctypes.c_ulong(maxnode),
+        ctypes.c_uint(MPOL_MF_MOVE if move else 0),
+    )
+
+
+def set_mempolicy(nodes: List[int], mode: int = MPOL_BIND) -> None:
+    """Sets the calling thread's default NUMA policy with set_mempolicy(2)."""
+    mask, maxnode = _nodemask(nodes)
+    _syscall("set_mempolicy", ctypes.c_int(mode), mask, ctypes.c_ulong(maxnode))
+
+
+def memory_policy(addr: int) -> Tuple[int, Set[int]]:
+    """
+    Returns the NUMA policy mode and nodes governing a mapped address, see get_mempolicy(2).
+
+    Raises:
+        OSError: If the call fails or the architecture has no known syscall number.
+    """
+    mode = ctypes.c_int(-1)
+    mask, maxnode = _nodemask([0])
+    _syscall(
+        "get_mempolicy",
+        ctypes.byref(mode),
+        mask,
+        ctypes.c_ulong(maxnode),
+        ctypes.c_void_p(addr),
+        ctypes.c_ulong(MPOL_F_ADDR),
+    )
+    bits = ctypes.sizeof(ctypes.c_ulong) * 8
+    nodes = {i for i in range(len(mask) * bits) if mask[i // bits] >> (i % bits) & 1}
+    return mode.value, nodes
@@ -13,31 +13,53 @@
 import os
 import fcntl
 import ctypes, mmap
-import pathlib
+import functools
+import threading
+import weakref
 from posix import O_RDWR
-from typing import Dict, List, Any, Optional
+from typing import Dict, List, Any, Optional, Union
 
 import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
-from .utils import ioctls_from_header, is_usable_gpu
+from . import arena, hdp, libc, numa, sdma
+from .context import KFDContext
+from .registry import owns_host_range
+from .topology import TopologyNode
+
+# doorbell pages are 8 KiB on SOC15 GPUs
+DOORBELL_PAGE_SIZE = 0x2000
+
+# one 64-bit slot per signal event
+EVENT_PAGE_SIZE = kfd.KFD_SIGNAL_EVENT_LIMIT * 8
+EVENT_TIMEOUT_INFINITE = 0xFFFFFFFF
+
+# per-thread scratch space for ioctl arguments, see _gpu_id_array
+_thread_local = threading.local()
+
+# every device of the process, reset in the child after fork
+_live_devices: "weakref.WeakSet[KFDDevice]" = weakref.WeakSet()
+
+
+def _gpu_id_array(gpu_ids: List[int]) -> ctypes.Array:
+    """
+    Copies gpu_ids into the calling thread's reusable c_int32 array.
+
+    The array is only read by the kernel during the ioctl it is passed to, so
+    each thread can reuse one buffer instead of allocating per call, and
+    threads never share one.
+    """
+    buf = getattr(_thread_local, "gpu_ids", None)
+    if buf is None or len(buf) < len(gpu_ids):
+        buf = _thread_local.gpu_ids = (ctypes.c_int32 * max(len(gpu_ids), 8))()
+    buf[: len(gpu_ids)] = gpu_ids
+    return buf
 
 
 class MemoryManager:
     """A class to encapsulate memory mapping functionality using libc."""
 
     def __init__(self):
-        """Load libc and set up mmap and munmap function prototypes."""
-        self.libc = ctypes.CDLL("libc.so.6")
-        self.libc.mmap.argtypes = [
-            ctypes.c_void_p,
-            ctypes.c_size_t,
-            ctypes.c_int,
-            ctypes.c_int,
-            ctypes.c_int,
-            ctypes.c_long,
-        ]
-        self.libc.mmap.restype = ctypes.c_void_p
-        self.libc.munmap.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
-        self.libc.munmap.restype = ctypes.c_int
+        """Use the process-wide libc binding with mmap, munmap and madvise prototypes."""
+        self.libc = libc.libc
 
     def mmap(
         self,
@@ -47,6 +69,7 @@ class MemoryManager:
         fd: int,
         start_addr: ctypes.c_void_p = None,
         offset: int = 0,
+        populate: bool = False,
     ) -> ctypes.c_void_p:
         """
         Memory map a file or device.
@@ -58,15 +81,17 @@ class MemoryManager:
             fd: File descriptor of the file or device to map.
             start_addr: The desired starting address for the mapping. If None, the kernel chooses the address.
             offset: Offset from the beginning of the file/device to start the mapping.
+            populate: If set to True, adds MAP_POPULATE so the pages are faulted in by mmap itself.
 
         Returns:
             A pointer to the mapped memory region.
+
+        Raises:
+            OSError: If mmap fails, carrying the errno of the failed call.
         """
-        addr = self.libc.mmap(start_addr, size, prot, flags, fd, offset)
-        if addr == ctypes.c_void_p(-1).value:
-            errno = ctypes.get_errno()
-            raise OSError(errno, os.strerror(errno))
-        return addr
+        if populate:
+            flags |= libc.MAP_POPULATE
+        return libc.mmap(size, prot, flags, fd, start_addr, offset)
 
     def munmap(self, addr: ctypes.c_void_p, size: int) -> None:
         """
@@ -79,9 +104,43 @@ class MemoryManager:
         Raises:
             OSError: If munmap fails.
         """
-        ret = self.libc.munmap(addr, size)
-        if ret != 0:
-            raise OSError("munmap failed")
+        libc.munmap(addr, size)
+
+    def madvise(self, addr: ctypes.c_void_p, size: int, advice: int) -> None:
+        """
+        Gives the kernel a usage hint for a mapped region.
+
+        Args:
+            addr: The page aligned start of the region.
+            size: The size of the region.
+            advice: One of the MADV_* constants, e.g. MADV_HUGEPAGE, MADV_WILLNEED or MADV_DONTNEED.
+
+        Raises:
+            OSError: If madvise fails.
+        """
+        libc.madvise(addr, size, advice)
+
+    def prefault(
+        self,
+        addr: ctypes.c_void_p,
+        size: int,
+        prot: Optional[int] = None,
+    ) -> None:
+        """
+        Faults in all pages of a region so timed sections take no demand paging faults.
+
+        Args:
+            addr: The page aligned start of the region.
+            size: The size of the region.
+            prot: The protection the region was mapped with, defaults to
+                PROT_READ | PROT_WRITE, see libc.prefault.
+
+        Raises:
+            OSError: If the region is not accessible or cannot be populated.
+        """
+        if prot is None:
+            prot = mmap.PROT_READ | mmap.PROT_WRITE
+        libc.prefault(addr, size, prot)
 
 
 class KFDDevice(MemoryManager):
@@ -91,70 +150,117 @@ class KFDDevice(MemoryManager):
 
     Attributes:
         KFD_IOCTL (object): An object containing dynamically created IOCTL operations.
-        fd (int): File descriptor for the /dev/kfd device, allowing direct communication with the device.
+        context (KFDContext): The per-process KFD state shared with other devices.
+        kfd (int): File descriptor for the /dev/kfd device, taken from the context.
         node_id (int): The unique identifier for the KFD device node.
 
+    A device may be used from several threads at once: per-process state lives
+    in the context, allocations are tracked in its locked AllocationRegistry and
+    ioctl argument arrays are per thread, so nothing relies on the GIL.
+
     Methods:
         __enter__, __exit__: Enable resource management using the 'with' statement.
-        close(): Closes the device file descriptor.
+        close(): Closes the render node and releases the context.
         ioctl(cmd, arg): Performs an IOCTL operation on the device.
-        create_queue(): Creates a queue on the KFD device using specific IOCTL commands.
+        create_queue(queue_type): Creates a queue on the KFD device using specific IOCTL commands.
         allocate_memory(size): Allocates memory on the device (placeholder method).
         print_ioctl_functions(): Prints the names of all generated IOCTL functions.
     """
 
-    # class attributes
-    kfd: int = -1
-    event_page: Any = (
-        None  # TODO: fix types in kfd, Optional[kfd.struct_kfd_ioctl_alloc_memory_of_gpu_args]
-    )
-    signals_page: Any = None
     signal_number: int = 16
-    gpus: List[pathlib.Path] = []
 
-    @classmethod
-    def initialize_class(cls):
-        if cls.kfd == -1:
-            try:
-                cls.kfd = os.open("/dev/kfd", os.O_RDWR | os.O_CLOEXEC)
-                cls.gpus = [
-                    g.parent
-                    for g in pathlib.Path(
-                        "/sys/devices/virtual/kfd/kfd/topology/nodes"
-                    ).glob("*/gpu_id")
-                    if is_usable_gpu(g)
-                ]
-            except Exception as e:
-                cls.kfd = -1
-                raise RuntimeError(
-                    f"Failed to initialize KFDDevice class with error: {e}"
-                ) from e
-
-    def __init__(self, device: str):
+    def __init__(self, device: str, context: Optional[KFDContext] = None):
+        """
+        Opens a GPU of a KFD context.
+
+        Args:
+            device (str): "KFD:<index>" selecting the index-th usable GPU of the context.
+            context (Optional[KFDContext]): The context to share, defaults to the
+                process-wide KFDContext.default().
+        """
         super().__init__()
-        self.__class__.initialize_class()
+        self.context = (context or KFDContext.default()).acquire()
 
-        self.KFD_IOCTL = ioctls_from_header()
+        self.KFD_IOCTL = self.context.KFD_IOCTL
         self.device_id = int(device.split(":")[1]) if ":" in device else 0
+        self.drm_fd = -1
+        self._doorbell_page: Optional[int] = None
+        self._doorbell_lock = threading.Lock()
+        self._arenas: List[arena.Arena] = []
+        self._mmio_page: Any = None
+        self._hdp: Optional[hdp.HDPFlush] = None
+        _live_devices.add(self)
         try:
-            gpu_path = self.__class__.gpus[self.device_id]
-            self.gpu_id = int((gpu_path / "gpu_id").read_text().strip())
-            properties = (gpu_path / "properties").read_text().strip().split("\n")
-            self.properties = {
-                line.split()[0]: int(line.split()[1]) for line in properties
-            }
-            self.drm_fd = os.open(
-                f"/dev/dri/renderD{self.properties['drm_render_minor']}", os.O_RDWR
-            )
-            target = self.properties["gfx_target_version"]
-            self.arch = (
-                f"gfx{target // 10000}{(target // 100) % 100:02x}{target % 100:02x}"
-            )
+            node = self.context.gpus[self.device_id]
+            self.node_id = node.node_id
+            self.gpu_id = node.gpu_id
+            self.properties = node.properties
+            self.drm_fd = self._open_render_node()
+            self.acquire_vm()
+            self.arch = node.arch
         except Exception as e:
+            self.close()
             raise RuntimeError(
                 f"Failed to initialize KFDDevice instance with error: {e}"
             ) from e
 
+    def _open_render_node(self) -> int:
+        return os.open(
+            f"/dev/dri/renderD{self.properties['drm_render_minor']}", os.O_RDWR
+        )
+
+    def _after_fork_in_child(self) -> None:
+        """
+        Drops the state a forked child inherits from the parent's KFD process.
+
+        The context has reopened /dev/kfd by now. The inherited render node
+        fd shares the parent's VM, and the doorbell and MMIO remap pages map
+        the parent's queues and registers, so the child unmaps them, opens the
+        render node again and acquires its own VM.
+        """
+        if self.context is None or self.context.closed:
+            return
+        self._doorbell_lock = threading.Lock()
+        self._arenas = []
+        if self._doorbell_page is not None:
+            self.munmap(self._doorbell_page, DOORBELL_PAGE_SIZE)
+            self._doorbell_page = None
+        if self._mmio_page is not None:
+            self.munmap(self._mmio_page.va_addr, self._mmio_page.size)
+            self._mmio_page, self._hdp = None, None
+        if self.drm_fd >= 0:
+            os.close(self.drm_fd)
+            self.drm_fd = self._open_render_node()
+        self.acquire_vm()
+
+    @property
+    def kfd(self) -> int:
+        """The /dev/kfd file descriptor of the device's context."""
+        return self.context.kfd
+
+    @property
+    def gpus(self) -> List[TopologyNode]:
+        """The usable GPU nodes of the device's context."""
+        return self.context.gpus
+
+    @property
+    def event_page(self) -> Any:
+        """The process' event page, shared by all devices of the context."""
+        return self.context.event_page
+
+    @event_page.setter
+    def event_page(self, mem: Any) -> None:
+        self.context.event_page = mem
+
+    @property
+    def signals_page(self) -> Any:
+        """The process' signal page, shared by all devices of the context."""
+        return self.context.signals_page
+
+    @signals_page.setter
+    def signals_page(self, mem: Any) -> None:
+        self.context.signals_page = mem
+
     def __enter__(self):
         """
         Enables the use of 'with' statement for this class, allowing for automatic
@@ -176,9 +282,94 @@ class KFDDevice(MemoryManager):
         """
         self.close()
 
+    async def __aenter__(self):
+        """
+        Enables 'async with', yielding an AsyncKFDDevice that owns this device.
+
+        Returns:
+            aio.AsyncKFDDevice: Awaitable versions of the blocking calls, see aio.py.
+        """
+        # aio.py builds on KFDDevice, so it can only be imported here
+        from .aio import AsyncKFDDevice
+
+        self._async = AsyncKFDDevice(self, owns_device=True)
+        return self._async
+
+    async def __aexit__(self, exc_type, exc_val, exc_tb):
+        """Stops the ioctl and event waiter threads and closes the device."""
+        await self._async.aclose()
+
+    def arena(self) -> arena.Arena:
+        """
+        Opens a scope releasing every resource created through this device inside it.
+
+        Example:
+            with device.arena():
+                mem = device.allocate_memory(size, config, map_to_gpu=True)
+
+        Returns:
+            arena.Arena: The arena, whose exit tears its resources down, see arena.py.
+        """
+        return arena.Arena(self)
+
+    def _record(self, method: str, *args) -> None:
+        # resources belong to the innermost open arena, if any
+        current = arena.current(self)
+        if current is not None:
+            getattr(current, method)(*args)
+
+    def _forget(self, kind: str, key: int) -> None:
+        for scope in self._arenas:
+            scope.forget(kind, key)
+
     def close(self):
-        """Closes the device file descriptor, freeing up system resources."""
-        os.close(self.__class__.kfd)
+        """
+        Closes the render node and releases the device's context reference.
+
+        The /dev/kfd descriptor is closed once the last device of the context
+        is closed. Calling close more than once is harmless.
+        """
+        if getattr(self, "context", None) is not None and self._mmio_page is not None:
+            page, self._mmio_page, self._hdp = self._mmio_page, None, None
+            self.free_gpu_memory(page)
+        context, self.context = getattr(self, "context", None), None
+        if context is None:
+            return
+        if self.drm_fd >= 0:
+            os.close(self.drm_fd)
+            self.drm_fd = -1
+        if self._doorbell_page is not None:
+            self.munmap(self._doorbell_page, DOORBELL_PAGE_SIZE)
+            self._doorbell_page = None
+        context.release()
+
+    def acquire_vm(self) -> None:
+        """
+        Makes the render node's GPU VM the process' VM on this GPU, like hsaKmtOpen does.
+
+        KFD only maps memory to GPUs whose VM the process acquired, so every
+        GPU an allocation is mapped to needs a device opened in this context.
+        The VM is acquired once per GPU and context and outlives the device.
+        """
+        with self.context._lock:
+            if self.gpu_id in self.context.vms:
+                return
+            self.KFD_IOCTL.acquire_vm(self.kfd, drm_fd=self.drm_fd, gpu_id=self.gpu_id)
+            self.context.vms.add(self.gpu_id)
+
+    @functools.cached_property
+    def numa_node(self) -> Optional[int]:
+        """The NUMA node closest to this GPU according to the KFD topology io_links."""
+        return self.context.topology.nearest_cpu_node(self.node_id)
+
+    def pin_worker(self) -> None:
+        """
+        Pins the calling process to the CPUs of the GPU's NUMA node and makes that
+        node its preferred memory node, keeping host traffic off the socket interconnect.
+        """
+        if self.numa_node is not None:
+            numa.pin_to_numa_node(self.numa_node)
+            numa.set_mempolicy([self.numa_node], mode=numa.MPOL_PREFERRED)
 
     # TODO: not sure I need this since I'm getting the actual ioctls from the headers
     def ioctl(self, cmd: int, arg: ctypes.Structure) -> ctypes.Structure:
@@ -196,62 +387,56 @@ class KFDDevice(MemoryManager):
             OSError: If the IOCTL operation fails.
         """
         try:
-            ret = fcntl.ioctl(self.__class__.kfd, cmd, arg)
+            ret = fcntl.ioctl(self.kfd, cmd, arg)
             return arg
         except IOError as e:
             raise OSError(f"IOCTL operation failed: {e}")
 
-    def create_queue(self):
-        """
-        Creates a compute queue on the KFD device, utilizing ioctl commands.
-        """
-        # TODO: setup all the necessary instance attributes to create this queue
-        # queue_args = {
-        #     "ring_base_address": self.aql_ring.va_addr,
-        #     "ring_size": self.aql_ring.size,
-        #     "gpu_id": self.gpu_id,
-        #     "queue_type": kfd.KFD_IOC_QUEUE_TYPE_COMPUTE_AQL,
-        #     "queue_percentage": kfd.KFD_MAX_QUEUE_PERCENTAGE,
-        #     "queue_priority": kfd.KFD_MAX_QUEUE_PRIORITY,
-        #     "eop_buffer_address": self.eop_buffer.va_addr,
-        #     "eop_buffer_size": self.eop_buffer.size,
-        #     "ctx_save_restore_address": self.ctx_save_restore_address.va_addr,
-        #     "ctx_save_restore_size": self.ctx_save_restore_address.size,
-        #     "ctl_stack_size": 0xA000,
-        #     "write_pointer_address": self.gart_aql.va_addr
-        #     + getattr(hsa.amd_queue_t, "write_dispatch_id").offset,
-        #     "read_pointer_address": self.gart_aql.va_addr
-        #     + getattr(hsa.amd_queue_t, "read_dispatch_id").offset,
-        # }
-        # size = 0x1000
-        # addr_flags = mmap.MAP_SHARED | mmap.MAP_ANONYMOUS
-        #
-        # addr = kfd_device.mmap(size=size, prot=0, flags=addr_flags, fd=-1, offset=0)
-        #
-        # flags = kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT
-        # mem = kfd_device.KFD_IOCTL.alloc_memory_of_gpu(
-        #     kfd_device.kfd,
-        #     va_addr=addr,
-        #     size=size,
-        #     gpu_id=kfd_device.gpu_id,
-        #     flags=flags,
-        #     mmap_offset=0,
-        # )
-        #
-        # mem.__setattr__(
-        #     "mapped_gpu_ids", getattr(mem, "mapped_gpu_ids", []) + [kfd_device.gpu_id]
-        # )
-        # c_gpus = (ctypes.c_int32 * len(mem.mapped_gpu_ids))(*mem.mapped_gpu_ids)
-        #
-        # stm = kfd_device.KFD_IOCTL.map_memory_to_gpu(
-        #     kfd_device.kfd,
-        #     handle=mem.handle,
-        #     device_ids_array_ptr=ctypes.addressof(c_gpus),
-        #     n_devices=len(mem.mapped_gpu_ids),
-        # )
-        # assert stm.n_success == len(mem.mapped_gpu_ids)
-        #
-        # self.aql_queue = self.KFD_IOCTL.create_queue(KFDDevice.kfd, **queue_args)
+    def create_queue(self, queue_type: Optional[int] = None, **kwargs) -> Any:
+        """
+        Creates a user mode queue on the KFD device, utilizing ioctl commands.
+
+        Args:
+            queue_type (Optional[int]): A KFD_IOC_QUEUE_TYPE_* value, defaults to
+                KFD_IOC_QUEUE_TYPE_COMPUTE_AQL.
+            **kwargs: Passed to the queue constructor, e.g. ring_size.
+
+        Returns:
+            queues.Queue: The queue with its ring, pointers and doorbell. Call
+            ``destroy()`` on it to release everything.
+        """
+        # queues.py builds on KFDDevice, so it can only be imported here
+        from .queues import QUEUE_FACTORIES
+
+        if queue_type is None:
+            queue_type = kfd.KFD_IOC_QUEUE_TYPE_COMPUTE_AQL
+        queue = QUEUE_FACTORIES[queue_type](self, **kwargs)
+        self._record("add_queue", queue)
+        return queue
+
+    def map_doorbell(self, doorbell_offset: int) -> int:
+        """
+        Returns the CPU address of a queue's doorbell.
+
+        The doorbell_offset returned by create_queue is an mmap offset of the
+        process' doorbell page on /dev/kfd plus the byte offset of the queue's
+        doorbell within it. The page is mapped once per device and shared by
+        all of its queues.
+
+        Args:
+            doorbell_offset (int): The doorbell_offset returned by create_queue.
+        """
+        base = doorbell_offset & ~(DOORBELL_PAGE_SIZE - 1)
+        with self._doorbell_lock:
+            if self._doorbell_page is None:
+                self._doorbell_page = self.mmap(
+                    DOORBELL_PAGE_SIZE,
+                    mmap.PROT_READ | mmap.PROT_WRITE,
+                    mmap.MAP_SHARED,
+                    self.kfd,
+                    offset=base,
+                )
+        return self._doorbell_page + doorbell_offset - base
 
     def allocate_memory(
         self, size: int, memory_flags: Dict[str, int], map_to_gpu: Optional[bool] = None
@@ -262,10 +447,24 @@ class KFDDevice(MemoryManager):
         Args:
             size (int): The size of the memory to allocate in bytes.
             memory_flags (Dict[str, int]): Configuration dictionary containing mmap and KFD flags.
+                Optional keys: "numa_node", a NUMA node (or "local" for the GPU's nearest
+                node) a GTT buffer is placed on, "madvise", a MADV_* advice (or list of
+                them) applied to the host mapping, "prefault", which faults the host
+                mapping in up front, and "host_map", whether the buffer object is mapped
+                over the reserved range through its mmap_offset, see map_to_host. It
+                defaults to True for host visible (PUBLIC) VRAM.
             map_to_gpu (Optional[bool], optional): If set to True, maps the allocated memory to the GPU after allocation.
 
         Returns:
             The allocated memory object with optional GPU mapping.
+
+        Raises:
+            ValueError: If "numa_node" is given for memory other than GTT.
+
+        TTM allocates the pages of GTT buffer objects in the kernel, regardless of
+        the memory policy of the reserved range. Like the Thunk, a GTT buffer with
+        a "numa_node" is therefore host memory bound to the node with mbind,
+        faulted in there and registered as userptr. free_gpu_memory unmaps it.
         """
         # TODO: should create this function first from the gpu_allocation tests that passes
         # then can use in the subsequent test that need it like create_queue
@@ -275,41 +474,189 @@ class KFDDevice(MemoryManager):
         mmap_flags = memory_flags["mmap_flags"]
         kfd_flags = memory_flags["kfd_flags"]
 
+        numa_node = memory_flags.get("numa_node")
+        if numa_node == "local":
+            numa_node = self.numa_node
+        if numa_node is not None and not kfd_flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT:
+            raise ValueError("numa_node only places GTT memory")
+
         addr = self.mmap(size=size, prot=mmap_prot, flags=mmap_flags, fd=-1, offset=0)
+        if numa_node is not None:
+            kfd_flags = (
+                kfd_flags & ~kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT
+                | kfd.KFD_IOC_ALLOC_MEM_FLAGS_USERPTR
+            )
+        userptr = kfd_flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_USERPTR
+        try:
+            if numa_node is not None:
+                numa.bind_memory(addr, size, [numa_node])
+            advice = memory_flags.get("madvise", [])
+            for adv in advice if isinstance(advice, (list, tuple)) else [advice]:
+                self.madvise(addr, size, adv)
+            if memory_flags.get("prefault") or numa_node is not None:
+                self.prefault(addr, size, mmap_prot)
+
+            mem = self.KFD_IOCTL.alloc_memory_of_gpu(
+                self.kfd,
+                va_addr=addr,
+                size=size,
+                gpu_id=self.gpu_id,
+                flags=kfd_flags,
+                mmap_offset=addr if userptr else 0,
+            )
+        except Exception:
+            # nothing owns the reserved range yet
+            self.munmap(addr, size)
+            raise
+        mem.host_owned = True
+        self.context.allocations.add(mem)
+        self._record("add_allocation", mem)
+        public_vram = (
+            kfd.KFD_IOC_ALLOC_MEM_FLAGS_VRAM | kfd.KFD_IOC_ALLOC_MEM_FLAGS_PUBLIC
+        )
+        # userptr memory is the host mapping itself
+        if not userptr and memory_flags.get(
+            "host_map", kfd_flags & public_vram == public_vram
+        ):
+            self.map_to_host(mem)
+        if map_to_gpu:
+            self.map_memory_to_gpu(mem)
+        return mem
+
+    def mmap_fd(self, kfd_flags: int) -> int:
+        """
+        The file descriptor buffer objects with the given flags are CPU mapped through.
+
+        Doorbell and MMIO remap pages are mapped through /dev/kfd, all other
+        buffer objects through the render node, like the Thunk does.
+        """
+        special = (
+            kfd.KFD_IOC_ALLOC_MEM_FLAGS_DOORBELL
+            | kfd.KFD_IOC_ALLOC_MEM_FLAGS_MMIO_REMAP
+        )
+        return self.kfd if kfd_flags & special else self.drm_fd
+
+    def map_to_host(
+        self, mem: Any, prot: int = mmap.PROT_READ | mmap.PROT_WRITE
+    ) -> int:
+        """
+        Maps a buffer object for CPU access at its GPU virtual address.
+
+        allocate_memory only reserves the address range with an anonymous
+        mapping; this replaces the reservation by a shared mapping of the
+        buffer object at the ``mmap_offset`` KFD returned for it. For VRAM this
+        needs a large BAR, and the mapping is write-combined: see vram.py for
+        copies that suit it. free_gpu_memory unmaps it like any host range.
+
+        Returns:
+            int: The CPU address, equal to ``mem.va_addr``.
+        """
+        addr = self.mmap(
+            mem.size,
+            prot,
+            mmap.MAP_SHARED | libc.MAP_FIXED,
+            self.mmap_fd(mem.flags),
+            start_addr=mem.va_addr,
+            offset=mem.mmap_offset,
+        )
+        mem.host_mapped = True
+        return addr
+
+    def hdp_flusher(self) -> hdp.HDPFlush:
+        """
+        Returns the device's HDP flusher, mapping its MMIO remap page on first use.
+
+        The page lives until the device is closed, also when first used inside an arena.
+        """
+        with self.context._lock:
+            if self._hdp is None:
+                page = self.allocate_memory(
+                    hdp.MMIO_REMAP_SIZE, hdp.mmio_remap_config()
+                )
+                self._forget("allocations", page.handle)
+                self._mmio_page, self._hdp = page, hdp.HDPFlush(page.va_addr)
+            return self._hdp
+
+    def hdp_flush(self) -> None:
+        """Makes host writes to VRAM visible to the GPU with one MMIO write, see hdp.py."""
+        self.hdp_flusher().flush()
+
+    def allocate_userptr(
+        self,
+        addr: int,
+        size: int,
+        kfd_flags: Optional[int] = None,
+        map_to_gpu: Optional[bool] = None,
+    ) -> Any:
+        """
+        Registers existing host memory with the GPU without copying it.
+
+        The range is widened to page boundaries, so the returned allocation may
+        start before ``addr``. For userptr allocations KFD takes the CPU address
+        through ``mmap_offset``; the GPU address is chosen to be the same.
+
+        Args:
+            addr (int): Host address of the first byte to register.
+            size (int): Number of bytes to register.
+            kfd_flags (Optional[int]): Additional KFD flags ORed with KFD_IOC_ALLOC_MEM_FLAGS_USERPTR,
+                defaults to KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE.
+            map_to_gpu (Optional[bool], optional): If set to True, maps the registered memory to the GPU.
+
+        Returns:
+            The allocated memory object. The memory stays owned by the caller and
+            is not unmapped from the host by free_gpu_memory.
+        """
+        if kfd_flags is None:
+            kfd_flags = kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE
+        start = addr & ~(mmap.PAGESIZE - 1)
+        end = (addr + size + mmap.PAGESIZE - 1) & ~(mmap.PAGESIZE - 1)
 
         mem = self.KFD_IOCTL.alloc_memory_of_gpu(
             self.kfd,
-            va_addr=addr,
-            size=size,
+            va_addr=start,
+            size=end - start,
             gpu_id=self.gpu_id,
-            flags=kfd_flags,
-            mmap_offset=0,
+            flags=kfd.KFD_IOC_ALLOC_MEM_FLAGS_USERPTR | kfd_flags,
+            mmap_offset=start,
         )
+        self.context.allocations.add(mem)
+        self._record("add_allocation", mem)
         if map_to_gpu:
             self.map_memory_to_gpu(mem)
         return mem
 
-    def map_memory_to_gpu(self, mem: Any) -> None:
+    def map_memory_to_gpu(self, mem: Any, gpu_ids: Optional[List[int]] = None) -> None:
         """
         Maps memory to GPU using IOCTL commands.
 
+        All GPUs are mapped by a single map_memory_to_gpu ioctl. Peer GPUs must
+        belong to this process, i.e. have a KFDDevice opened for them in the
+        same context, see acquire_vm.
+
         Args:
             mem: Memory object with GPU memory details.
+            gpu_ids (Optional[List[int]]): gpu_ids to map the memory to, defaults to this device.
+
+        Raises:
+            ValueError: If a GPU has no VM acquired in the device's context.
         """
-        mem.__setattr__(
-            "mapped_gpu_ids", getattr(mem, "mapped_gpu_ids", []) + [self.gpu_id]
-        )
+        missing = [g for g in gpu_ids or [] if g not in self.context.vms]
+        if missing:
+            raise ValueError(
+                f"No GPU VM acquired for gpu_ids {[hex(g) for g in missing]}, "
+                "open a KFDDevice for each of them in this context first"
+            )
+        mapped = self.context.allocations.add_mappings(mem, gpu_ids or [self.gpu_id])
+        self._record("add_mapping", mem, gpu_ids or [self.gpu_id])
 
-        c_gpus = (ctypes.c_int32 * len(mem.mapped_gpu_ids))(*mem.mapped_gpu_ids)
+        c_gpus = _gpu_id_array(mapped)
         stm = self.KFD_IOCTL.map_memory_to_gpu(
             self.kfd,
             handle=mem.handle,
             device_ids_array_ptr=ctypes.addressof(c_gpus),
-            n_devices=len(mem.mapped_gpu_ids),
+            n_devices=len(mapped),
         )
-        assert stm.n_success == len(
-            mem.mapped_gpu_ids
-        ), "Not all GPUs were mapped successfully"
+        assert stm.n_success == len(mapped), "Not all GPUs were mapped successfully"
 
     def free_gpu_memory(self, memory: Any) -> None:
         """
@@ -323,52 +670,151 @@ class KFDDevice(MemoryManager):
         Exception: If the number of successfully unmapped devices does not match the expected count.
         """
         try:
-            # Unmap memory from GPUs if any GPUs are mapped
-            gpu_ids = getattr(memory, "mapped_gpu_ids", [])
-            if gpu_ids:
-                # Prepare the array of device IDs for the C library call
-                gpu_ids_array = (ctypes.c_int32 * len(gpu_ids))(*gpu_ids)
-                result = self.KFD_IOCTL.unmap_memory_from_gpu(
-                    self.kfd,
-                    handle=memory.handle,
-                    device_ids_array_ptr=ctypes.addressof(gpu_ids_array),
-                    n_devices=len(gpu_ids),
-                )
+            # Only one thread may free a handle, later frees fail here
+            self.context.allocations.claim(memory)
 
-                if result.n_success != len(gpu_ids):
-                    raise Exception(
-                        f"Failed to unmap memory from all GPUs. Success count: {result.n_success}"
+            registry = self.context.allocations
+            try:
+                # Unmap memory from GPUs if any GPUs are mapped
+                gpu_ids = getattr(memory, "mapped_gpu_ids", [])
+                if gpu_ids:
+                    # Prepare the array of device IDs for the C library call
+                    gpu_ids_array = _gpu_id_array(gpu_ids)
+                    result = self.KFD_IOCTL.unmap_memory_from_gpu(
+                        self.kfd,
+                        handle=memory.handle,
+                        device_ids_array_ptr=ctypes.addressof(gpu_ids_array),
+                        n_devices=len(gpu_ids),
                     )
-
-            # Unmap virtual address and free memory
-            self.munmap(memory.va_addr, memory.size)
-            self.KFD_IOCTL.free_memory_of_gpu(self.kfd, handle=memory.handle)
+                    registry.remove_mappings(memory, gpu_ids[: result.n_success])
+
+                    if result.n_success != len(gpu_ids):
+                        raise Exception(
+                            f"Failed to unmap memory from all GPUs. Success count: {result.n_success}"
+                        )
+
+                self.KFD_IOCTL.free_memory_of_gpu(self.kfd, handle=memory.handle)
+            except Exception:
+                # The buffer object still exists, so it stays recorded and can be freed again
+                registry.add(memory)
+                raise
+            # Arenas keep failed frees recorded and release them on teardown
+            self._forget("allocations", memory.handle)
+            self._forget("mappings", memory.handle)
+
+            # Userptr memory belongs to the caller, so only the KFD handle is released;
+            # the host range is unmapped once KFD no longer references its pages
+            if owns_host_range(memory):
+                self.munmap(memory.va_addr, memory.size)
 
         except Exception as e:
             raise OSError(f"Error freeing GPU memeory: {e}")
 
-    def create_sdma_packets():
-        structs = {}
-        packet_definitions = {
-            name: struct
-            for name, struct in amd_gpu.__dict__.items()
-            if name.startswith("struct_SDMA_PKT_") and name.endswith("_TAG")
-        }
+    def create_event(
+        self, auto_reset: bool = True, event_type: Optional[int] = None
+    ) -> Any:
+        """
+        Creates an event of the process.
+
+        The first signal event of a context allocates the shared event page
+        and registers it with KFD; later events get slots on the same page.
+
+        Args:
+            auto_reset (bool): Whether a wait consuming the event resets it.
+            event_type (Optional[int]): A KFD_IOC_EVENT_* value, defaults to KFD_IOC_EVENT_SIGNAL.
+
+        Returns:
+            The create_event arguments holding ``event_id`` and ``event_slot_index``.
+        """
+        if event_type is None:
+            event_type = kfd.KFD_IOC_EVENT_SIGNAL
+        with self.context._lock:
+            page_offset = 0
+            if event_type == kfd.KFD_IOC_EVENT_SIGNAL and self.event_page is None:
+                config = {
+                    "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+                    "mmap_flags": mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
+                    "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT
+                    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_COHERENT
+                    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED
+                    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE
+                    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_EXECUTABLE
+                    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_NO_SUBSTITUTE,
+                    # waiters read the slots the GPU writes
+                    "host_map": True,
+                }
+                self.event_page = self.allocate_memory(
+                    EVENT_PAGE_SIZE, config, map_to_gpu=True
+                )
+                page_offset = self.event_page.handle
+            args = self.KFD_IOCTL.create_event(
+                self.kfd,
+                event_page_offset=page_offset,
+                event_type=event_type,
+                auto_reset=int(auto_reset),
+                node_id=self.node_id,
+            )
+        self._record("add_event", args.event_id)
+        return args
+
+    def destroy_event(self, event_id: int) -> None:
+        self._forget("events", event_id)
+        self.KFD_IOCTL.destroy_event(self.kfd, event_id=event_id)
+
+    def set_event(self, event_id: int) -> None:
+        """Signals an event from the host, waking its waiters."""
+        self.KFD_IOCTL.set_event(self.kfd, event_id=event_id)
+
+    def reset_event(self, event_id: int) -> None:
+        self.KFD_IOCTL.reset_event(self.kfd, event_id=event_id)
+
+    @staticmethod
+    def event_data_array(event_ids: List[int]) -> ctypes.Array:
+        """Builds the kfd_event_data array wait_events takes; callers waiting repeatedly keep it."""
+        events = (kfd.struct_kfd_event_data * len(event_ids))()
+        for event, event_id in zip(events, event_ids):
+            event.event_id = event_id
+        return events
+
+    def wait_events(
+        self,
+        events: Union[List[int], ctypes.Array],
+        wait_for_all: bool = False,
+        timeout_ms: int = EVENT_TIMEOUT_INFINITE,
+    ) -> int:
+        """
+        Blocks until any (or all) of the events are signaled or the timeout expires.
+
+        Signaled auto-reset events are reset by the wait that consumes them.
+
+        Args:
+            events: Event ids, or an array from event_data_array.
+            wait_for_all (bool): Wait for every event instead of any.
+            timeout_ms (int): Milliseconds, EVENT_TIMEOUT_INFINITE to wait forever.
+
+        Returns:
+            int: KFD_IOC_WAIT_RESULT_COMPLETE or KFD_IOC_WAIT_RESULT_TIMEOUT.
+        """
+        if not isinstance(events, ctypes.Array):
+            events = self.event_data_array(events)
+        return self.KFD_IOCTL.wait_events(
+            self.kfd,
+            events_ptr=ctypes.addressof(events),
+            num_events=len(events),
+            wait_for_all=int(wait_for_all),
+            timeout=timeout_ms,
+        ).wait_result
 
-        for name, pkt in packet_definitions.items():
-            fields, names = [], set()
+    @staticmethod
+    def create_sdma_packets() -> Any:
+        """Returns the SDMA packet structures, built once per process, see sdma.create_sdma_packets."""
+        return sdma.SDMA_PKTS
 
-            for field_name, field_type in pkt._fields_:
-                if field_name.endswith("_UNION"):
-                    handle_union_field(fields, field_name, field_type, names)
-                else:
-                    fields.append((field_name, field_type))
 
-            # Structure renaming for consistency and readability
-            new_name = name[16:-4].lower()
-            struct_type = init_c_struct_t(tuple(fields))
-            structs[new_name] = struct_type
+def _after_fork_in_child() -> None:
+    for device in list(_live_devices):
+        device._after_fork_in_child()
 
-            assert_size_matches(struct_type, pkt)
 
-        return type("SDMA_PKTS", (object,), structs)
+# registered after KFDContext's hook, so contexts are reopened before their devices
+os.register_at_fork(after_in_child=_after_fork_in_child)
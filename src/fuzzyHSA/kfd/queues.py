@@ -0,0 +1,373 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import contextlib
+import ctypes
+import mmap
+import threading
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, Iterator, List, Optional, Tuple, Union
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+import fuzzyHSA.kfd.autogen.hsa as hsa  # importing generated files via the fuzzyHSA package
+from . import aql, libc, sdma
+from .ops import KFDDevice
+
+QueueFactory = Callable[..., "Queue"]
+
+SDMA_RING_SIZE = 0x100000
+AQL_RING_SIZE = 0x100000
+EOP_BUFFER_SIZE = 0x1000
+
+# context save/restore area sizing, see kfd_queue.c and the ROCt thunk
+CTX_SAVE_RESTORE_SIZE, CTL_STACK_SIZE = 0x2C02000, 0xA000
+VGPR_SIZE_PER_CU, SGPR_SIZE_PER_CU = 0x40000, 0x4000
+LDS_SIZE_PER_CU, HWREG_SIZE_PER_CU = 0x10000, 0x1000
+# gfx9 values; gfx10 and later run fewer waves per CU with larger control stack entries
+WAVES_PER_CU, CNTL_STACK_BYTES_PER_WAVE = 40, 8
+GFX10_WAVES_PER_CU, GFX10_CNTL_STACK_BYTES_PER_WAVE = 32, 12
+GFX10_TARGET_VERSION = 100000
+CONTEXT_SAVE_AREA_HEADER_SIZE = 40
+
+# flags used for rings and the GART page holding the read/write pointers; the
+# CPU writes these, so their configs map the buffer objects with "host_map"
+RING_FLAGS = (
+    kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT
+    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE
+    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_EXECUTABLE
+    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_NO_SUBSTITUTE
+    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_COHERENT
+    | kfd.KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED
+)
+
+
+@dataclass
+class Queue:
+    """
+    A KFD user mode queue together with the memory backing it.
+
+    Attributes:
+        device (KFDDevice): The device the queue was created on.
+        args (Any): The kfd create_queue arguments as returned by the ioctl.
+        ring (Any): The ring buffer allocation.
+        gart (Any): The host visible allocation holding the read and write pointers.
+        buffers (Dict[str, Any]): Further allocations owned by the queue, e.g. an EOP buffer.
+        doorbell (int): CPU address of the queue's doorbell.
+    """
+
+    device: KFDDevice
+    args: Any
+    ring: Any
+    gart: Any
+    buffers: Dict[str, Any] = field(default_factory=dict)
+    doorbell: int = 0
+
+    @property
+    def queue_id(self) -> int:
+        return self.args.queue_id
+
+    @property
+    def queue_type(self) -> int:
+        return self.args.queue_type
+
+    @property
+    def read_pointer(self) -> ctypes.c_uint64:
+        return ctypes.c_uint64.from_address(self.args.read_pointer_address)
+
+    @property
+    def write_pointer(self) -> ctypes.c_uint64:
+        return ctypes.c_uint64.from_address(self.args.write_pointer_address)
+
+    @property
+    def idle(self) -> bool:
+        """Whether the engine has consumed everything written to the queue."""
+        return self.read_pointer.value == self.write_pointer.value
+
+    def reset(self) -> None:
+        """
+        Prepares an idle queue for its next user.
+
+        The engine keeps its read and write pointers in the MQD, which only
+        create_queue initializes, so a queue cannot be rewound from the host.
+        The next user continues at the current write pointer instead, which
+        ring writers read from memory. Every slot of an idle AQL ring has been
+        consumed, so all of them are made INVALID again.
+        """
+        assert self.idle, "only idle queues can be reused"
+        if self.queue_type == kfd.KFD_IOC_QUEUE_TYPE_COMPUTE_AQL:
+            aql.invalidate_ring(self.ring.va_addr, self.ring.size)
+
+    def ring_writer(self) -> Union[aql.AQLRingWriter, sdma.SDMARingWriter]:
+        """Returns a writer submitting packets to this queue, matching its type."""
+        writer = (
+            sdma.SDMARingWriter
+            if self.queue_type == kfd.KFD_IOC_QUEUE_TYPE_SDMA
+            else aql.AQLRingWriter
+        )
+        return writer(
+            self.ring.va_addr,
+            self.ring.size,
+            self.args.write_pointer_address,
+            self.args.read_pointer_address,
+            self.doorbell,
+        )
+
+    def destroy(self, free_memory: bool = True) -> None:
+        """
+        Destroys the queue and frees all of its memory.
+
+        Args:
+            free_memory (bool): False leaves the memory to the caller, e.g. an
+                arena freeing it in bulk.
+        """
+        self.device._forget("queues", id(self))
+        self.device.KFD_IOCTL.destroy_queue(self.device.kfd, queue_id=self.queue_id)
+        if free_memory:
+            for mem in [self.ring, self.gart, *self.buffers.values()]:
+                self.device.free_gpu_memory(mem)
+
+
+def _gart_config() -> Dict[str, int]:
+    return {
+        "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+        "mmap_flags": mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
+        "kfd_flags": RING_FLAGS,
+        "host_map": True,
+    }
+
+
+def create_sdma_queue(device: KFDDevice, ring_size: int = SDMA_RING_SIZE) -> Queue:
+    """
+    Creates an SDMA queue with its ring and GART pointer page.
+
+    The read pointer lives at offset 8 and the write pointer at offset 0 of
+    the GART page.
+    """
+    ring = device.allocate_memory(ring_size, _gart_config(), map_to_gpu=True)
+    gart = device.allocate_memory(mmap.PAGESIZE, _gart_config(), map_to_gpu=True)
+    args = device.KFD_IOCTL.create_queue(
+        device.kfd,
+        ring_base_address=ring.va_addr,
+        ring_size=ring.size,
+        gpu_id=device.gpu_id,
+        queue_type=kfd.KFD_IOC_QUEUE_TYPE_SDMA,
+        queue_percentage=kfd.KFD_MAX_QUEUE_PERCENTAGE,
+        queue_priority=kfd.KFD_MAX_QUEUE_PRIORITY,
+        write_pointer_address=gart.va_addr,
+        read_pointer_address=gart.va_addr + 8,
+    )
+    return Queue(
+        device, args, ring, gart, doorbell=device.map_doorbell(args.doorbell_offset)
+    )
+
+
+def _round_up(size: int, alignment: int = mmap.PAGESIZE) -> int:
+    return (size + alignment - 1) // alignment * alignment
+
+
+def cwsr_sizes(properties: Dict[str, int]) -> Tuple[int, int]:
+    """
+    Sizes the context save/restore area of a compute queue from the node properties.
+
+    Kernels that validate queue buffers publish the sizes they expect as the
+    ``cwsr_size`` and ``ctl_stack_size`` node properties, which are used when
+    present. Otherwise the control stack holds one entry per wave plus a
+    header, with the wave count and entry size of the node's gfx version, and
+    the workgroup data holds the VGPRs, SGPRs, LDS and hardware registers of
+    every CU. Without the CU count the fixed sizes used so far are returned.
+
+    Returns:
+        Tuple[int, int]: ctx_save_restore_size and ctl_stack_size.
+    """
+    if properties.get("cwsr_size") and properties.get("ctl_stack_size"):
+        return properties["cwsr_size"], properties["ctl_stack_size"]
+    if not properties.get("simd_count") or not properties.get("simd_per_cu"):
+        return CTX_SAVE_RESTORE_SIZE, CTL_STACK_SIZE
+    cu_num = properties["simd_count"] // properties["simd_per_cu"]
+    if properties.get("gfx_target_version", 0) >= GFX10_TARGET_VERSION:
+        waves, bytes_per_wave = GFX10_WAVES_PER_CU, GFX10_CNTL_STACK_BYTES_PER_WAVE
+    else:
+        waves, bytes_per_wave = WAVES_PER_CU, CNTL_STACK_BYTES_PER_WAVE
+    ctl_stack_size = _round_up(
+        cu_num * waves * bytes_per_wave + 8 + CONTEXT_SAVE_AREA_HEADER_SIZE
+    )
+    wg_data_size = _round_up(
+        cu_num
+        * (VGPR_SIZE_PER_CU + SGPR_SIZE_PER_CU + LDS_SIZE_PER_CU + HWREG_SIZE_PER_CU)
+    )
+    return ctl_stack_size + wg_data_size, ctl_stack_size
+
+
+def _vram_config() -> Dict[str, int]:
+    # the host mapping only reserves the GPU virtual address range
+    return {
+        "mmap_prot": 0,
+        "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS | libc.MAP_NORESERVE,
+        "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_VRAM
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_EXECUTABLE,
+    }
+
+
+def create_compute_queue(device: KFDDevice, ring_size: int = AQL_RING_SIZE) -> Queue:
+    """
+    Creates an AQL compute queue.
+
+    The queue owns an AQL ring in GTT, an EOP buffer and a context
+    save/restore area in VRAM, and a GART page holding the amd_queue_t whose
+    write_dispatch_id and read_dispatch_id serve as the queue's write and
+    read pointers. Every slot of the ring starts out INVALID.
+    """
+    ring = device.allocate_memory(ring_size, _gart_config(), map_to_gpu=True)
+    gart = device.allocate_memory(mmap.PAGESIZE, _gart_config(), map_to_gpu=True)
+    eop = device.allocate_memory(EOP_BUFFER_SIZE, _vram_config(), map_to_gpu=True)
+    ctx_save_restore_size, ctl_stack_size = cwsr_sizes(device.properties)
+    ctx_save = device.allocate_memory(
+        ctx_save_restore_size, _vram_config(), map_to_gpu=True
+    )
+    aql.invalidate_ring(ring.va_addr, ring.size)
+    amd_queue = hsa.amd_queue_t.from_address(gart.va_addr)
+    amd_queue.hsa_queue.base_address = ring.va_addr
+    amd_queue.hsa_queue.size = ring.size // aql.AQL_PACKET_SIZE
+    args = device.KFD_IOCTL.create_queue(
+        device.kfd,
+        ring_base_address=ring.va_addr,
+        ring_size=ring.size,
+        gpu_id=device.gpu_id,
+        queue_type=kfd.KFD_IOC_QUEUE_TYPE_COMPUTE_AQL,
+        queue_percentage=kfd.KFD_MAX_QUEUE_PERCENTAGE,
+        queue_priority=kfd.KFD_MAX_QUEUE_PRIORITY,
+        eop_buffer_address=eop.va_addr,
+        eop_buffer_size=eop.size,
+        ctx_save_restore_address=ctx_save.va_addr,
+        ctx_save_restore_size=ctx_save.size,
+        ctl_stack_size=ctl_stack_size,
+        write_pointer_address=gart.va_addr + hsa.amd_queue_t.write_dispatch_id.offset,
+        read_pointer_address=gart.va_addr + hsa.amd_queue_t.read_dispatch_id.offset,
+    )
+    return Queue(
+        device,
+        args,
+        ring,
+        gart,
+        {"eop": eop, "ctx_save_restore": ctx_save},
+        device.map_doorbell(args.doorbell_offset),
+    )
+
+
+QUEUE_FACTORIES: Dict[int, QueueFactory] = {
+    kfd.KFD_IOC_QUEUE_TYPE_SDMA: create_sdma_queue,
+    kfd.KFD_IOC_QUEUE_TYPE_COMPUTE_AQL: create_compute_queue,
+}
+
+
+class QueuePool:
+    """
+    Pre-created queues of one device, reused across testcases.
+
+    Programs that only need *a* queue acquire one from the pool and release
+    it afterwards; idle released queues are kept and continue at their
+    current write pointer, see Queue.reset, so the create_queue ioctl and the
+    ring allocations are paid once per pool rather than once per testcase.
+    Queues released with work still pending are destroyed, since their
+    pointers cannot be rewound. Queues are created on demand when the pool of
+    a type runs dry. The pool may be shared by threads.
+
+    Example:
+        with QueuePool(device, {kfd.KFD_IOC_QUEUE_TYPE_SDMA: 2}) as pool:
+            with pool.lease(kfd.KFD_IOC_QUEUE_TYPE_SDMA) as queue:
+                ...
+
+    Args:
+        device (KFDDevice): The device to create queues on.
+        prefill (Dict[int, int]): Number of queues created up front, per queue type.
+        factories (Optional[Dict[int, QueueFactory]]): Queue constructors per queue type,
+            added to the default ones.
+    """
+
+    def __init__(
+        self,
+        device: KFDDevice,
+        prefill: Optional[Dict[int, int]] = None,
+        factories: Optional[Dict[int, QueueFactory]] = None,
+    ):
+        self.device = device
+        self.factories: Dict[int, QueueFactory] = {
+            **QUEUE_FACTORIES,
+            **(factories or {}),
+        }
+        self._idle: Dict[int, List[Queue]] = {t: [] for t in self.factories}
+        self._all: List[Queue] = []
+        self._lock = threading.Lock()
+        self.created = 0
+        self.reused = 0
+        self.discarded = 0
+        for queue_type, count in (prefill or {}).items():
+            for _ in range(count):
+                self._idle[queue_type].append(self._create(queue_type))
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def _create(self, queue_type: int) -> Queue:
+        device = self.device
+        queue = self.factories[queue_type](device)
+        # pooled queues outlive an arena open while the pool grows, like the HDP page
+        device._forget("queues", id(queue))
+        for mem in [queue.ring, queue.gart, *queue.buffers.values()]:
+            device._forget("allocations", mem.handle)
+            device._forget("mappings", mem.handle)
+        with self._lock:
+            self._all.append(queue)
+            self.created += 1
+        return queue
+
+    def acquire(self, queue_type: int) -> Queue:
+        """Returns an idle queue of the given type, creating one if none is idle."""
+        with self._lock:
+            idle = self._idle[queue_type]
+            if idle:
+                self.reused += 1
+                return idle.pop()
+        return self._create(queue_type)
+
+    def release(self, queue: Queue) -> None:
+        """Makes an idle queue available again; a queue that is still busy is destroyed."""
+        if not queue.idle:
+            with self._lock:
+                self._all.remove(queue)
+                self.discarded += 1
+            queue.destroy()
+            return
+        queue.reset()
+        with self._lock:
+            self._idle[queue.queue_type].append(queue)
+
+    @contextlib.contextmanager
+    def lease(self, queue_type: int) -> Iterator[Queue]:
+        """Acquires a queue for the duration of a with block."""
+        queue = self.acquire(queue_type)
+        try:
+            yield queue
+        finally:
+            self.release(queue)
+
+    def close(self) -> None:
+        """Destroys every queue the pool created."""
+        with self._lock:
+            queues, self._all = self._all, []
+            self._idle = {t: [] for t in self.factories}
+        for queue in queues:
+            queue.destroy()
@@ -0,0 +1,95 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import threading
+from typing import Any, Dict, List
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+
+def owns_host_range(mem: Any) -> bool:
+    """
+    Whether freeing an allocation must also unmap its host range.
+
+    Userptr memory belongs to the caller, except for the ranges allocate_memory
+    mapped itself to place them on a NUMA node.
+    """
+    userptr = mem.flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_USERPTR
+    return not userptr or getattr(mem, "host_owned", False)
+
+
+class AllocationRegistry:
+    """
+    The live KFD allocations of one KFDContext, safe to use from many threads.
+
+    KFD handles are per /dev/kfd file descriptor, so all devices of a context
+    share one registry. Every allocation is added when it is created and
+    claimed exactly once when it is freed: when two threads free the same
+    handle, one of them wins and the other gets an error instead of unmapping
+    host memory that may already belong to a new allocation. A free that fails
+    before the buffer object is gone adds the allocation back, so it can be
+    freed again. The lock only guards the bookkeeping, ioctls are issued
+    outside of it.
+    """
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._live: Dict[int, Any] = {}
+
+    def __len__(self) -> int:
+        with self._lock:
+            return len(self._live)
+
+    def __contains__(self, handle: int) -> bool:
+        with self._lock:
+            return handle in self._live
+
+    def add(self, mem: Any) -> Any:
+        """Records a new allocation and returns it."""
+        with self._lock:
+            self._live[mem.handle] = mem
+        return mem
+
+    def claim(self, mem: Any) -> None:
+        """
+        Removes an allocation that is about to be freed.
+
+        Raises:
+            KeyError: If the handle is not live, e.g. because another thread freed it first.
+        """
+        with self._lock:
+            if self._live.get(mem.handle) is not mem:
+                raise KeyError(f"handle {mem.handle:#x} is not a live allocation")
+            del self._live[mem.handle]
+
+    def add_mappings(self, mem: Any, gpu_ids: List[int]) -> List[int]:
+        """
+        Adds gpu_ids to ``mem.mapped_gpu_ids`` atomically.
+
+        Returns:
+            List[int]: The new list of mapped gpu_ids, stored as a fresh list so
+            concurrent readers never observe a partially updated one.
+        """
+        with self._lock:
+            mapped = getattr(mem, "mapped_gpu_ids", [])
+            mem.mapped_gpu_ids = mapped + [g for g in gpu_ids if g not in mapped]
+            return mem.mapped_gpu_ids
+
+    def remove_mappings(self, mem: Any, gpu_ids: List[int]) -> None:
+        """Removes gpu_ids from ``mem.mapped_gpu_ids`` atomically, see add_mappings."""
+        with self._lock:
+            mapped = getattr(mem, "mapped_gpu_ids", [])
+            mem.mapped_gpu_ids = [g for g in mapped if g not in gpu_ids]
+
+    def handles(self) -> List[int]:
+        with self._lock:
+            return list(self._live)
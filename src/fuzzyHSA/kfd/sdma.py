@@ -0,0 +1,304 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import ctypes
+import functools
+import time
+from array import array
+from typing import Any, Callable, Dict, Iterable, Optional, Sequence, Tuple, Union
+
+import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu  # importing generated files via the fuzzyHSA package
+from .streaming import copier
+from .utils import assert_size_matches, handle_union_field, init_c_struct_t
+
+
+@functools.lru_cache(maxsize=None)
+def create_sdma_packets() -> Any:
+    """
+    Flattens the generated SDMA_PKT_*_TAG structures into plain packet structures.
+
+    Every DW_n union is replaced by its bitfields and ``*_31_0``/``*_63_32``
+    pairs are merged into one 64-bit field, so ``copy_linear(src_addr=...)``
+    works directly. The types are built once per process.
+
+    Returns:
+        A class with one packet structure per SDMA packet, e.g. ``copy_linear`` or ``fence``.
+    """
+    structs = {}
+    packet_definitions = {
+        name: struct
+        for name, struct in amd_gpu.__dict__.items()
+        if name.startswith("struct_SDMA_PKT_") and name.endswith("_TAG")
+    }
+
+    for name, pkt in packet_definitions.items():
+        fields, names = [], set()
+
+        for field_name, field_type in pkt._fields_:
+            if field_name.endswith("_UNION"):
+                handle_union_field(fields, field_name, field_type, names)
+            else:
+                fields.append((field_name, field_type))
+
+        # Structure renaming for consistency and readability
+        new_name = name[16:-4].lower()
+        struct_type = init_c_struct_t(tuple(fields))
+        struct_type.__name__ = f"sdma_pkt_{new_name}"
+        structs[new_name] = struct_type
+
+        assert_size_matches(struct_type, pkt)
+
+    return type("SDMA_PKTS", (object,), structs)
+
+
+SDMA_PKTS = create_sdma_packets()
+
+
+def field_layout(pkt: Any) -> Dict[str, Tuple[int, int]]:
+    """
+    Returns the bit offset and width of every field of a packed packet structure.
+
+    ctypes does not expose bitfield positions portably, so they are derived
+    from ``_fields_``; SDMA bitfields never straddle a dword.
+    """
+    layout, bit = {}, 0
+    for name, ctype, *bits in pkt._fields_:
+        width = bits[0] if bits else ctypes.sizeof(ctype) * 8
+        layout[name] = (bit, width)
+        bit += width
+    return layout
+
+
+def _bits(pkt: Any, field_name: str) -> int:
+    return field_layout(pkt)[field_name][1]
+
+
+# header fields of the packets encoded by this module
+PACKET_DEFAULTS = {
+    "copy_linear": {
+        "op": amd_gpu.SDMA_OP_COPY,
+        "sub_op": amd_gpu.SDMA_SUBOP_COPY_LINEAR,
+    },
+    "constant_fill": {"op": amd_gpu.SDMA_OP_CONST_FILL, "fillsize": 2},
+    "fence": {"op": amd_gpu.SDMA_OP_FENCE, "mtype": 3},
+    "trap": {"op": amd_gpu.SDMA_OP_TRAP},
+    "poll_regmem": {"op": amd_gpu.SDMA_OP_POLL_REGMEM},
+    "indirect": {"op": amd_gpu.SDMA_OP_INDIRECT},
+}
+
+
+def packet(name: str, **fields) -> ctypes.Structure:
+    """Builds one SDMA packet structure, filling in its opcode and default header fields."""
+    return getattr(SDMA_PKTS, name)(**{**PACKET_DEFAULTS.get(name, {}), **fields})
+
+
+# packet headers and limits, derived from the generated packet definitions
+COPY_LINEAR_HEADER = amd_gpu.SDMA_OP_COPY | amd_gpu.SDMA_SUBOP_COPY_LINEAR << 8
+CONSTANT_FILL_HEADER = amd_gpu.SDMA_OP_CONST_FILL | 2 << 30  # fillsize: dwords
+FENCE_HEADER = amd_gpu.SDMA_OP_FENCE | 3 << 16  # mtype: uncached
+TRAP_HEADER = amd_gpu.SDMA_OP_TRAP
+MAX_COPY_SIZE = 1 << _bits(SDMA_PKTS.copy_linear, "count")
+MAX_FILL_SIZE = 1 << _bits(SDMA_PKTS.constant_fill, "count")
+
+COPY_LINEAR_DWORDS = ctypes.sizeof(SDMA_PKTS.copy_linear) // 4
+CONSTANT_FILL_DWORDS = ctypes.sizeof(SDMA_PKTS.constant_fill) // 4
+FENCE_DWORDS = ctypes.sizeof(SDMA_PKTS.fence) // 4
+TRAP_DWORDS = ctypes.sizeof(SDMA_PKTS.trap) // 4
+
+
+def _split(
+    dsts: Sequence[int],
+    srcs: Sequence[int],
+    sizes: Sequence[int],
+    limit: int,
+    advance_src: bool = True,
+) -> tuple:
+    if all(size <= limit for size in sizes):
+        return dsts, srcs, sizes
+    out_dsts, out_srcs, out_sizes = [], [], []
+    for dst, src, size in zip(dsts, srcs, sizes):
+        for offset in range(0, size, limit):
+            out_dsts.append(dst + offset)
+            out_srcs.append(src + offset if advance_src else src)
+            out_sizes.append(min(limit, size - offset))
+    return out_dsts, out_srcs, out_sizes
+
+
+def _lo_hi(addrs: Iterable[int]) -> array:
+    # reinterpreting the 64-bit values as pairs of dwords splits them without a Python loop
+    lo_hi = array("I")
+    lo_hi.frombytes(array("Q", addrs).tobytes())
+    return lo_hi
+
+
+class SDMAStream:
+    """
+    An SDMA command stream encoded straight into an array of dwords.
+
+    Each method encodes a whole batch of packets of one kind. The packet
+    columns (header, addresses, counts) are written with strided slice
+    assignments, so no Python object is created per packet and the encode
+    cost of large copy batches stays in C. The layouts match SDMA_PKTS.
+
+    Example:
+        stream = SDMAStream()
+        stream.copy_linear(dsts, srcs, sizes)
+        stream.fence([signal_addr], [1])
+        stream.trap()
+        writer.submit(stream)
+    """
+
+    def __init__(self):
+        self.dwords = array("I")
+
+    def __len__(self) -> int:
+        return len(self.dwords)
+
+    @property
+    def nbytes(self) -> int:
+        return len(self.dwords) * 4
+
+    def _reserve(self, count: int, words: int) -> int:
+        start = len(self.dwords)
+        self.dwords.frombytes(bytes(count * words * 4))
+        return start
+
+    def _column(self, start: int, count: int, words: int, col: int, values) -> None:
+        end = start + count * words
+        self.dwords[start + col : end : words] = values
+
+    def copy_linear(
+        self, dsts: Sequence[int], srcs: Sequence[int], sizes: Sequence[int]
+    ) -> None:
+        """Encodes byte copies, splitting those larger than MAX_COPY_SIZE."""
+        dsts, srcs, sizes = _split(dsts, srcs, sizes, MAX_COPY_SIZE)
+        n, w = len(sizes), COPY_LINEAR_DWORDS
+        start = self._reserve(n, w)
+        src, dst = _lo_hi(srcs), _lo_hi(dsts)
+        self._column(start, n, w, 0, array("I", [COPY_LINEAR_HEADER]) * n)
+        self._column(start, n, w, 1, array("I", map((-1).__add__, sizes)))
+        self._column(start, n, w, 3, src[0::2])
+        self._column(start, n, w, 4, src[1::2])
+        self._column(start, n, w, 5, dst[0::2])
+        self._column(start, n, w, 6, dst[1::2])
+
+    def constant_fill(
+        self, dsts: Sequence[int], values: Sequence[int], sizes: Sequence[int]
+    ) -> None:
+        """Encodes fills of dword aligned ranges with a 32-bit value."""
+        dsts, values, sizes = _split(dsts, values, sizes, MAX_FILL_SIZE, False)
+        n, w = len(sizes), CONSTANT_FILL_DWORDS
+        start = self._reserve(n, w)
+        dst = _lo_hi(dsts)
+        self._column(start, n, w, 0, array("I", [CONSTANT_FILL_HEADER]) * n)
+        self._column(start, n, w, 1, dst[0::2])
+        self._column(start, n, w, 2, dst[1::2])
+        self._column(start, n, w, 3, array("I", values))
+        self._column(start, n, w, 4, array("I", map((-1).__add__, sizes)))
+
+    def fence(self, addrs: Sequence[int], values: Sequence[int]) -> None:
+        """Encodes fences that write a 32-bit value once all earlier packets completed."""
+        n, w = len(addrs), FENCE_DWORDS
+        start = self._reserve(n, w)
+        addr = _lo_hi(addrs)
+        self._column(start, n, w, 0, array("I", [FENCE_HEADER]) * n)
+        self._column(start, n, w, 1, addr[0::2])
+        self._column(start, n, w, 2, addr[1::2])
+        self._column(start, n, w, 3, array("I", values))
+
+    def trap(self, int_context: int = 0, count: int = 1) -> None:
+        """Encodes trap packets, which raise an interrupt that signals KFD events."""
+        start = self._reserve(count, TRAP_DWORDS)
+        self._column(start, count, TRAP_DWORDS, 0, array("I", [TRAP_HEADER]) * count)
+        self._column(start, count, TRAP_DWORDS, 1, array("I", [int_context]) * count)
+
+
+class SDMARingWriter:
+    """
+    Copies encoded SDMA streams into an SDMA ring and rings the doorbell once per stream.
+
+    SDMA read and write pointers count bytes. Packets must not wrap around the
+    end of the ring, so a stream that does not fit in the remaining space is
+    preceded by NOP dwords (zero) up to the end and written at the start.
+    Rings live in uncached GTT, so streams are written with streaming stores,
+    which are fenced before the write pointer and doorbell, see streaming.py.
+
+    Args:
+        ring_addr (int): Address of the ring.
+        ring_size (int): Ring size in bytes, a power of two.
+        write_ptr_addr (int): Address of the 64-bit write pointer.
+        read_ptr_addr (int): Address of the 64-bit read pointer the engine advances.
+        doorbell_addr (int): Address of the 64-bit doorbell.
+    """
+
+    def __init__(
+        self,
+        ring_addr: int,
+        ring_size: int,
+        write_ptr_addr: int,
+        read_ptr_addr: int,
+        doorbell_addr: int,
+    ):
+        assert ring_size & (ring_size - 1) == 0, "ring size must be a power of two"
+        self.ring_addr = ring_addr
+        self.ring_size = ring_size
+        self.write_ptr = ctypes.c_uint64.from_address(write_ptr_addr)
+        self.read_ptr = ctypes.c_uint64.from_address(read_ptr_addr)
+        self.doorbell = ctypes.c_uint64.from_address(doorbell_addr)
+        self.doorbell_writes = 0
+
+    def submit(
+        self,
+        stream: Union[SDMAStream, bytes, bytearray],
+        timeout: float = 10.0,
+        align: int = 4,
+        patch: Optional[Callable[[int], None]] = None,
+    ) -> int:
+        """
+        Writes a stream, or already encoded packets, and rings the doorbell.
+
+        Args:
+            align (int): Byte alignment of the start of the stream in the ring,
+                reached by NOP padding, e.g. 32 for runs of indirect packets.
+            patch (Optional[Callable[[int], None]]): Called with the ring address
+                of the stream once it is copied, before the write pointer moves,
+                e.g. to patch a CommandTemplate in place.
+
+        Returns:
+            int: The write pointer (in bytes) the stream starts at.
+        """
+        data = stream.dwords if isinstance(stream, SDMAStream) else stream
+        size = len(data) * getattr(data, "itemsize", 1)
+        assert size % 4 == 0, "SDMA packets are made of dwords"
+        wptr = self.write_ptr.value
+        tail = self.ring_size - wptr % self.ring_size
+        pad = -wptr % align
+        if tail < pad + size:
+            pad = tail
+        assert size + pad <= self.ring_size, "stream larger than the ring"
+        deadline = time.monotonic() + timeout
+        while wptr + pad + size - self.read_ptr.value > self.ring_size:
+            if time.monotonic() > deadline:
+                raise TimeoutError(
+                    "SDMA ring is full, the queue is not making progress"
+                )
+            time.sleep(0)
+        if pad:
+            copier().fill(self.ring_addr + wptr % self.ring_size, 0, pad)
+            wptr += pad
+        copier().copy(self.ring_addr + wptr % self.ring_size, data, size)
+        if patch is not None:
+            patch(self.ring_addr + wptr % self.ring_size)
+        self.write_ptr.value = wptr + size
+        self.doorbell.value = wptr + size
+        self.doorbell_writes += 1
+        return wptr
@@ -0,0 +1,204 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+An SDMA engine executing packets on the CPU, for queues of EmulatedKFDDevice.
+
+GPU virtual addresses of KFD allocations equal their CPU addresses, so on an
+emulated device, whose buffers are plain host memory, the engine can copy
+with memmove and fill with memset where the hardware would DMA. It consumes
+the ring between the read and the write pointer, which count bytes like
+those of SDMARingWriter, and stores the read pointer after every packet, so
+ring-full handling, wrap padding and encoders are validated end to end.
+
+Supported are NOP, COPY_LINEAR, CONSTANT_FILL, FENCE, POLL_REGMEM on memory
+(the HDP flush form is a no-op) and TRAP, which is handed to ``trap``, e.g.
+EmulatedKFD.interrupt to signal events. A POLL_REGMEM whose condition does
+not hold stalls the engine on the packet until a later call finds it true.
+Any other packet stops the engine like a hung queue: the read pointer stays
+on it and process raises.
+
+The engine runs either when ``process`` is called, or on its own thread
+(``start``/``stop``), which is what EmulatedKFD does for SDMA queues when
+created with ``sdma_engine=True``.
+
+Example:
+    engine = SDMAEngine.for_queue(queue)
+    writer.submit(stream)
+    engine.process()
+"""
+
+import ctypes
+import operator
+import threading
+from typing import Any, Callable, Optional
+
+from .decoder import sdma_packet
+from .sdma import SDMA_PKTS
+
+# POLL_REGMEM compare functions, applied as func(mem & mask, value)
+POLL_FUNCS = {
+    0: lambda a, b: True,
+    1: operator.lt,
+    2: operator.le,
+    3: operator.eq,
+    4: operator.ne,
+    5: operator.ge,
+    6: operator.gt,
+}
+
+FILL_SIZES = {0: 1, 2: 4}  # constant_fill fillsize: bytes of the fill value
+
+IDLE_INTERVAL = 1e-4
+
+
+class SDMAEngine:
+    """
+    Executes the packets of one SDMA ring, see the module docstring.
+
+    Args:
+        ring_addr (int): Address of the ring.
+        ring_size (int): Ring size in bytes, a power of two.
+        write_ptr_addr (int): Address of the 64-bit write pointer.
+        read_ptr_addr (int): Address of the 64-bit read pointer.
+        trap (Optional[Callable[[int], None]]): Called with the int_context of every TRAP.
+    """
+
+    def __init__(
+        self,
+        ring_addr: int,
+        ring_size: int,
+        write_ptr_addr: int,
+        read_ptr_addr: int,
+        trap: Optional[Callable[[int], None]] = None,
+    ):
+        self.ring_addr = ring_addr
+        self.ring_size = ring_size
+        self.write_ptr = ctypes.c_uint64.from_address(write_ptr_addr)
+        self.read_ptr = ctypes.c_uint64.from_address(read_ptr_addr)
+        self.trap = trap
+        self.packets = 0
+        self.stalled = False
+        self.error: Optional[Exception] = None
+        self._lock = threading.Lock()
+        self._stop = threading.Event()
+        self._thread: Optional[threading.Thread] = None
+
+    @classmethod
+    def for_queue(cls, queue: Any) -> "SDMAEngine":
+        """Creates the engine of an SDMA queue; traps interrupt the emulated driver."""
+        return cls(
+            queue.ring.va_addr,
+            queue.ring.size,
+            queue.args.write_pointer_address,
+            queue.args.read_pointer_address,
+            getattr(queue.device.KFD_IOCTL, "interrupt", None),
+        )
+
+    def retarget(self, ring_addr: int, ring_size: int) -> None:
+        """Switches to another ring, as update_queue does."""
+        with self._lock:
+            self.ring_addr, self.ring_size = ring_addr, ring_size
+
+    def process(self) -> int:
+        """
+        Executes packets until the read pointer reaches the write pointer or the engine stalls.
+
+        Returns:
+            int: The number of packets executed.
+        """
+        with self._lock:
+            rptr, executed = self.read_ptr.value, 0
+            self.stalled = False
+            while rptr < self.write_ptr.value:
+                addr = self.ring_addr + rptr % self.ring_size
+                name, dwords = sdma_packet(ctypes.c_uint32.from_address(addr).value)
+                execute = getattr(self, f"_{name}", None)
+                if execute is None:
+                    raise RuntimeError(
+                        f"SDMA engine stopped at unsupported packet {name} at rptr {rptr:#x}"
+                    )
+                if execute(addr) is False:
+                    self.stalled = True
+                    break
+                rptr += dwords * 4
+                self.read_ptr.value = rptr
+                executed += 1
+            self.packets += executed
+            return executed
+
+    def start(self, interval: float = IDLE_INTERVAL) -> None:
+        """Runs the engine on a thread that polls the write pointer every ``interval`` seconds when idle."""
+        assert self._thread is None, "the engine is already running"
+        self._stop.clear()
+        self._thread = threading.Thread(
+            target=self._run, args=(interval,), name="sdma-engine", daemon=True
+        )
+        self._thread.start()
+
+    def stop(self) -> None:
+        """Stops the engine thread; an error that stopped it stays in ``error``."""
+        if self._thread is not None:
+            self._stop.set()
+            self._thread.join()
+            self._thread = None
+
+    def _run(self, interval: float) -> None:
+        while not self._stop.is_set():
+            try:
+                busy = self.process()
+            except Exception as e:
+                self.error = e
+                return
+            if not busy:
+                self._stop.wait(interval)
+
+    def _nop(self, addr: int) -> None:
+        pass
+
+    def _copy_linear(self, addr: int) -> None:
+        pkt = SDMA_PKTS.copy_linear.from_address(addr)
+        ctypes.memmove(pkt.dst_addr, pkt.src_addr, pkt.count + 1)
+
+    def _constant_fill(self, addr: int) -> None:
+        pkt = SDMA_PKTS.constant_fill.from_address(addr)
+        dst, size, width = pkt.dst_addr, pkt.count + 1, FILL_SIZES[pkt.fillsize]
+        value = (pkt.src_data_31_0 & (1 << 8 * width) - 1).to_bytes(width, "little")
+        if value == value[:1] * width:
+            ctypes.memset(dst, value[0], size)
+            return
+        # replicate the value by doubling the filled prefix, one memmove per step
+        ctypes.memmove(dst, value, min(width, size))
+        filled = width
+        while filled < size:
+            step = min(filled, size - filled)
+            ctypes.memmove(dst + filled, dst, step)
+            filled += step
+
+    def _fence(self, addr: int) -> None:
+        pkt = SDMA_PKTS.fence.from_address(addr)
+        ctypes.c_uint32.from_address(pkt.addr).value = pkt.data
+
+    def _poll_regmem(self, addr: int) -> bool:
+        pkt = SDMA_PKTS.poll_regmem.from_address(addr)
+        if not pkt.mem_poll:
+            raise RuntimeError("SDMA engine cannot poll registers")
+        value = ctypes.c_uint32.from_address(pkt.addr).value
+        return POLL_FUNCS[pkt.func](value & pkt.mask, pkt.value)
+
+    def _hdp_flush(self, addr: int) -> None:
+        pass  # host writes are visible to the emulated engine without a flush
+
+    def _trap(self, addr: int) -> None:
+        pkt = SDMA_PKTS.trap.from_address(addr)
+        if self.trap is not None:
+            self.trap(pkt.int_context)
@@ -0,0 +1,274 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Atomic accesses to signal slots and a poll-then-sleep signal waiter.
+
+Signals are signed 64-bit values in host visible memory (e.g. the context's
+signals_page) that the GPU updates. Python has no atomic 64-bit operations,
+so they come from a small native helper, see native.py. Where it cannot be
+built, PythonAtomics stands in: its loads and stores are plain aligned
+64-bit accesses, which are single instructions on x86-64, but its
+read-modify-write operations are only atomic among Python threads.
+
+A completed short kernel is noticed fastest by spinning on its signal, while
+long waits should sleep in wait_events instead of burning a core.
+SignalWaiter spins for a configurable budget and then falls back to
+sleeping.
+"""
+
+import ctypes
+import functools
+import threading
+import time
+from typing import Any, Optional
+
+from . import native
+
+# hsa_signal_condition_t
+CONDITION_EQ, CONDITION_NE, CONDITION_LT, CONDITION_GTE = range(4)
+
+SOURCE = r"""
+#include <stdint.h>
+#include <time.h>
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static inline int satisfied(int64_t v, int condition, int64_t value) {
+    switch (condition) {
+    case 0: return v == value;
+    case 1: return v != value;
+    case 2: return v < value;
+    default: return v >= value;
+    }
+}
+
+int64_t fz_load(const int64_t *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+
+void fz_store(int64_t *p, int64_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+int64_t fz_cmpxchg(int64_t *p, int64_t expected, int64_t desired) {
+    __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_ACQ_REL,
+                                __ATOMIC_ACQUIRE);
+    return expected;
+}
+
+int64_t fz_fetch_add(int64_t *p, int64_t v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL);
+}
+
+/* Spins until the condition holds or budget_ns passed; the clock is read
+   every 64 polls only. */
+int fz_spin_wait(const int64_t *p, int condition, int64_t value,
+                 uint64_t budget_ns, int64_t *observed) {
+    uint64_t deadline = now_ns() + budget_ns;
+    for (;;) {
+        for (int i = 0; i < 64; i++) {
+            int64_t v = __atomic_load_n(p, __ATOMIC_ACQUIRE);
+            if (satisfied(v, condition, value)) {
+                *observed = v;
+                return 1;
+            }
+            cpu_relax();
+        }
+        if (now_ns() >= deadline) {
+            *observed = __atomic_load_n(p, __ATOMIC_ACQUIRE);
+            return 0;
+        }
+    }
+}
+"""
+
+
+def satisfied(v: int, condition: int, value: int) -> bool:
+    if condition == CONDITION_EQ:
+        return v == value
+    if condition == CONDITION_NE:
+        return v != value
+    if condition == CONDITION_LT:
+        return v < value
+    return v >= value
+
+
+class NativeAtomics:
+    """Atomic operations on 64-bit slots given by address, from the native helper."""
+
+    def __init__(self, lib: ctypes.CDLL):
+        i64, ptr = ctypes.c_int64, ctypes.c_void_p
+        for fn, argtypes, restype in [
+            (lib.fz_load, [ptr], i64),
+            (lib.fz_store, [ptr, i64], None),
+            (lib.fz_cmpxchg, [ptr, i64, i64], i64),
+            (lib.fz_fetch_add, [ptr, i64], i64),
+            (
+                lib.fz_spin_wait,
+                [ptr, ctypes.c_int, i64, ctypes.c_uint64, ctypes.POINTER(i64)],
+                ctypes.c_int,
+            ),
+        ]:
+            fn.argtypes, fn.restype = argtypes, restype
+        self.load = lib.fz_load
+        self.store = lib.fz_store
+        self.cmpxchg = lib.fz_cmpxchg
+        self.fetch_add = lib.fz_fetch_add
+        self._spin_wait = lib.fz_spin_wait
+        self._observed = threading.local()
+
+    def spin_wait(self, addr: int, condition: int, value: int, budget_s: float):
+        """
+        Spins with a pause instruction until the condition holds or the budget is used.
+
+        The GIL is released while spinning.
+
+        Returns:
+            Tuple[bool, int]: Whether the condition holds, and the last value seen.
+        """
+        observed = getattr(self._observed, "value", None)
+        if observed is None:
+            observed = self._observed.value = ctypes.c_int64()
+        ok = self._spin_wait(
+            addr, condition, value, int(budget_s * 1e9), ctypes.byref(observed)
+        )
+        return bool(ok), observed.value
+
+
+class PythonAtomics:
+    """The fallback when the native helper is unavailable, see the module docstring."""
+
+    def __init__(self):
+        self._lock = threading.Lock()
+
+    def load(self, addr: int) -> int:
+        return ctypes.c_int64.from_address(addr).value
+
+    def store(self, addr: int, value: int) -> None:
+        ctypes.c_int64.from_address(addr).value = value
+
+    def cmpxchg(self, addr: int, expected: int, desired: int) -> int:
+        """Stores ``desired`` if the slot holds ``expected``; returns the value seen."""
+        with self._lock:
+            slot = ctypes.c_int64.from_address(addr)
+            seen = slot.value
+            if seen == expected:
+                slot.value = desired
+            return seen
+
+    def fetch_add(self, addr: int, value: int) -> int:
+        with self._lock:
+            slot = ctypes.c_int64.from_address(addr)
+            seen = slot.value
+            slot.value = seen + value
+            return seen
+
+    def spin_wait(self, addr: int, condition: int, value: int, budget_s: float):
+        slot = ctypes.c_int64.from_address(addr)
+        deadline = time.perf_counter() + budget_s
+        while True:
+            v = slot.value
+            if satisfied(v, condition, value):
+                return True, v
+            if time.perf_counter() >= deadline:
+                return False, v
+
+
+@functools.lru_cache(maxsize=None)
+def default_atomics() -> Any:
+    """
+    Returns NativeAtomics if the helper builds, PythonAtomics otherwise.
+
+    Built on the first call, so importing the module runs no compiler.
+    """
+    lib = native.build("signals", SOURCE)
+    return NativeAtomics(lib) if lib is not None else PythonAtomics()
+
+
+class SignalWaiter:
+    """
+    Waits for signal values, spinning first and sleeping afterwards.
+
+    The wait spins for ``spin_us`` microseconds. If the signal is not
+    satisfied by then, it sleeps in wait_events on ``event_id`` (the event the
+    producer raises after updating the signal) in slices of ``sleep_ms``,
+    rechecking the value after each. Without an event it sleeps in
+    ``time.sleep`` slices instead.
+
+    Args:
+        device (Any): The KFDDevice owning ``event_id``, or None.
+        event_id (Optional[int]): The event raised when the signal changes.
+        spin_us (float): Spin budget in microseconds, 0 to sleep right away.
+        sleep_ms (int): Longest single sleep, bounding a missed wakeup.
+        atomics (Any): The atomics used, default_atomics() by default.
+    """
+
+    def __init__(
+        self,
+        device: Any = None,
+        event_id: Optional[int] = None,
+        spin_us: float = 100.0,
+        sleep_ms: int = 10,
+        atomics: Any = None,
+    ):
+        self.device = device
+        self.event_id = event_id
+        self.spin_us = spin_us
+        self.sleep_ms = sleep_ms
+        self.atomics = atomics or default_atomics()
+        self.spin_hits = 0
+        self.sleeps = 0
+
+    def wait(
+        self,
+        addr: int,
+        condition: int,
+        value: int,
+        timeout: float = 10.0,
+    ) -> int:
+        """
+        Waits until the signal at ``addr`` satisfies ``condition`` against ``value``.
+
+        Returns:
+            int: The satisfying signal value.
+
+        Raises:
+            TimeoutError: If the condition does not hold within ``timeout`` seconds.
+        """
+        deadline = time.monotonic() + timeout
+        budget = min(self.spin_us / 1e6, timeout)
+        ok, seen = self.atomics.spin_wait(addr, condition, value, budget)
+        if ok:
+            self.spin_hits += 1
+            return seen
+        while time.monotonic() < deadline:
+            self.sleeps += 1
+            remaining_ms = max(1, int((deadline - time.monotonic()) * 1000))
+            if self.event_id is not None:
+                self.device.wait_events(
+                    [self.event_id], timeout_ms=min(self.sleep_ms, remaining_ms)
+                )
+            else:
+                time.sleep(min(self.sleep_ms, remaining_ms) / 1000)
+            seen = self.atomics.load(addr)
+            if satisfied(seen, condition, value):
+                return seen
+        raise TimeoutError(f"signal at {addr:#x} still {seen} after {timeout}s")
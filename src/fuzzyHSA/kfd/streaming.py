@@ -0,0 +1,195 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Non-temporal copies into and out of uncached and write-combined mappings.
+
+GTT allocated with KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED and host visible VRAM
+are mapped uncached or write-combined. Ordinary stores into them are slow
+unless they fill whole 64-byte lines, and every read is a bus round trip.
+The native helper writes them with SSE2 streaming stores (movntdq) in full
+lines, reads them with SSE4.1 streaming loads (movntdqa) where the CPU has
+them, and never reads the destination. Streaming stores are weakly ordered,
+so every copy and fill ends with sfence: a write pointer or doorbell stored
+after it cannot overtake the data.
+
+Copies below STREAM_MIN bytes and CPUs other than x86-64 use memcpy and a
+full fence. Without a C compiler, PythonCopier does the same with
+ctypes.memmove and memset.
+"""
+
+import ctypes
+import functools
+from typing import Any, Union
+
+from . import native
+
+# smaller copies are not worth aligning for streaming stores
+STREAM_MIN = 256
+
+Source = Union[int, bytes, bytearray, memoryview, ctypes.Array]
+
+SOURCE = r"""
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__x86_64__)
+#include <emmintrin.h>
+#include <smmintrin.h>
+#endif
+
+#define STREAM_MIN 256
+
+static inline void store_fence(void) {
+#if defined(__x86_64__)
+    _mm_sfence();
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+void fz_stream_copy(char *dst, const char *src, size_t n) {
+#if defined(__x86_64__)
+    if (n >= STREAM_MIN) {
+        size_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+        memcpy(dst, src, head);
+        dst += head, src += head, n -= head;
+        for (; n >= 64; n -= 64, dst += 64, src += 64) {
+            __m128i a = _mm_loadu_si128((const __m128i *)src);
+            __m128i b = _mm_loadu_si128((const __m128i *)(src + 16));
+            __m128i c = _mm_loadu_si128((const __m128i *)(src + 32));
+            __m128i d = _mm_loadu_si128((const __m128i *)(src + 48));
+            _mm_stream_si128((__m128i *)dst, a);
+            _mm_stream_si128((__m128i *)(dst + 16), b);
+            _mm_stream_si128((__m128i *)(dst + 32), c);
+            _mm_stream_si128((__m128i *)(dst + 48), d);
+        }
+        for (; n >= 16; n -= 16, dst += 16, src += 16)
+            _mm_stream_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+    }
+#endif
+    memcpy(dst, src, n);
+    store_fence();
+}
+
+void fz_stream_fill(char *dst, int value, size_t n) {
+#if defined(__x86_64__)
+    if (n >= STREAM_MIN) {
+        size_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+        __m128i v = _mm_set1_epi8((char)value);
+        memset(dst, value, head);
+        dst += head, n -= head;
+        for (; n >= 16; n -= 16, dst += 16)
+            _mm_stream_si128((__m128i *)dst, v);
+    }
+#endif
+    memset(dst, value, n);
+    store_fence();
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.1")))
+static void stream_read(char *dst, const char *src, size_t n) {
+    size_t head = (16 - ((uintptr_t)src & 15)) & 15;
+    memcpy(dst, src, head);
+    dst += head, src += head, n -= head;
+    for (; n >= 64; n -= 64, dst += 64, src += 64) {
+        __m128i a = _mm_stream_load_si128((__m128i *)src);
+        __m128i b = _mm_stream_load_si128((__m128i *)(src + 16));
+        __m128i c = _mm_stream_load_si128((__m128i *)(src + 32));
+        __m128i d = _mm_stream_load_si128((__m128i *)(src + 48));
+        _mm_storeu_si128((__m128i *)dst, a);
+        _mm_storeu_si128((__m128i *)(dst + 16), b);
+        _mm_storeu_si128((__m128i *)(dst + 32), c);
+        _mm_storeu_si128((__m128i *)(dst + 48), d);
+    }
+    memcpy(dst, src, n);
+}
+#endif
+
+void fz_stream_read(char *dst, const char *src, size_t n) {
+#if defined(__x86_64__)
+    if (n >= STREAM_MIN && __builtin_cpu_supports("sse4.1")) {
+        /* streaming loads see WC data only after earlier stores are fenced */
+        _mm_mfence();
+        stream_read(dst, src, n);
+        return;
+    }
+#endif
+    memcpy(dst, src, n);
+}
+"""
+
+
+def pointer(data: Source) -> Any:
+    """Returns something ctypes passes as the address of ``data``'s bytes, without copying writable buffers."""
+    if isinstance(data, (int, bytes)):
+        return data
+    if isinstance(data, ctypes.Array):
+        return ctypes.addressof(data)
+    view = memoryview(data).cast("B")
+    if view.readonly:
+        return view.tobytes()
+    return ctypes.addressof((ctypes.c_char * view.nbytes).from_buffer(view))
+
+
+class NativeCopier:
+    """Streaming copies from the native helper, see the module docstring."""
+
+    def __init__(self, lib: ctypes.CDLL):
+        ptr, size = ctypes.c_void_p, ctypes.c_size_t
+        for fn, argtypes in [
+            (lib.fz_stream_copy, [ptr, ptr, size]),
+            (lib.fz_stream_fill, [ptr, ctypes.c_int, size]),
+            (lib.fz_stream_read, [ptr, ptr, size]),
+        ]:
+            fn.argtypes, fn.restype = argtypes, None
+        self._copy = lib.fz_stream_copy
+        self._fill = lib.fz_stream_fill
+        self._read = lib.fz_stream_read
+
+    def copy(self, dst: int, src: Source, size: int) -> None:
+        """Copies ``size`` bytes to ``dst`` with streaming stores, then fences."""
+        self._copy(dst, pointer(src), size)
+
+    def fill(self, dst: int, value: int, size: int) -> None:
+        """Sets ``size`` bytes at ``dst`` to the byte ``value`` with streaming stores."""
+        self._fill(dst, value, size)
+
+    def read(self, dst: Source, src: int, size: int) -> None:
+        """Copies ``size`` bytes out of an uncached or write-combined mapping at ``src``."""
+        self._read(pointer(dst), src, size)
+
+
+class PythonCopier:
+    """The fallback when the native helper is unavailable: plain memmove and memset."""
+
+    def copy(self, dst: int, src: Source, size: int) -> None:
+        ctypes.memmove(dst, pointer(src), size)
+
+    def fill(self, dst: int, value: int, size: int) -> None:
+        ctypes.memset(dst, value, size)
+
+    def read(self, dst: Source, src: int, size: int) -> None:
+        ctypes.memmove(pointer(dst), src, size)
+
+
+@functools.lru_cache(maxsize=None)
+def copier() -> Any:
+    """
+    Returns NativeCopier if the helper builds, PythonCopier otherwise.
+
+    The helper is built on the first call rather than at import, so importing
+    the package runs no compiler and writes nothing to the cache directory.
+    """
+    lib = native.build("streaming", SOURCE)
+    return NativeCopier(lib) if lib is not None else PythonCopier()
@@ -0,0 +1,440 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import bisect
+import ctypes
+import dataclasses
+import functools
+import mmap
+import random
+from typing import Any, Callable, Dict, Iterator, List, Optional, Sequence, Tuple
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+SVM_FLAGS_MASK = functools.reduce(
+    lambda acc, name: acc | getattr(kfd, name),
+    [name for name in dir(kfd) if name.startswith("KFD_IOCTL_SVM_FLAG_")],
+    0,
+)
+
+
+@functools.lru_cache(maxsize=None)
+def svm_args_type(nattr: int) -> type:
+    """Returns kfd_ioctl_svm_args with its flexible attrs array sized to nattr."""
+    return type(
+        f"struct_kfd_ioctl_svm_args_{nattr}",
+        (ctypes.Structure,),
+        {
+            "_fields_": kfd.struct_kfd_ioctl_svm_args._fields_[:-1]
+            + [("attrs", kfd.struct_kfd_ioctl_svm_attribute * nattr)]
+        },
+    )
+
+
+def make_svm_args(
+    start: int, size: int, op: int, attrs: Sequence[Tuple[int, int]]
+) -> ctypes.Structure:
+    """Builds the variable length argument structure for the svm ioctl."""
+    args = svm_args_type(len(attrs))(
+        start_addr=start, size=size, op=op, nattr=len(attrs)
+    )
+    for i, (attr_type, value) in enumerate(attrs):
+        args.attrs[i].type, args.attrs[i].value = attr_type, value
+    return args
+
+
+class IntervalMap:
+    """
+    Maps disjoint half-open address ranges to values.
+
+    Addresses not covered by a segment map to ``default``. Adjacent segments
+    holding equal values are merged, so the number of segments stays
+    proportional to the number of distinct attribute runs rather than pages.
+    """
+
+    def __init__(self, default: Any = None):
+        self.default = default
+        self._starts: List[int] = []
+        self._ends: List[int] = []
+        self._values: List[Any] = []
+
+    def __len__(self) -> int:
+        return len(self._starts)
+
+    def get(self, addr: int) -> Any:
+        i = bisect.bisect_right(self._ends, addr)
+        if i < len(self._starts) and self._starts[i] <= addr:
+            return self._values[i]
+        return self.default
+
+    def segments(self, start: int, end: int) -> Iterator[Tuple[int, int, Any]]:
+        """Yields ``(start, end, value)`` runs exactly covering ``[start, end)``."""
+        i = bisect.bisect_right(self._ends, start)
+        pos = start
+        while pos < end:
+            if i < len(self._starts) and self._starts[i] < end:
+                if self._starts[i] > pos:
+                    yield pos, self._starts[i], self.default
+                    pos = self._starts[i]
+                seg_end = min(self._ends[i], end)
+                yield pos, seg_end, self._values[i]
+                pos, i = seg_end, i + 1
+            else:
+                yield pos, end, self.default
+                pos = end
+
+    def update(self, start: int, end: int, fn: Callable[[Any], Any]) -> None:
+        """Replaces every value ``v`` inside ``[start, end)`` with ``fn(v)``."""
+        lo = bisect.bisect_right(self._ends, start)
+        hi = bisect.bisect_left(self._starts, end)
+
+        pieces = [(s, e, fn(v)) for s, e, v in self.segments(start, end)]
+        if lo < hi and self._starts[lo] < start:
+            pieces.insert(0, (self._starts[lo], start, self._values[lo]))
+        if lo < hi and self._ends[hi - 1] > end:
+            pieces.append((end, self._ends[hi - 1], self._values[hi - 1]))
+        # pull in untouched neighbours so equal values merge across the boundary
+        if lo > 0 and self._ends[lo - 1] == pieces[0][0]:
+            lo -= 1
+            pieces.insert(0, (self._starts[lo], self._ends[lo], self._values[lo]))
+        if hi < len(self._starts) and self._starts[hi] == pieces[-1][1]:
+            pieces.append((self._starts[hi], self._ends[hi], self._values[hi]))
+            hi += 1
+
+        merged: List[Tuple[int, int, Any]] = []
+        for s, e, v in pieces:
+            if merged and merged[-1][1] == s and merged[-1][2] == v:
+                merged[-1] = (merged[-1][0], e, v)
+            else:
+                merged.append((s, e, v))
+        merged = [piece for piece in merged if piece[2] != self.default]
+
+        self._starts[lo:hi] = [s for s, _, _ in merged]
+        self._ends[lo:hi] = [e for _, e, _ in merged]
+        self._values[lo:hi] = [v for _, _, v in merged]
+
+
+@dataclasses.dataclass(frozen=True)
+class SVMAttributes:
+    """Attributes of an SVM range; None means not specified by this process."""
+
+    preferred_loc: Optional[int] = None
+    granularity: Optional[int] = None
+    flags: Optional[int] = None
+    access: Tuple[Tuple[int, int], ...] = ()
+
+    def with_access(self, access: Dict[int, int]) -> "SVMAttributes":
+        merged = dict(self.access)
+        merged.update(access)
+        return dataclasses.replace(self, access=tuple(sorted(merged.items())))
+
+    def delta(self, committed: "SVMAttributes") -> Tuple[Tuple[int, int], ...]:
+        """Returns the ioctl attributes needed to move ``committed`` to this state."""
+        attrs = []
+        if (
+            self.preferred_loc is not None
+            and self.preferred_loc != committed.preferred_loc
+        ):
+            attrs.append((kfd.KFD_IOCTL_SVM_ATTR_PREFERRED_LOC, self.preferred_loc))
+        if self.granularity is not None and self.granularity != committed.granularity:
+            attrs.append((kfd.KFD_IOCTL_SVM_ATTR_GRANULARITY, self.granularity))
+        if self.flags is not None and self.flags != committed.flags:
+            # with unknown committed flags every flag is set or cleared explicitly
+            known = SVM_FLAGS_MASK if committed.flags is None else committed.flags
+            added = self.flags & ~(committed.flags or 0)
+            if added:
+                attrs.append((kfd.KFD_IOCTL_SVM_ATTR_SET_FLAGS, added))
+            if known & ~self.flags:
+                attrs.append((kfd.KFD_IOCTL_SVM_ATTR_CLR_FLAGS, known & ~self.flags))
+        committed_access = dict(committed.access)
+        for gpu_id, access in self.access:
+            if committed_access.get(gpu_id) != access:
+                attrs.append((access, gpu_id))
+        return tuple(attrs)
+
+
+class SVMRangeManager:
+    """
+    Tracks SVM range attributes and applies them with as few svm ioctls as possible.
+
+    ``set_attributes`` only records the desired state in an interval map. On
+    ``flush`` the dirty address ranges are diffed against the state last sent
+    to KFD, and every maximal run of pages needing the same attribute change is
+    applied with a single KFD_IOCTL_SVM_OP_SET_ATTR call. Setting attributes
+    page by page therefore costs one ioctl per homogeneous run, not per page.
+
+    Example:
+        svm = SVMRangeManager(device)
+        for page in pages:
+            svm.set_attributes(page, 0x1000, preferred_loc=device.gpu_id)
+        svm.flush()
+    """
+
+    def __init__(self, device: Any):
+        self.device = device
+        self.desired = IntervalMap(SVMAttributes())
+        self.committed = IntervalMap(SVMAttributes())
+        self.dirty = IntervalMap(False)
+        self.ioctl_count = 0
+
+    def _svm(self, start: int, size: int, op: int, attrs: Sequence[Tuple[int, int]]):
+        self.ioctl_count += 1
+        args = make_svm_args(start, size, op, attrs)
+        return self.device.KFD_IOCTL.svm(self.device.kfd, args)
+
+    def set_attributes(
+        self,
+        start: int,
+        size: int,
+        preferred_loc: Optional[int] = None,
+        granularity: Optional[int] = None,
+        set_flags: int = 0,
+        clr_flags: int = 0,
+        access: Optional[Dict[int, int]] = None,
+    ) -> None:
+        """
+        Records attribute changes for ``[start, start + size)``, applied on flush.
+
+        Args:
+            start (int): Page aligned start address of the range.
+            size (int): Page aligned size of the range in bytes.
+            preferred_loc (Optional[int]): gpu_id of the preferred location, 0 for system memory.
+            granularity (Optional[int]): Migration granularity as log2 of the page count.
+            set_flags (int): KFD_IOCTL_SVM_FLAG_* bits to set.
+            clr_flags (int): KFD_IOCTL_SVM_FLAG_* bits to clear.
+            access (Optional[Dict[int, int]]): gpu_id to KFD_IOCTL_SVM_ATTR_ACCESS,
+                KFD_IOCTL_SVM_ATTR_ACCESS_IN_PLACE or KFD_IOCTL_SVM_ATTR_NO_ACCESS.
+        """
+        assert (
+            start % mmap.PAGESIZE == 0 and size % mmap.PAGESIZE == 0
+        ), "SVM ranges must be page aligned"
+
+        def apply(attrs: SVMAttributes) -> SVMAttributes:
+            changes = {}
+            if preferred_loc is not None:
+                changes["preferred_loc"] = preferred_loc
+            if granularity is not None:
+                changes["granularity"] = granularity
+            if set_flags or clr_flags:
+                # unknown flags are assumed to be the KFD defaults
+                flags = attrs.flags
+                if flags is None:
+                    flags = (
+                        kfd.KFD_IOCTL_SVM_FLAG_HOST_ACCESS
+                        | kfd.KFD_IOCTL_SVM_FLAG_COHERENT
+                    )
+                changes["flags"] = (flags | set_flags) & ~clr_flags
+            attrs = dataclasses.replace(attrs, **changes)
+            return attrs.with_access(access) if access else attrs
+
+        self.desired.update(start, start + size, apply)
+        self.dirty.update(start, start + size, lambda _: True)
+
+    def flush(self) -> int:
+        """
+        Sends all pending attribute changes to KFD.
+
+        Returns:
+            int: The number of svm ioctls issued.
+        """
+        issued = 0
+        for dirty_start, dirty_end, is_dirty in list(self.dirty.segments(0, 1 << 64)):
+            if not is_dirty:
+                continue
+            runs: List[Tuple[int, int, Tuple[Tuple[int, int], ...]]] = []
+            for s, e, desired in self.desired.segments(dirty_start, dirty_end):
+                for cs, ce, committed in self.committed.segments(s, e):
+                    attrs = desired.delta(committed)
+                    if runs and runs[-1][1] == cs and runs[-1][2] == attrs:
+                        runs[-1] = (runs[-1][0], ce, attrs)
+                    else:
+                        runs.append((cs, ce, attrs))
+            for s, e, attrs in runs:
+                if attrs:
+                    self._svm(s, e - s, kfd.KFD_IOCTL_SVM_OP_SET_ATTR, attrs)
+                    issued += 1
+            for s, e, desired in list(self.desired.segments(dirty_start, dirty_end)):
+                self.committed.update(s, e, lambda _, value=desired: value)
+        self.dirty = IntervalMap(False)
+        return issued
+
+    def prefetch(self, start: int, size: int, location: int) -> None:
+        """
+        Migrates ``[start, start + size)`` to ``location`` (a gpu_id, 0 for system memory).
+
+        Pending attribute changes are flushed first so the migration honours them.
+        """
+        self.flush()
+        self._svm(
+            start,
+            size,
+            kfd.KFD_IOCTL_SVM_OP_SET_ATTR,
+            [(kfd.KFD_IOCTL_SVM_ATTR_PREFETCH_LOC, location)],
+        )
+
+    def query(
+        self, start: int, size: int, gpu_ids: Sequence[int] = ()
+    ) -> Dict[Any, int]:
+        """
+        Reads the attributes KFD reports for ``[start, start + size)``.
+
+        Returns:
+            Dict[Any, int]: KFD_IOCTL_SVM_ATTR_* type to value, plus ``("access", gpu_id)``
+            to the access attribute reported for each requested GPU.
+        """
+        queried = [
+            (kfd.KFD_IOCTL_SVM_ATTR_PREFERRED_LOC, 0),
+            (kfd.KFD_IOCTL_SVM_ATTR_PREFETCH_LOC, 0),
+            (kfd.KFD_IOCTL_SVM_ATTR_SET_FLAGS, 0),
+            (kfd.KFD_IOCTL_SVM_ATTR_CLR_FLAGS, 0),
+            (kfd.KFD_IOCTL_SVM_ATTR_GRANULARITY, 0),
+        ] + [(kfd.KFD_IOCTL_SVM_ATTR_ACCESS, gpu_id) for gpu_id in gpu_ids]
+        args = self._svm(start, size, kfd.KFD_IOCTL_SVM_OP_GET_ATTR, queried)
+        result = {}
+        for i in range(args.nattr):
+            attr = args.attrs[i]
+            if i >= 5:
+                result[("access", gpu_ids[i - 5])] = attr.type
+            else:
+                result[attr.type] = attr.value
+        return result
+
+
+class SVMDivergence(AssertionError):
+    """Raised when KFD reports SVM attributes that differ from the shadow model."""
+
+
+def fuzz_svm_attributes(
+    manager: SVMRangeManager,
+    base: int,
+    npages: int,
+    gpu_ids: Sequence[int],
+    seed: int = 0,
+    steps: int = 200,
+) -> List[Tuple]:
+    """
+    Applies a random sequence of SVM attribute updates and checks every query against a shadow model.
+
+    The shadow model tracks attributes page by page, independently of the
+    manager's interval maps, and predicts what KFD_IOCTL_SVM_OP_GET_ATTR must
+    report for any sub-range. The range is fully initialized first so the
+    prediction does not depend on driver defaults.
+
+    Args:
+        manager (SVMRangeManager): Manager bound to the device under test.
+        base (int): Page aligned start of a host range owned by the caller.
+        npages (int): Number of pages in the range.
+        gpu_ids (Sequence[int]): GPUs to set access attributes for.
+        seed (int): Seed for the operation sequence, making failures reproducible.
+        steps (int): Number of random operations.
+
+    Returns:
+        List[Tuple]: The operation log.
+
+    Raises:
+        SVMDivergence: If a query disagrees with the shadow model; the message holds the log.
+    """
+    rng = random.Random(seed)
+    page = mmap.PAGESIZE
+    locations = [kfd.KFD_IOCTL_SVM_LOCATION_SYSMEM, *gpu_ids]
+    accesses = [
+        kfd.KFD_IOCTL_SVM_ATTR_ACCESS,
+        kfd.KFD_IOCTL_SVM_ATTR_ACCESS_IN_PLACE,
+        kfd.KFD_IOCTL_SVM_ATTR_NO_ACCESS,
+    ]
+    flags = [getattr(kfd, n) for n in dir(kfd) if n.startswith("KFD_IOCTL_SVM_FLAG_")]
+    initial = {
+        "preferred_loc": kfd.KFD_IOCTL_SVM_LOCATION_SYSMEM,
+        "granularity": 9,
+        "flags": kfd.KFD_IOCTL_SVM_FLAG_HOST_ACCESS,
+        "access": {gpu_id: kfd.KFD_IOCTL_SVM_ATTR_NO_ACCESS for gpu_id in gpu_ids},
+    }
+    shadow = [dict(initial, access=dict(initial["access"])) for _ in range(npages)]
+    log: List[Tuple] = [("init", base, npages)]
+    manager.set_attributes(
+        base,
+        npages * page,
+        preferred_loc=initial["preferred_loc"],
+        granularity=initial["granularity"],
+        set_flags=initial["flags"],
+        clr_flags=SVM_FLAGS_MASK & ~initial["flags"],
+        access=initial["access"],
+    )
+
+    for _ in range(steps):
+        first = rng.randrange(npages)
+        count = rng.randint(1, npages - first)
+        op = rng.choice(["set", "set", "set", "flush", "query"])
+        if op == "set":
+            kwargs = {}
+            if rng.random() < 0.5:
+                kwargs["preferred_loc"] = rng.choice(locations)
+            if rng.random() < 0.3:
+                kwargs["granularity"] = rng.randint(0, 9)
+            if rng.random() < 0.4:
+                kwargs["set_flags"] = rng.choice(flags)
+            if rng.random() < 0.4:
+                kwargs["clr_flags"] = rng.choice(flags)
+            if gpu_ids and rng.random() < 0.5:
+                kwargs["access"] = {rng.choice(gpu_ids): rng.choice(accesses)}
+            log.append(("set", first, count, kwargs))
+            manager.set_attributes(base + first * page, count * page, **kwargs)
+            for p in shadow[first : first + count]:
+                for key in ("preferred_loc", "granularity"):
+                    if key in kwargs:
+                        p[key] = kwargs[key]
+                p["flags"] = (p["flags"] | kwargs.get("set_flags", 0)) & ~kwargs.get(
+                    "clr_flags", 0
+                )
+                p["access"].update(kwargs.get("access", {}))
+        elif op == "flush":
+            log.append(("flush",))
+            manager.flush()
+        else:
+            log.append(("query", first, count))
+            manager.flush()
+            got = manager.query(base + first * page, count * page, gpu_ids)
+            expected = _shadow_query(shadow[first : first + count], gpu_ids)
+            got[kfd.KFD_IOCTL_SVM_ATTR_CLR_FLAGS] &= SVM_FLAGS_MASK
+            for key, value in expected.items():
+                if got.get(key) != value:
+                    raise SVMDivergence(
+                        f"svm attribute {key} is {got.get(key)}, shadow model expects {value}; ops: {log}"
+                    )
+    return log
+
+
+def _shadow_query(
+    pages: List[Dict[str, Any]], gpu_ids: Sequence[int]
+) -> Dict[Any, int]:
+    def uniform(key: str) -> int:
+        values = {p[key] for p in pages}
+        return (
+            values.pop() if len(values) == 1 else kfd.KFD_IOCTL_SVM_LOCATION_UNDEFINED
+        )
+
+    expected = {
+        kfd.KFD_IOCTL_SVM_ATTR_PREFERRED_LOC: uniform("preferred_loc"),
+        kfd.KFD_IOCTL_SVM_ATTR_GRANULARITY: min(p["granularity"] for p in pages),
+        kfd.KFD_IOCTL_SVM_ATTR_SET_FLAGS: functools.reduce(
+            lambda acc, p: acc & p["flags"], pages, SVM_FLAGS_MASK
+        ),
+        kfd.KFD_IOCTL_SVM_ATTR_CLR_FLAGS: functools.reduce(
+            lambda acc, p: acc & ~p["flags"], pages, SVM_FLAGS_MASK
+        ),
+    }
+    for gpu_id in gpu_ids:
+        access = {p["access"][gpu_id] for p in pages}
+        expected[("access", gpu_id)] = (
+            access.pop() if len(access) == 1 else kfd.KFD_IOCTL_SVM_ATTR_NO_ACCESS
+        )
+    return expected
@@ -0,0 +1,299 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Command-buffer templates: record a packet stream once, then replay it with new values.
+
+Streams that are submitted over and over with only a few values changing
+(buffer addresses, sizes, signal values) are recorded into a
+CommandTemplate whose named patch points remember where those values live.
+A replay copies the recorded bytes and rewrites only the patch points, so
+no packet is encoded again.
+
+Example:
+    rec = TemplateRecorder("sdma")
+    rec.sdma_copy(dst=Patch("dst"), src=Patch("src"), size=Patch("size"))
+    rec.sdma_fence(addr=Patch("signal"), value=Patch("value", 1))
+    copy = rec.finish()
+    copy.replay(writer, dst=b.va_addr, src=a.va_addr, size=4096, value=2)
+"""
+
+import ctypes
+import struct
+from dataclasses import dataclass
+from typing import Any, Dict, List, Mapping, Optional, Sequence, Union
+
+from . import aql, sdma
+
+KINDS = ("sdma", "aql", "pm4")
+
+
+@dataclass(frozen=True)
+class Patch:
+    """A named placeholder for a value that changes between replays."""
+
+    name: str
+    default: int = 0
+    bias: int = 0  # added to the value before it is stored, e.g. -1 for SDMA counts
+    size: int = 4  # bytes patched in raw and pm4 streams, 8 for an address lo/hi pair
+
+
+@dataclass(frozen=True)
+class PatchPoint:
+    """Where a patched value is stored: ``bits`` bits at ``shift`` of the word at ``offset``."""
+
+    name: str
+    offset: int
+    size: int  # 4 or 8 bytes
+    shift: int = 0
+    bits: int = 0
+    bias: int = 0
+
+    @property
+    def full_width(self) -> bool:
+        return self.shift == 0 and self.bits == self.size * 8
+
+    def apply(
+        self, buf: Union[bytearray, memoryview], value: int, base: int = 0
+    ) -> None:
+        """Patches ``value`` into ``buf``, holding the stream from offset ``base`` on."""
+        fmt = "<I" if self.size == 4 else "<Q"
+        offset = self.offset - base
+        value += self.bias
+        if self.full_width:
+            struct.pack_into(fmt, buf, offset, value & ((1 << self.bits) - 1))
+            return
+        mask = ((1 << self.bits) - 1) << self.shift
+        (word,) = struct.unpack_from(fmt, buf, offset)
+        struct.pack_into(fmt, buf, offset, word & ~mask | (value << self.shift) & mask)
+
+
+class CommandTemplate:
+    """
+    A recorded packet stream with named patch points.
+
+    Attributes:
+        kind (str): "sdma", "aql" or "pm4", the queue type the stream is meant for.
+        data (bytes): The stream as recorded, with patch points holding their defaults.
+        patches (Dict[str, List[PatchPoint]]): Patch points by name; one name may
+            patch several places, e.g. a size used by two packets.
+    """
+
+    def __init__(self, kind: str, data: bytes, patches: Dict[str, List[PatchPoint]]):
+        self.kind = kind
+        self.data = data
+        self.patches = patches
+        self._scratch = bytearray(data)
+
+    def __len__(self) -> int:
+        return len(self.data)
+
+    def render_into(self, buf: Any, values: Mapping[str, int], offset: int = 0) -> None:
+        """
+        Copies the template into a writable buffer and patches the given values.
+
+        Names not in ``values`` keep their recorded value.
+
+        Raises:
+            KeyError: If a value is given for a name the template has no patch point for.
+        """
+        view = memoryview(buf).cast("B")[offset : offset + len(self.data)]
+        view[:] = self.data
+        for name, value in values.items():
+            for point in self.patches[name]:
+                point.apply(view, value)
+
+    def render(self, **values: int) -> bytearray:
+        """Returns a patched copy of the stream."""
+        buf = bytearray(len(self.data))
+        self.render_into(buf, values)
+        return buf
+
+    def patch_at(self, addr: int, values: Mapping[str, int]) -> None:
+        """
+        Patches the given values into a copy of the recorded stream at ``addr``.
+
+        Patched words are built from the recorded data and only stored, so
+        the copy, e.g. in an uncached ring, is never read back.
+        """
+        words: Dict[int, bytearray] = {}
+        for name, value in values.items():
+            for point in self.patches[name]:
+                word = words.get(point.offset)
+                if word is None:
+                    end = point.offset + point.size
+                    word = bytearray(self.data[point.offset : end])
+                    words[point.offset] = word
+                point.apply(word, value, base=point.offset)
+        for offset, word in words.items():
+            ctypes.memmove(addr + offset, bytes(word), len(word))
+
+    def replay(self, writer: Any, **values: int) -> int:
+        """
+        Patches the stream and submits it through a ring writer.
+
+        SDMA streams are copied into the ring as recorded and patched there,
+        before the write pointer moves. AQL packets are rendered into a
+        scratch buffer owned by the template first: the writer publishes each
+        header last, from the packet it was given, and patch points may lie in
+        the header's first 8 bytes, so they cannot be patched in the ring
+        afterwards. Concurrent AQL replays of one template are therefore not
+        allowed.
+
+        Args:
+            writer: An sdma.SDMARingWriter for "sdma" templates or an
+                aql.AQLRingWriter for "aql" templates.
+
+        Returns:
+            int: What the writer's submit returns, the start of the stream in the ring.
+        """
+        if self.kind == "aql":
+            self.render_into(self._scratch, values)
+            view = memoryview(self._scratch)
+            return writer.submit(
+                [
+                    view[i : i + aql.AQL_PACKET_SIZE]
+                    for i in range(0, len(view), aql.AQL_PACKET_SIZE)
+                ]
+            )
+        if self.kind == "sdma":
+            unknown = set(values) - set(self.patches)
+            if unknown:
+                raise KeyError(f"no patch points named {sorted(unknown)}")
+            return writer.submit(
+                self.data, patch=lambda addr: self.patch_at(addr, values)
+            )
+        raise ValueError("pm4 templates are replayed into indirect buffers, use render")
+
+
+class TemplateRecorder:
+    """
+    Records packets and their patch points into a CommandTemplate.
+
+    Packet fields given as a Patch become patch points; plain integers are
+    recorded as they are.
+
+    Args:
+        kind (str): "sdma", "aql" or "pm4".
+    """
+
+    def __init__(self, kind: str):
+        assert kind in KINDS, f"kind must be one of {KINDS}"
+        self.kind = kind
+        self._data = bytearray()
+        self._patches: Dict[str, List[PatchPoint]] = {}
+
+    def _point(self, patch: Patch, offset: int, size: int, shift=0, bits=None):
+        # offset is into the recorded data, which already holds the packet
+        point = PatchPoint(
+            patch.name, offset, size, shift, bits or size * 8, patch.bias
+        )
+        point.apply(self._data, patch.default)
+        self._patches.setdefault(patch.name, []).append(point)
+
+    def raw(self, data: bytes, patches: Optional[Mapping[int, Patch]] = None) -> None:
+        """
+        Appends pre-encoded bytes.
+
+        Args:
+            data (bytes): The packet bytes.
+            patches (Optional[Mapping[int, Patch]]): Byte offset within ``data`` of every
+                patch point, each patching Patch.size bytes.
+        """
+        base = len(self._data)
+        self._data += data
+        for offset, patch in (patches or {}).items():
+            self._point(patch, base + offset, patch.size)
+
+    def sdma(self, name: str, **fields: Union[int, Patch]) -> None:
+        """Records one SDMA packet of SDMA_PKTS, e.g. ``sdma("fence", addr=Patch("signal"))``."""
+        assert self.kind == "sdma"
+        pkt_type = getattr(sdma.SDMA_PKTS, name)
+        pkt = sdma.packet(
+            name, **{k: v for k, v in fields.items() if not isinstance(v, Patch)}
+        )
+        base = len(self._data)
+        self._data += bytes(pkt)
+        layout = sdma.field_layout(pkt_type)
+        for field_name, value in fields.items():
+            if isinstance(value, Patch):
+                bit, width = layout[field_name]
+                # 64-bit fields start on a dword, not always on a qword
+                size, unit = (8, bit // 8) if width == 64 else (4, bit // 32 * 4)
+                self._point(value, base + unit, size, bit - unit * 8, width)
+
+    def sdma_copy(
+        self, dst: Union[int, Patch], src: Union[int, Patch], size: Union[int, Patch]
+    ) -> None:
+        """Records a linear copy of at most sdma.MAX_COPY_SIZE bytes."""
+        count = (
+            Patch(size.name, size.default, size.bias - 1)
+            if isinstance(size, Patch)
+            else size - 1
+        )
+        self.sdma("copy_linear", dst_addr=dst, src_addr=src, count=count)
+
+    def sdma_fill(
+        self, dst: Union[int, Patch], value: Union[int, Patch], size: Union[int, Patch]
+    ) -> None:
+        """Records a constant fill of at most sdma.MAX_FILL_SIZE bytes."""
+        count = (
+            Patch(size.name, size.default, size.bias - 1)
+            if isinstance(size, Patch)
+            else size - 1
+        )
+        self.sdma("constant_fill", dst_addr=dst, src_data_31_0=value, count=count)
+
+    def sdma_fence(self, addr: Union[int, Patch], value: Union[int, Patch]) -> None:
+        self.sdma("fence", addr=addr, data=value)
+
+    def sdma_trap(self, int_context: Union[int, Patch] = 0) -> None:
+        self.sdma("trap", int_context=int_context)
+
+    def aql(self, pkt: ctypes.Structure, **patches: Patch) -> None:
+        """
+        Records one AQL packet; ``patches`` maps packet fields such as
+        ``kernarg_address`` or ``completion_signal`` to patch points.
+        """
+        assert self.kind == "aql"
+        base = len(self._data)
+        self._data += bytes(pkt)
+        fields = {f[0]: f[1] for f in type(pkt)._fields_}
+        for field_name, patch in patches.items():
+            size = ctypes.sizeof(fields[field_name])
+            assert size in (4, 8), f"{field_name} cannot be patched"
+            self._point(patch, base + getattr(type(pkt), field_name).offset, size)
+
+    def pm4(
+        self, dwords: Sequence[int], patches: Optional[Mapping[int, Patch]] = None
+    ) -> None:
+        """
+        Records one PM4 packet.
+
+        Args:
+            dwords (Sequence[int]): The packet, header first.
+            patches (Optional[Mapping[int, Patch]]): dword index to patch point; a Patch
+                with size 8 covers an address lo/hi dword pair.
+        """
+        assert self.kind == "pm4"
+        self.raw(
+            struct.pack(f"<{len(dwords)}I", *dwords),
+            {index * 4: patch for index, patch in (patches or {}).items()},
+        )
+
+    def finish(self) -> CommandTemplate:
+        """Returns the recorded template; the recorder can keep recording a longer one."""
+        return CommandTemplate(
+            self.kind,
+            bytes(self._data),
+            {name: list(points) for name, points in self._patches.items()},
+        )
@@ -0,0 +1,187 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import pathlib
+import threading
+from array import array
+from dataclasses import dataclass, field
+from typing import Dict, Optional, Tuple, Union
+
+KFD_TOPOLOGY_NODES = pathlib.Path("/sys/devices/virtual/kfd/kfd/topology/nodes")
+TOPOLOGY_ROOT_ENV = "FUZZYHSA_KFD_TOPOLOGY"
+
+
+def read_properties(path: pathlib.Path) -> Dict[str, int]:
+    """Parses a KFD topology ``properties`` file of ``name value`` lines."""
+    lines = path.read_text().strip().split("\n")
+    return {line.split()[0]: int(line.split()[1]) for line in lines if line.strip()}
+
+
+def _read_entries(node_dir: pathlib.Path, kind: str) -> Tuple[Dict[str, int], ...]:
+    entries = [p for p in (node_dir / kind).glob("*") if p.name.isdigit()]
+    return tuple(
+        read_properties(p / "properties")
+        for p in sorted(entries, key=lambda p: int(p.name))
+    )
+
+
+@dataclass(frozen=True)
+class TopologyNode:
+    """One node of the KFD topology: a CPU socket, a GPU, or both for APUs."""
+
+    node_id: int
+    gpu_id: int
+    name: str
+    properties: Dict[str, int] = field(hash=False)
+    mem_banks: Tuple[Dict[str, int], ...] = field(hash=False)
+    caches: Tuple[Dict[str, int], ...] = field(hash=False)
+    io_links: Tuple[Dict[str, int], ...] = field(hash=False)
+
+    @property
+    def is_gpu(self) -> bool:
+        return self.gpu_id != 0
+
+    @property
+    def is_cpu(self) -> bool:
+        return self.properties.get("cpu_cores_count", 0) > 0
+
+    @property
+    def arch(self) -> str:
+        target = self.properties["gfx_target_version"]
+        return f"gfx{target // 10000}{(target // 100) % 100:02x}{target % 100:02x}"
+
+    @classmethod
+    def parse(cls, node_dir: pathlib.Path) -> "TopologyNode":
+        name = node_dir / "name"
+        return cls(
+            node_id=int(node_dir.name),
+            gpu_id=int((node_dir / "gpu_id").read_text().strip() or 0),
+            name=name.read_text().strip() if name.exists() else "",
+            properties=read_properties(node_dir / "properties"),
+            mem_banks=_read_entries(node_dir, "mem_banks"),
+            caches=_read_entries(node_dir, "caches"),
+            io_links=_read_entries(node_dir, "io_links"),
+        )
+
+
+class Topology:
+    """
+    An immutable snapshot of the KFD topology tree.
+
+    The tree is read and parsed once per root and process; later ``load``
+    calls return the same object. Snapshots are plain data, so a topology
+    loaded before ``fork`` is shared copy-on-write by the children and it can
+    be pickled to spawned workers, neither of which touches sysfs again.
+
+    The root defaults to the ``FUZZYHSA_KFD_TOPOLOGY`` environment variable,
+    then ``/sys/devices/virtual/kfd/kfd/topology/nodes``, so tests and tools
+    can run against a fixture tree.
+
+    Attributes:
+        root (pathlib.Path): The ``topology/nodes`` directory the snapshot was read from.
+        nodes (Tuple[TopologyNode, ...]): All nodes ordered by node id.
+        gpus (Tuple[TopologyNode, ...]): The usable GPU nodes (non-zero gpu_id).
+        gpu_ids (array): gpu_id of every usable GPU, indexed like ``gpus``.
+        node_ids (array): Topology node id of every usable GPU, indexed like ``gpus``.
+    """
+
+    _cache: Dict[pathlib.Path, "Topology"] = {}
+    _lock = threading.Lock()
+
+    def __init__(self, root: pathlib.Path, nodes: Tuple[TopologyNode, ...]):
+        self.root = root
+        self.nodes = nodes
+        self.gpus = tuple(n for n in nodes if n.is_gpu)
+        self.gpu_ids = array("Q", (n.gpu_id for n in self.gpus))
+        self.node_ids = array("I", (n.node_id for n in self.gpus))
+        self._by_id = {n.node_id: n for n in nodes}
+
+    @classmethod
+    def default_root(cls) -> pathlib.Path:
+        return pathlib.Path(os.environ.get(TOPOLOGY_ROOT_ENV, KFD_TOPOLOGY_NODES))
+
+    @classmethod
+    def parse(cls, root: pathlib.Path) -> "Topology":
+        """Reads a topology tree without consulting the cache."""
+        node_dirs = [p for p in root.iterdir() if p.name.isdigit()]
+        nodes = tuple(
+            TopologyNode.parse(p) for p in sorted(node_dirs, key=lambda p: int(p.name))
+        )
+        return cls(root, nodes)
+
+    @classmethod
+    def load(cls, root: Optional[Union[str, pathlib.Path]] = None) -> "Topology":
+        """
+        Returns the cached snapshot for ``root``, parsing the tree on first use.
+
+        Args:
+            root (Optional[Union[str, pathlib.Path]]): The ``topology/nodes`` directory, see default_root.
+
+        Raises:
+            RuntimeError: If the topology cannot be read, e.g. because KFD is not loaded.
+        """
+        root = pathlib.Path(root) if root is not None else cls.default_root()
+        with cls._lock:
+            if root not in cls._cache:
+                try:
+                    cls._cache[root] = cls.parse(root)
+                except OSError as e:
+                    raise RuntimeError(
+                        f"Failed to read the KFD topology with error: {e}"
+                    ) from e
+            return cls._cache[root]
+
+    @classmethod
+    def invalidate(cls) -> None:
+        """Drops all cached snapshots, e.g. after a GPU reset changes the topology."""
+        with cls._lock:
+            cls._cache.clear()
+
+    def __getstate__(self):
+        return {"root": self.root, "nodes": self.nodes}
+
+    def __setstate__(self, state):
+        self.__init__(state["root"], state["nodes"])
+
+    def node(self, node_id: int) -> TopologyNode:
+        return self._by_id[node_id]
+
+    def gpu(self, gpu_id: int) -> TopologyNode:
+        """Returns the GPU node with the given gpu_id."""
+        return self.gpus[list(self.gpu_ids).index(gpu_id)]
+
+    @property
+    def cpu_nodes(self) -> Tuple[TopologyNode, ...]:
+        return tuple(n for n in self.nodes if n.is_cpu)
+
+    def nearest_cpu_node(self, node_id: int) -> Optional[int]:
+        """
+        Finds the NUMA node closest to a topology node.
+
+        The node's io_links are followed to CPU nodes and the link with the
+        lowest weight wins. KFD creates CPU nodes in proximity domain order,
+        so the position of a CPU node among all CPU nodes is its Linux NUMA
+        node number.
+
+        Returns:
+            Optional[int]: The NUMA node, or None if the node has no link to a CPU node.
+        """
+        cpu_ids = [n.node_id for n in self.cpu_nodes]
+        if node_id in cpu_ids:
+            return cpu_ids.index(node_id)
+        links = [
+            (link.get("weight", 0), link["node_to"])
+            for link in self.node(node_id).io_links
+            if link.get("node_to") in cpu_ids
+        ]
+        return cpu_ids.index(min(links)[1]) if links else None
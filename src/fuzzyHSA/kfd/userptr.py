@@ -0,0 +1,218 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import ctypes, mmap
+import threading
+from collections import OrderedDict
+from dataclasses import dataclass, field
+from typing import Any, Optional, Tuple
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+
+def buffer_address(buf: Any) -> Tuple[int, int]:
+    """
+    Resolves the host address and length of a buffer-like object.
+
+    Args:
+        buf: A numpy array (via __array_interface__), or any writable object
+            supporting the buffer protocol such as bytearray or mmap.mmap.
+
+    Returns:
+        Tuple[int, int]: The address of the first byte and the size in bytes.
+    """
+    interface = getattr(buf, "__array_interface__", None)
+    if interface is not None:
+        if interface.get("strides") is not None:
+            raise ValueError("Only contiguous arrays can be registered as userptr")
+        return interface["data"][0], buf.nbytes
+    view = memoryview(buf)
+    if not view.contiguous:
+        raise ValueError("Only contiguous buffers can be registered as userptr")
+    size = view.nbytes
+    view.release()
+    return ctypes.addressof(ctypes.c_char.from_buffer(buf)), size
+
+
+@dataclass(eq=False)
+class UserptrRegistration:
+    """A pinned host range and the KFD allocation backing it."""
+
+    mem: Any
+    start: int
+    end: int
+    owner: Any = None
+    refcount: int = 0
+    hits: int = field(default=0, repr=False)
+
+    def gpu_address(self, host_addr: int) -> int:
+        """Translates a host address inside the registration to its GPU address."""
+        assert self.start <= host_addr < self.end, "Address outside of registration"
+        return self.mem.va_addr + (host_addr - self.start)
+
+
+class UserptrCache:
+    """
+    Caches userptr registrations so hot host buffers are pinned only once.
+
+    Lookups match any cached registration that fully contains the requested
+    range. A range that only partially overlaps cached registrations replaces
+    them by one registration of the union, since KFD rejects userptr ranges
+    whose GPU addresses overlap; overlapping registrations still in use make
+    ``acquire`` raise instead. Registrations are reference counted by
+    ``acquire``/``release``; when the pinned total exceeds ``max_bytes`` the
+    least recently used unreferenced entries are unregistered. The cache may
+    be shared by threads, like its device.
+
+    Example:
+        cache = UserptrCache(device)
+        with cache.register(batch) as reg:
+            submit(reg.gpu_address(addr))
+    """
+
+    def __init__(
+        self,
+        device: Any,
+        max_bytes: int = 1 << 30,
+        kfd_flags: int = kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE,
+    ):
+        self.device = device
+        self.max_bytes = max_bytes
+        self.kfd_flags = kfd_flags
+        self.entries: "OrderedDict[Tuple[int, int], UserptrRegistration]" = (
+            OrderedDict()
+        )
+        self.pinned_bytes = 0
+        self.hits = 0
+        self.misses = 0
+        # _evict and _unregister run both on their own and inside acquire
+        self._lock = threading.RLock()
+
+    def _lookup(self, start: int, end: int) -> Optional[UserptrRegistration]:
+        # callers hold self._lock
+        for key, reg in reversed(self.entries.items()):
+            if reg.start <= start and end <= reg.end:
+                self.entries.move_to_end(key)
+                return reg
+        return None
+
+    def acquire(self, addr: int, size: int, owner: Any = None) -> UserptrRegistration:
+        """
+        Returns a registration covering ``[addr, addr + size)``, pinning it if needed.
+
+        Args:
+            addr (int): Host address of the range.
+            size (int): Size of the range in bytes.
+            owner (Any): Object kept alive while the registration exists.
+
+        Returns:
+            UserptrRegistration: The cached or newly created registration.
+
+        Raises:
+            RuntimeError: If the range partially overlaps a registration in use.
+        """
+        with self._lock:
+            reg = self._lookup(addr, addr + size)
+            if reg is not None:
+                self.hits += 1
+                reg.hits += 1
+                reg.refcount += 1
+                return reg
+
+            self.misses += 1
+            # registrations cover whole pages, so overlaps are found on page bounds
+            start = addr & ~(mmap.PAGESIZE - 1)
+            end = (addr + size + mmap.PAGESIZE - 1) & ~(mmap.PAGESIZE - 1)
+            overlapping = [
+                key
+                for key, reg in self.entries.items()
+                if reg.start < end and start < reg.end
+            ]
+            for key in overlapping:
+                if self.entries[key].refcount:
+                    raise RuntimeError(
+                        f"userptr range {start:#x}-{end:#x} overlaps registration "
+                        f"{key[0]:#x}-{key[1]:#x}, which is in use"
+                    )
+            # the union also pins the merged ranges, so it keeps their owners alive
+            owners = [owner] if overlapping else owner
+            for key in overlapping:
+                start, end = min(start, key[0]), max(end, key[1])
+                owners.append(self.entries[key].owner)
+                self._unregister(key)
+
+            mem = self.device.allocate_userptr(
+                start, end - start, kfd_flags=self.kfd_flags, map_to_gpu=True
+            )
+            reg = UserptrRegistration(mem, mem.va_addr, mem.va_addr + mem.size, owners)
+            reg.refcount += 1
+            self.entries[(reg.start, reg.end)] = reg
+            self.pinned_bytes += mem.size
+            self._evict()
+            return reg
+
+    def register(self, buf: Any) -> "_Lease":
+        """Acquires a registration for a buffer-like object, see buffer_address."""
+        addr, size = buffer_address(buf)
+        return _Lease(self, self.acquire(addr, size, owner=buf))
+
+    def release(self, reg: UserptrRegistration) -> None:
+        """Drops one reference; the registration stays cached until evicted."""
+        with self._lock:
+            assert reg.refcount > 0, "Registration released more often than acquired"
+            reg.refcount -= 1
+            self._evict()
+
+    def invalidate(self, addr: int, size: int) -> None:
+        """
+        Unregisters every cached range overlapping ``[addr, addr + size)``.
+
+        Must be called before host memory backing a registration is freed or
+        remapped, otherwise the GPU keeps accessing the old pages.
+        """
+        with self._lock:
+            for key, reg in list(self.entries.items()):
+                if reg.start < addr + size and addr < reg.end:
+                    assert reg.refcount == 0, "Invalidating a registration that is in use"
+                    self._unregister(key)
+
+    def clear(self) -> None:
+        """Unregisters all cached ranges."""
+        with self._lock:
+            for key in list(self.entries):
+                self._unregister(key)
+
+    def _evict(self) -> None:
+        for key, reg in list(self.entries.items()):
+            if self.pinned_bytes <= self.max_bytes:
+                break
+            if reg.refcount == 0:
+                self._unregister(key)
+
+    def _unregister(self, key: Tuple[int, int]) -> None:
+        reg = self.entries.pop(key)
+        self.pinned_bytes -= reg.mem.size
+        self.device.free_gpu_memory(reg.mem)
+
+
+class _Lease:
+    """Context manager releasing a registration acquired by UserptrCache.register."""
+
+    def __init__(self, cache: UserptrCache, reg: UserptrRegistration):
+        self.cache = cache
+        self.reg = reg
+
+    def __enter__(self) -> UserptrRegistration:
+        return self.reg
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self.cache.release(self.reg)
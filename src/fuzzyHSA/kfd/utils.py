@@ -23,14 +23,6 @@ import fuzzyHSA.kfd.autogen.kfd as kfd
 import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu
 
 
-def is_usable_gpu(gpu_id):
-    try:
-        with gpu_id.open() as f:
-            return int(f.read()) != 0
-    except OSError:
-        return False
-
-
 def kfd_ioctl(
     idir: int,
     nr: int,
@@ -69,10 +61,13 @@ def kfd_ioctl(
     return made
 
 
+@functools.lru_cache(maxsize=None)
 def ioctls_from_header() -> Any:
     """
     Dynamically create ioctl functions from header definitions in kfd.py.
 
+    The result is stateless, so it is built once per process and shared by all devices.
+
     Returns:
         A dynamically created class instance with ioctl functions as methods.
     """
@@ -107,13 +102,22 @@ def handle_union_field(fields, field_name, field_type, names):
 
 
 def merge_64bit_fields(fields, field_name, union_field):
-    if field_name.endswith("_63_32") and fields[-1][0].endsuffix("_31_0"):
-        last_field_name = fields[-1][0][:-6]  # Remove the '_31_0' part
-        fields[-1] = (last_field_name, ctypes.c_ulong, 64)
+    if field_name.endswith("_63_32") and fields[-1][0].endswith("_31_0"):
+        last_field_name = field_name[:-6]  # Remove the '_63_32' part
+        fields[-1] = (last_field_name, ctypes.c_uint64, 64)
     else:
         fields.append((field_name, *union_field[1:]))
 
 
+def init_c_struct_t(fields) -> Type[ctypes.Structure]:
+    """Creates a packed ctypes structure type from a tuple of _fields_ entries."""
+
+    class CStruct(ctypes.Structure):
+        _pack_, _fields_ = 1, fields
+
+    return CStruct
+
+
 def print_ioctl_functions(self) -> None:
     """
     Prints the names of all IOCTL functions generated by the ioctls_from_header function.
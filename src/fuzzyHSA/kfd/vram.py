@@ -0,0 +1,95 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Host visible VRAM and copies suited to its write-combined CPU mapping.
+
+With a large BAR, VRAM allocated with KFD_IOC_ALLOC_MEM_FLAGS_PUBLIC can be
+mapped into the process (KFDDevice.map_to_host) and written directly, which
+saves the staging copy through GTT. The mapping is write-combining: stores
+are gathered into 64-byte line buffers and sent over PCIe in bursts, while
+loads bypass the caches and stall for a full round trip each. So:
+
+- write in large sequential runs; ``upload`` issues one streaming copy per
+  call, and partial lines are only written at the ends of a run,
+- never read back what was just written, and never read-modify-write,
+- read with one bulk ``download`` into host memory instead of touching the
+  mapping element by element through ctypes.
+
+The copies use the streaming stores and loads of streaming.py.
+
+Host writes reach VRAM through the GPU's host data path (HDP), which must be
+flushed before the GPU reads the data, see KFDDevice.hdp_flush.
+"""
+
+import ctypes
+import mmap
+from typing import Any, Dict, Union
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from . import libc
+from .streaming import copier
+
+Buffer = Union[bytes, bytearray, memoryview, ctypes.Array]
+
+
+def vram_config(executable: bool = False) -> Dict[str, int]:
+    """
+    Memory flags for host visible VRAM, mapped for CPU access by allocate_memory.
+
+    The anonymous mapping only reserves the address range; it is replaced by
+    the mapping of the buffer object.
+    """
+    flags = (
+        kfd.KFD_IOC_ALLOC_MEM_FLAGS_VRAM
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_PUBLIC
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_NO_SUBSTITUTE
+    )
+    if executable:
+        flags |= kfd.KFD_IOC_ALLOC_MEM_FLAGS_EXECUTABLE
+    return {
+        "mmap_prot": 0,
+        "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS | libc.MAP_NORESERVE,
+        "kfd_flags": flags,
+    }
+
+
+def _check(mem: Any, offset: int, size: int) -> int:
+    assert getattr(
+        mem, "host_mapped", False
+    ), "the allocation is not mapped to the host"
+    assert 0 <= offset and offset + size <= mem.size, "access outside the allocation"
+    return mem.va_addr + offset
+
+
+def upload(mem: Any, data: Buffer, offset: int = 0) -> None:
+    """Copies host data into a host mapped allocation with one sequential write."""
+    size = memoryview(data).nbytes
+    copier().copy(_check(mem, offset, size), data, size)
+
+
+def upload_from(mem: Any, src_addr: int, size: int, offset: int = 0) -> None:
+    """Copies ``size`` bytes from a host address, e.g. a GTT buffer, into the allocation."""
+    copier().copy(_check(mem, offset, size), src_addr, size)
+
+
+def fill(mem: Any, value: int, size: int, offset: int = 0) -> None:
+    """Sets ``size`` bytes to the byte ``value`` without reading the mapping."""
+    copier().fill(_check(mem, offset, size), value, size)
+
+
+def download(mem: Any, size: int, offset: int = 0) -> bytearray:
+    """Reads ``size`` bytes of the allocation with a single bulk copy."""
+    out = bytearray(size)
+    copier().read(out, _check(mem, offset, size), size)
+    return out
@@ -0,0 +1,245 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Controlled-interleaving race fuzzing of concurrent ioctls on shared handles.
+
+A race testcase is a set of thread scripts, each a list of named steps that
+issue ioctls against shared resources. A seeded schedule splits the steps
+into rounds. Each round names the threads whose next step runs in it, so the
+order of all steps is fixed by the seed. Threads of one round are released
+together through a barrier and really overlap in the kernel, while rounds run
+strictly one after another. Replaying a seed replays the interleaving.
+"""
+
+import mmap
+import random
+import threading
+from dataclasses import dataclass, field
+from typing import Any, Callable, List, Optional, Sequence, Tuple
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from fuzzyHSA.kfd.ops import KFDDevice
+
+Step = Tuple[str, Callable[[], Any]]
+Round = Tuple[int, ...]
+
+
+@dataclass
+class StepResult:
+    round: int
+    thread: int
+    name: str
+    value: Any = None
+    error: Optional[BaseException] = None
+
+
+@dataclass
+class RaceResult:
+    """The outcome of one race testcase; ``trace`` is ordered by round, then thread."""
+
+    seed: Optional[int]
+    rounds: List[Round]
+    trace: List[StepResult] = field(default_factory=list)
+    hung: bool = False
+
+    def outcomes(self) -> List[Tuple[int, str, Optional[str]]]:
+        """(thread, step, error type) of every step, for comparing replays."""
+        return [
+            (r.thread, r.name, type(r.error).__name__ if r.error else None)
+            for r in self.trace
+        ]
+
+
+def random_rounds(
+    step_counts: Sequence[int], rng: random.Random, max_parallel: int = 2
+) -> List[Round]:
+    """
+    Draws a schedule for threads with the given number of steps.
+
+    Every round runs the next step of 1 to ``max_parallel`` distinct threads
+    that still have steps left.
+    """
+    remaining = list(step_counts)
+    rounds: List[Round] = []
+    while any(remaining):
+        ready = [t for t, n in enumerate(remaining) if n]
+        group = sorted(rng.sample(ready, rng.randint(1, min(max_parallel, len(ready)))))
+        for t in group:
+            remaining[t] -= 1
+        rounds.append(tuple(group))
+    return rounds
+
+
+class InterleavingRunner:
+    """
+    Runs thread scripts following a fixed schedule of rounds.
+
+    Args:
+        scripts (List[List[Step]]): One list of steps per thread.
+        rounds (List[Round]): The schedule, see random_rounds.
+        timeout (float): Seconds a round may take before the testcase counts as hung.
+    """
+
+    def __init__(
+        self, scripts: List[List[Step]], rounds: List[Round], timeout: float = 10.0
+    ):
+        counts = [sum(t in r for r in rounds) for t in range(len(scripts))]
+        assert counts == [len(s) for s in scripts], "schedule does not match scripts"
+        self.scripts = scripts
+        self.rounds = rounds
+        self.timeout = timeout
+        self._cond = threading.Condition()
+        self._current = 0
+        self._done: List[int] = []
+        self._barriers = [threading.Barrier(len(r)) for r in rounds]
+        self._results: List[StepResult] = []
+
+    def _thread(self, tid: int) -> None:
+        for index, (name, fn) in zip(
+            (i for i, r in enumerate(self.rounds) if tid in r), self.scripts[tid]
+        ):
+            with self._cond:
+                self._cond.wait_for(lambda: self._current == index)
+            self._barriers[index].wait()
+            result = StepResult(index, tid, name)
+            try:
+                result.value = fn()
+            except Exception as e:
+                result.error = e
+            with self._cond:
+                self._results.append(result)
+                self._done.append(tid)
+                if len(self._done) == len(self.rounds[index]):
+                    self._done = []
+                    self._current += 1
+                    self._cond.notify_all()
+
+    def run(self, seed: Optional[int] = None) -> RaceResult:
+        """
+        Runs the scripts once.
+
+        Threads stuck in an ioctl cannot be cancelled, so they are daemon
+        threads and a hung result leaves them behind; the device they used
+        should not be reused.
+        """
+        threads = [
+            threading.Thread(target=self._thread, args=(t,), daemon=True)
+            for t in range(len(self.scripts))
+        ]
+        for t in threads:
+            t.start()
+        with self._cond:
+            for index in range(len(self.rounds)):
+                if not self._cond.wait_for(
+                    lambda: self._current > index, timeout=self.timeout
+                ):
+                    break
+        hung = self._current < len(self.rounds)
+        if not hung:
+            for t in threads:
+                t.join()
+        trace = sorted(self._results, key=lambda r: (r.round, r.thread))
+        return RaceResult(seed, list(self.rounds), trace, hung)
+
+
+RaceScenario = Callable[[KFDDevice], Tuple[List[List[Step]], Callable[[], None]]]
+
+
+def free_vs_map(device: KFDDevice) -> Tuple[List[List[Step]], Callable[[], None]]:
+    """One thread frees a GTT allocation while another maps it to the GPU."""
+    config = {
+        "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+        "mmap_flags": mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
+        "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE,
+    }
+    mem = device.allocate_memory(mmap.PAGESIZE, config)
+    scripts = [
+        [("free_memory_of_gpu", lambda: device.free_gpu_memory(mem))],
+        [("map_memory_to_gpu", lambda: device.map_memory_to_gpu(mem))],
+    ]
+
+    def cleanup():
+        if mem.handle in device.context.allocations:
+            device.free_gpu_memory(mem)
+
+    return scripts, cleanup
+
+
+def destroy_vs_update_queue(
+    device: KFDDevice, queue_type: int = kfd.KFD_IOC_QUEUE_TYPE_SDMA
+) -> Tuple[List[List[Step]], Callable[[], None]]:
+    """One thread destroys a fresh queue while another updates it twice."""
+    queue = device.create_queue(queue_type, ring_size=0x1000)
+    destroyed = []
+
+    def destroy():
+        device.KFD_IOCTL.destroy_queue(device.kfd, queue_id=queue.queue_id)
+        destroyed.append(queue.queue_id)
+
+    def update(percentage):
+        return device.KFD_IOCTL.update_queue(
+            device.kfd,
+            queue_id=queue.queue_id,
+            ring_base_address=queue.ring.va_addr,
+            ring_size=queue.ring.size,
+            queue_percentage=percentage,
+            queue_priority=kfd.KFD_MAX_QUEUE_PRIORITY,
+        )
+
+    scripts = [
+        [("destroy_queue", destroy)],
+        [("update_queue", lambda: update(50)), ("update_queue", lambda: update(100))],
+    ]
+
+    def cleanup():
+        if destroyed:
+            device._forget("queues", id(queue))
+            for mem in [queue.ring, queue.gart, *queue.buffers.values()]:
+                device.free_gpu_memory(mem)
+        else:
+            queue.destroy()
+
+    return scripts, cleanup
+
+
+def fuzz_races(
+    device: KFDDevice,
+    scenario: RaceScenario,
+    seeds: Sequence[int],
+    max_parallel: int = 2,
+    timeout: float = 10.0,
+) -> List[RaceResult]:
+    """
+    Runs a race scenario once per seed.
+
+    The scenario builds fresh shared resources and thread scripts on every
+    run and returns a cleanup for whatever the race left behind. Fuzzing
+    stops at the first hang, whose result is the last one returned.
+
+    Example:
+        results = fuzz_races(device, free_vs_map, range(1000))
+        replay = fuzz_races(device, free_vs_map, [results[-1].seed])
+    """
+    results = []
+    for seed in seeds:
+        scripts, cleanup = scenario(device)
+        rounds = random_rounds(
+            [len(s) for s in scripts], random.Random(seed), max_parallel
+        )
+        result = InterleavingRunner(scripts, rounds, timeout).run(seed)
+        results.append(result)
+        if result.hung:
+            break
+        cleanup()
+    return results
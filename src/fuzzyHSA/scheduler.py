@@ -0,0 +1,217 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import concurrent.futures
+import functools
+import mmap
+import multiprocessing
+import random
+import sys
+from typing import Any, Callable, Dict, List, Optional, Sequence
+
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+from fuzzyHSA.kfd.ops import KFDDevice
+from fuzzyHSA.kfd.topology import Topology
+
+Program = Callable[[KFDDevice, Any], Any]
+DeviceFactory = Callable[[int], KFDDevice]
+
+# the device opened by the current worker process and its peers, see _init_worker
+_worker_device: Optional[KFDDevice] = None
+_worker_peers: List[KFDDevice] = []
+
+
+def open_device(index: int) -> KFDDevice:
+    """Default device factory: opens the index-th usable GPU."""
+    return KFDDevice(f"KFD:{index}")
+
+
+def gil_enabled() -> bool:
+    """True unless running on a free-threaded CPython build with the GIL disabled."""
+    return getattr(sys, "_is_gil_enabled", lambda: True)()
+
+
+def shard(corpus: Sequence[Any], gpu_ids: Sequence[int]) -> Dict[int, List[Any]]:
+    """Splits a corpus round-robin over GPUs, keyed by gpu_id."""
+    n = len(gpu_ids)
+    return {gpu_id: list(corpus[i::n]) for i, gpu_id in enumerate(gpu_ids)}
+
+
+def _init_worker(factory: DeviceFactory, index: int, pin: bool, gpus: int) -> None:
+    global _worker_device, _worker_peers
+    _worker_device = factory(index)
+    # opening the peers acquires their GPU VMs, so memory can be mapped to them
+    _worker_peers = [factory(i) for i in range(gpus) if gpus > 1 and i != index]
+    if pin:
+        _worker_device.pin_worker()
+
+
+def _run_testcase(program: Program, testcase: Any) -> Any:
+    return program(_worker_device, testcase)
+
+
+class MultiGPUScheduler:
+    """
+    Fans a corpus out over every usable GPU, one worker pool per GPU.
+
+    GPU ``i`` of ``topology.gpus`` receives the corpus shard ``corpus[i::n]``
+    and runs it on ``workers_per_gpu`` forked processes. Each worker opens its
+    own device through ``device_factory`` and, with ``pin``, moves itself to
+    the GPU's NUMA node. With ``peers`` it opens every other GPU as well, which
+    programs mapping memory to peer GPUs such as multi_device_map_program
+    need; the factory must then open all devices of a worker in one context.
+    All pools run concurrently.
+
+    Example:
+        scheduler = MultiGPUScheduler(program, workers_per_gpu=4)
+        results = scheduler.run(corpus)  # {gpu_id: [result, ...]}
+    """
+
+    def __init__(
+        self,
+        program: Program,
+        topology: Optional[Topology] = None,
+        workers_per_gpu: int = 1,
+        device_factory: DeviceFactory = open_device,
+        pin: bool = True,
+        peers: bool = False,
+    ):
+        self.program = program
+        self.topology = topology or Topology.load()
+        self.workers_per_gpu = workers_per_gpu
+        self.device_factory = device_factory
+        self.pin = pin
+        self.peers = peers
+
+    def shard(self, corpus: Sequence[Any]) -> Dict[int, List[Any]]:
+        """Splits the corpus round-robin over the GPUs, keyed by gpu_id."""
+        return shard(corpus, self.topology.gpu_ids)
+
+    def run(self, corpus: Sequence[Any]) -> Dict[int, List[Any]]:
+        """
+        Runs the program over the corpus on all GPUs.
+
+        Returns:
+            Dict[int, List[Any]]: gpu_id to the program results for its shard, in shard order.
+        """
+        if not self.topology.gpus:
+            raise RuntimeError("No usable GPUs in the KFD topology")
+        ctx = multiprocessing.get_context("fork")
+        task = functools.partial(_run_testcase, self.program)
+        gpus = len(self.topology.gpus) if self.peers else 0
+        pools, pending = [], {}
+        try:
+            for index, (gpu_id, shard) in enumerate(self.shard(corpus).items()):
+                pool = ctx.Pool(
+                    self.workers_per_gpu,
+                    initializer=_init_worker,
+                    initargs=(self.device_factory, index, self.pin, gpus),
+                )
+                pools.append(pool)
+                pending[gpu_id] = pool.map_async(task, shard)
+            return {gpu_id: result.get() for gpu_id, result in pending.items()}
+        finally:
+            for pool in pools:
+                pool.terminate()
+                pool.join()
+
+
+class ThreadedScheduler:
+    """
+    Runs a corpus on a thread pool inside the current process.
+
+    Threads are much cheaper than forked workers, which matters for stress
+    tests that drive many queues or ioctl streams at once. The corpus is
+    sharded over ``devices`` like MultiGPUScheduler does and every device is
+    driven by ``threads_per_device`` threads sharing the device object. On a
+    free-threaded CPython build (see gil_enabled) the ioctls really run in
+    parallel; with the GIL they still overlap inside the kernel.
+
+    Example:
+        scheduler = ThreadedScheduler(program, [KFDDevice("KFD:0")], threads_per_device=16)
+        results = scheduler.run(corpus)  # {gpu_id: [result, ...]}
+    """
+
+    def __init__(
+        self,
+        program: Program,
+        devices: Sequence[KFDDevice],
+        threads_per_device: int = 4,
+    ):
+        self.program = program
+        self.devices = list(devices)
+        self.threads_per_device = threads_per_device
+
+    def run(self, corpus: Sequence[Any]) -> Dict[int, List[Any]]:
+        """
+        Runs the program over the corpus on all devices.
+
+        Returns:
+            Dict[int, List[Any]]: gpu_id to the program results for its shard, in shard order.
+            The first exception raised by the program is re-raised.
+        """
+        if not self.devices:
+            raise RuntimeError("ThreadedScheduler needs at least one device")
+        by_gpu = {device.gpu_id: device for device in self.devices}
+        workers = len(self.devices) * self.threads_per_device
+        with concurrent.futures.ThreadPoolExecutor(workers) as pool:
+            pending = {
+                gpu_id: [pool.submit(self.program, by_gpu[gpu_id], tc) for tc in tcs]
+                for gpu_id, tcs in shard(corpus, list(by_gpu)).items()
+            }
+            return {
+                gpu_id: [future.result() for future in futures]
+                for gpu_id, futures in pending.items()
+            }
+
+
+def multi_device_corpus(
+    topology: Topology, count: int, seed: int = 0, max_pages: int = 16
+) -> List[Dict[str, Any]]:
+    """
+    Generates testcases for multi_device_map_program.
+
+    Every testcase maps one allocation to a random non-empty subset of the GPUs.
+    """
+    rng = random.Random(seed)
+    gpu_ids = list(topology.gpu_ids)
+    return [
+        {
+            "size": rng.randint(1, max_pages) * mmap.PAGESIZE,
+            "gpu_ids": rng.sample(gpu_ids, rng.randint(1, len(gpu_ids))),
+        }
+        for _ in range(count)
+    ]
+
+
+def multi_device_map_program(device: KFDDevice, testcase: Dict[str, Any]) -> int:
+    """
+    Allocates GTT memory on ``device`` and maps it to several GPUs with one map_memory_to_gpu.
+
+    Every GPU of the testcase must be open in the device's context, see
+    MultiGPUScheduler's ``peers``.
+
+    Returns:
+        int: The number of GPUs the allocation was mapped to.
+    """
+    config = {
+        "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+        "mmap_flags": mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
+        "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT
+        | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE,
+    }
+    mem = device.allocate_memory(testcase["size"], config)
+    try:
+        device.map_memory_to_gpu(mem, gpu_ids=testcase["gpu_ids"])
+        return len(mem.mapped_gpu_ids)
+    finally:
+        device.free_gpu_memory(mem)
@@ -38,9 +38,10 @@ def check_generated_files(filenames: List[str]) -> None:
             )
 
 
-def create_cache_directory():
+def create_cache_directory() -> Path:
     cache_dir = Path.home() / ".cache" / "fuzzyHSA"
     cache_dir.mkdir(parents=True, exist_ok=True)
+    return cache_dir
 
 
 def query_attributes(obj: Any) -> Dict[str, Any]:
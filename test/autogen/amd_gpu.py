@@ -0,0 +1,1248 @@
+# mypy: ignore-errors
+# test stand-in for the clang2py output of sdma_registers.h and nvd.h, see conftest.py
+import ctypes
+
+
+class struct_SDMA_PKT_COPY_LINEAR_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_COPY_LINEAR_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_COPY_LINEAR_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_COPY_LINEAR_TAG_0_0._fields_ = [
+    ("op", ctypes.c_uint32, 8),
+    ("sub_op", ctypes.c_uint32, 8),
+    ("extra_info", ctypes.c_uint32, 16),
+]
+
+
+class union_SDMA_PKT_COPY_LINEAR_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_COPY_LINEAR_TAG_0._pack_ = 1
+union_SDMA_PKT_COPY_LINEAR_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_COPY_LINEAR_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_COPY_LINEAR_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_COPY_LINEAR_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_COPY_LINEAR_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_COPY_LINEAR_TAG_1_0._fields_ = [
+    ("count", ctypes.c_uint32, 22),
+    ("reserved_0", ctypes.c_uint32, 10),
+]
+
+
+class union_SDMA_PKT_COPY_LINEAR_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_COPY_LINEAR_TAG_1._pack_ = 1
+union_SDMA_PKT_COPY_LINEAR_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_COPY_LINEAR_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_COPY_LINEAR_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_COPY_LINEAR_TAG_2_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_COPY_LINEAR_TAG_2_0._pack_ = 1
+struct_SDMA_PKT_COPY_LINEAR_TAG_2_0._fields_ = [
+    ("reserved_0", ctypes.c_uint32, 16),
+    ("dst_swap", ctypes.c_uint32, 2),
+    ("reserved_1", ctypes.c_uint32, 6),
+    ("src_swap", ctypes.c_uint32, 2),
+    ("reserved_2", ctypes.c_uint32, 6),
+]
+
+
+class union_SDMA_PKT_COPY_LINEAR_TAG_2(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_COPY_LINEAR_TAG_2._pack_ = 1
+union_SDMA_PKT_COPY_LINEAR_TAG_2._anonymous_ = ("_0",)
+union_SDMA_PKT_COPY_LINEAR_TAG_2._fields_ = [
+    ("_0", struct_SDMA_PKT_COPY_LINEAR_TAG_2_0),
+    ("DW_2_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_COPY_LINEAR_TAG_3_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_COPY_LINEAR_TAG_3_0._pack_ = 1
+struct_SDMA_PKT_COPY_LINEAR_TAG_3_0._fields_ = [
+    ("src_addr_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_COPY_LINEAR_TAG_3(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_COPY_LINEAR_TAG_3._pack_ = 1
+union_SDMA_PKT_COPY_LINEAR_TAG_3._anonymous_ = ("_0",)
+union_SDMA_PKT_COPY_LINEAR_TAG_3._fields_ = [
+    ("_0", struct_SDMA_PKT_COPY_LINEAR_TAG_3_0),
+    ("DW_3_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_COPY_LINEAR_TAG_4_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_COPY_LINEAR_TAG_4_0._pack_ = 1
+struct_SDMA_PKT_COPY_LINEAR_TAG_4_0._fields_ = [
+    ("src_addr_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_COPY_LINEAR_TAG_4(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_COPY_LINEAR_TAG_4._pack_ = 1
+union_SDMA_PKT_COPY_LINEAR_TAG_4._anonymous_ = ("_0",)
+union_SDMA_PKT_COPY_LINEAR_TAG_4._fields_ = [
+    ("_0", struct_SDMA_PKT_COPY_LINEAR_TAG_4_0),
+    ("DW_4_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_COPY_LINEAR_TAG_5_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_COPY_LINEAR_TAG_5_0._pack_ = 1
+struct_SDMA_PKT_COPY_LINEAR_TAG_5_0._fields_ = [
+    ("dst_addr_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_COPY_LINEAR_TAG_5(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_COPY_LINEAR_TAG_5._pack_ = 1
+union_SDMA_PKT_COPY_LINEAR_TAG_5._anonymous_ = ("_0",)
+union_SDMA_PKT_COPY_LINEAR_TAG_5._fields_ = [
+    ("_0", struct_SDMA_PKT_COPY_LINEAR_TAG_5_0),
+    ("DW_5_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_COPY_LINEAR_TAG_6_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_COPY_LINEAR_TAG_6_0._pack_ = 1
+struct_SDMA_PKT_COPY_LINEAR_TAG_6_0._fields_ = [
+    ("dst_addr_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_COPY_LINEAR_TAG_6(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_COPY_LINEAR_TAG_6._pack_ = 1
+union_SDMA_PKT_COPY_LINEAR_TAG_6._anonymous_ = ("_0",)
+union_SDMA_PKT_COPY_LINEAR_TAG_6._fields_ = [
+    ("_0", struct_SDMA_PKT_COPY_LINEAR_TAG_6_0),
+    ("DW_6_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_COPY_LINEAR_TAG._pack_ = 1
+struct_SDMA_PKT_COPY_LINEAR_TAG._fields_ = [
+    ("HEADER_UNION", union_SDMA_PKT_COPY_LINEAR_TAG_0),
+    ("COUNT_UNION", union_SDMA_PKT_COPY_LINEAR_TAG_1),
+    ("PARAMETER_UNION", union_SDMA_PKT_COPY_LINEAR_TAG_2),
+    ("SRC_ADDR_LO_UNION", union_SDMA_PKT_COPY_LINEAR_TAG_3),
+    ("SRC_ADDR_HI_UNION", union_SDMA_PKT_COPY_LINEAR_TAG_4),
+    ("DST_ADDR_LO_UNION", union_SDMA_PKT_COPY_LINEAR_TAG_5),
+    ("DST_ADDR_HI_UNION", union_SDMA_PKT_COPY_LINEAR_TAG_6),
+]
+
+
+class struct_SDMA_PKT_CONSTANT_FILL_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_CONSTANT_FILL_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_CONSTANT_FILL_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_CONSTANT_FILL_TAG_0_0._fields_ = [
+    ("op", ctypes.c_uint32, 8),
+    ("sub_op", ctypes.c_uint32, 8),
+    ("sw", ctypes.c_uint32, 2),
+    ("reserved_0", ctypes.c_uint32, 12),
+    ("fillsize", ctypes.c_uint32, 2),
+]
+
+
+class union_SDMA_PKT_CONSTANT_FILL_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_CONSTANT_FILL_TAG_0._pack_ = 1
+union_SDMA_PKT_CONSTANT_FILL_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_CONSTANT_FILL_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_CONSTANT_FILL_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_CONSTANT_FILL_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_CONSTANT_FILL_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_CONSTANT_FILL_TAG_1_0._fields_ = [
+    ("dst_addr_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_CONSTANT_FILL_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_CONSTANT_FILL_TAG_1._pack_ = 1
+union_SDMA_PKT_CONSTANT_FILL_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_CONSTANT_FILL_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_CONSTANT_FILL_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_CONSTANT_FILL_TAG_2_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_CONSTANT_FILL_TAG_2_0._pack_ = 1
+struct_SDMA_PKT_CONSTANT_FILL_TAG_2_0._fields_ = [
+    ("dst_addr_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_CONSTANT_FILL_TAG_2(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_CONSTANT_FILL_TAG_2._pack_ = 1
+union_SDMA_PKT_CONSTANT_FILL_TAG_2._anonymous_ = ("_0",)
+union_SDMA_PKT_CONSTANT_FILL_TAG_2._fields_ = [
+    ("_0", struct_SDMA_PKT_CONSTANT_FILL_TAG_2_0),
+    ("DW_2_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_CONSTANT_FILL_TAG_3_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_CONSTANT_FILL_TAG_3_0._pack_ = 1
+struct_SDMA_PKT_CONSTANT_FILL_TAG_3_0._fields_ = [
+    ("src_data_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_CONSTANT_FILL_TAG_3(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_CONSTANT_FILL_TAG_3._pack_ = 1
+union_SDMA_PKT_CONSTANT_FILL_TAG_3._anonymous_ = ("_0",)
+union_SDMA_PKT_CONSTANT_FILL_TAG_3._fields_ = [
+    ("_0", struct_SDMA_PKT_CONSTANT_FILL_TAG_3_0),
+    ("DW_3_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_CONSTANT_FILL_TAG_4_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_CONSTANT_FILL_TAG_4_0._pack_ = 1
+struct_SDMA_PKT_CONSTANT_FILL_TAG_4_0._fields_ = [
+    ("count", ctypes.c_uint32, 22),
+    ("reserved_0", ctypes.c_uint32, 10),
+]
+
+
+class union_SDMA_PKT_CONSTANT_FILL_TAG_4(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_CONSTANT_FILL_TAG_4._pack_ = 1
+union_SDMA_PKT_CONSTANT_FILL_TAG_4._anonymous_ = ("_0",)
+union_SDMA_PKT_CONSTANT_FILL_TAG_4._fields_ = [
+    ("_0", struct_SDMA_PKT_CONSTANT_FILL_TAG_4_0),
+    ("DW_4_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_CONSTANT_FILL_TAG._pack_ = 1
+struct_SDMA_PKT_CONSTANT_FILL_TAG._fields_ = [
+    ("HEADER_UNION", union_SDMA_PKT_CONSTANT_FILL_TAG_0),
+    ("DST_ADDR_LO_UNION", union_SDMA_PKT_CONSTANT_FILL_TAG_1),
+    ("DST_ADDR_HI_UNION", union_SDMA_PKT_CONSTANT_FILL_TAG_2),
+    ("DATA_UNION", union_SDMA_PKT_CONSTANT_FILL_TAG_3),
+    ("COUNT_UNION", union_SDMA_PKT_CONSTANT_FILL_TAG_4),
+]
+
+
+class struct_SDMA_PKT_FENCE_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_FENCE_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_FENCE_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_FENCE_TAG_0_0._fields_ = [
+    ("op", ctypes.c_uint32, 8),
+    ("sub_op", ctypes.c_uint32, 8),
+    ("mtype", ctypes.c_uint32, 3),
+    ("gcc", ctypes.c_uint32, 1),
+    ("sys", ctypes.c_uint32, 1),
+    ("pad1", ctypes.c_uint32, 1),
+    ("snp", ctypes.c_uint32, 1),
+    ("gpa", ctypes.c_uint32, 1),
+    ("l2_policy", ctypes.c_uint32, 2),
+    ("reserved_0", ctypes.c_uint32, 6),
+]
+
+
+class union_SDMA_PKT_FENCE_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_FENCE_TAG_0._pack_ = 1
+union_SDMA_PKT_FENCE_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_FENCE_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_FENCE_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_FENCE_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_FENCE_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_FENCE_TAG_1_0._fields_ = [
+    ("addr_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_FENCE_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_FENCE_TAG_1._pack_ = 1
+union_SDMA_PKT_FENCE_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_FENCE_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_FENCE_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_FENCE_TAG_2_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_FENCE_TAG_2_0._pack_ = 1
+struct_SDMA_PKT_FENCE_TAG_2_0._fields_ = [
+    ("addr_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_FENCE_TAG_2(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_FENCE_TAG_2._pack_ = 1
+union_SDMA_PKT_FENCE_TAG_2._anonymous_ = ("_0",)
+union_SDMA_PKT_FENCE_TAG_2._fields_ = [
+    ("_0", struct_SDMA_PKT_FENCE_TAG_2_0),
+    ("DW_2_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_FENCE_TAG_3_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_FENCE_TAG_3_0._pack_ = 1
+struct_SDMA_PKT_FENCE_TAG_3_0._fields_ = [
+    ("data", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_FENCE_TAG_3(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_FENCE_TAG_3._pack_ = 1
+union_SDMA_PKT_FENCE_TAG_3._anonymous_ = ("_0",)
+union_SDMA_PKT_FENCE_TAG_3._fields_ = [
+    ("_0", struct_SDMA_PKT_FENCE_TAG_3_0),
+    ("DW_3_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_FENCE_TAG._pack_ = 1
+struct_SDMA_PKT_FENCE_TAG._fields_ = [
+    ("HEADER_UNION", union_SDMA_PKT_FENCE_TAG_0),
+    ("ADDR_LO_UNION", union_SDMA_PKT_FENCE_TAG_1),
+    ("ADDR_HI_UNION", union_SDMA_PKT_FENCE_TAG_2),
+    ("DATA_UNION", union_SDMA_PKT_FENCE_TAG_3),
+]
+
+
+class struct_SDMA_PKT_TRAP_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_TRAP_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_TRAP_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_TRAP_TAG_0_0._fields_ = [
+    ("op", ctypes.c_uint32, 8),
+    ("sub_op", ctypes.c_uint32, 8),
+    ("reserved_0", ctypes.c_uint32, 16),
+]
+
+
+class union_SDMA_PKT_TRAP_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_TRAP_TAG_0._pack_ = 1
+union_SDMA_PKT_TRAP_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_TRAP_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_TRAP_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_TRAP_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_TRAP_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_TRAP_TAG_1_0._fields_ = [
+    ("int_context", ctypes.c_uint32, 28),
+    ("reserved_1", ctypes.c_uint32, 4),
+]
+
+
+class union_SDMA_PKT_TRAP_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_TRAP_TAG_1._pack_ = 1
+union_SDMA_PKT_TRAP_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_TRAP_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_TRAP_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_TRAP_TAG._pack_ = 1
+struct_SDMA_PKT_TRAP_TAG._fields_ = [
+    ("HEADER_UNION", union_SDMA_PKT_TRAP_TAG_0),
+    ("INT_CONTEXT_UNION", union_SDMA_PKT_TRAP_TAG_1),
+]
+
+
+class struct_SDMA_PKT_POLL_REGMEM_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_POLL_REGMEM_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_POLL_REGMEM_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_POLL_REGMEM_TAG_0_0._fields_ = [
+    ("op", ctypes.c_uint32, 8),
+    ("sub_op", ctypes.c_uint32, 8),
+    ("reserved_0", ctypes.c_uint32, 10),
+    ("hdp_flush", ctypes.c_uint32, 1),
+    ("reserved_1", ctypes.c_uint32, 1),
+    ("func", ctypes.c_uint32, 3),
+    ("mem_poll", ctypes.c_uint32, 1),
+]
+
+
+class union_SDMA_PKT_POLL_REGMEM_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_POLL_REGMEM_TAG_0._pack_ = 1
+union_SDMA_PKT_POLL_REGMEM_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_POLL_REGMEM_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_POLL_REGMEM_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_POLL_REGMEM_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_POLL_REGMEM_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_POLL_REGMEM_TAG_1_0._fields_ = [
+    ("addr_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_POLL_REGMEM_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_POLL_REGMEM_TAG_1._pack_ = 1
+union_SDMA_PKT_POLL_REGMEM_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_POLL_REGMEM_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_POLL_REGMEM_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_POLL_REGMEM_TAG_2_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_POLL_REGMEM_TAG_2_0._pack_ = 1
+struct_SDMA_PKT_POLL_REGMEM_TAG_2_0._fields_ = [
+    ("addr_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_POLL_REGMEM_TAG_2(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_POLL_REGMEM_TAG_2._pack_ = 1
+union_SDMA_PKT_POLL_REGMEM_TAG_2._anonymous_ = ("_0",)
+union_SDMA_PKT_POLL_REGMEM_TAG_2._fields_ = [
+    ("_0", struct_SDMA_PKT_POLL_REGMEM_TAG_2_0),
+    ("DW_2_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_POLL_REGMEM_TAG_3_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_POLL_REGMEM_TAG_3_0._pack_ = 1
+struct_SDMA_PKT_POLL_REGMEM_TAG_3_0._fields_ = [
+    ("value", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_POLL_REGMEM_TAG_3(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_POLL_REGMEM_TAG_3._pack_ = 1
+union_SDMA_PKT_POLL_REGMEM_TAG_3._anonymous_ = ("_0",)
+union_SDMA_PKT_POLL_REGMEM_TAG_3._fields_ = [
+    ("_0", struct_SDMA_PKT_POLL_REGMEM_TAG_3_0),
+    ("DW_3_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_POLL_REGMEM_TAG_4_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_POLL_REGMEM_TAG_4_0._pack_ = 1
+struct_SDMA_PKT_POLL_REGMEM_TAG_4_0._fields_ = [
+    ("mask", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_POLL_REGMEM_TAG_4(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_POLL_REGMEM_TAG_4._pack_ = 1
+union_SDMA_PKT_POLL_REGMEM_TAG_4._anonymous_ = ("_0",)
+union_SDMA_PKT_POLL_REGMEM_TAG_4._fields_ = [
+    ("_0", struct_SDMA_PKT_POLL_REGMEM_TAG_4_0),
+    ("DW_4_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_POLL_REGMEM_TAG_5_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_POLL_REGMEM_TAG_5_0._pack_ = 1
+struct_SDMA_PKT_POLL_REGMEM_TAG_5_0._fields_ = [
+    ("interval", ctypes.c_uint32, 16),
+    ("retry_count", ctypes.c_uint32, 12),
+    ("reserved_0", ctypes.c_uint32, 4),
+]
+
+
+class union_SDMA_PKT_POLL_REGMEM_TAG_5(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_POLL_REGMEM_TAG_5._pack_ = 1
+union_SDMA_PKT_POLL_REGMEM_TAG_5._anonymous_ = ("_0",)
+union_SDMA_PKT_POLL_REGMEM_TAG_5._fields_ = [
+    ("_0", struct_SDMA_PKT_POLL_REGMEM_TAG_5_0),
+    ("DW_5_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_POLL_REGMEM_TAG._pack_ = 1
+struct_SDMA_PKT_POLL_REGMEM_TAG._fields_ = [
+    ("HEADER_UNION", union_SDMA_PKT_POLL_REGMEM_TAG_0),
+    ("ADDR_LO_UNION", union_SDMA_PKT_POLL_REGMEM_TAG_1),
+    ("ADDR_HI_UNION", union_SDMA_PKT_POLL_REGMEM_TAG_2),
+    ("VALUE_UNION", union_SDMA_PKT_POLL_REGMEM_TAG_3),
+    ("MASK_UNION", union_SDMA_PKT_POLL_REGMEM_TAG_4),
+    ("DW5_UNION", union_SDMA_PKT_POLL_REGMEM_TAG_5),
+]
+
+
+class struct_SDMA_PKT_TIMESTAMP_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_TIMESTAMP_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_TIMESTAMP_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_TIMESTAMP_TAG_0_0._fields_ = [
+    ("op", ctypes.c_uint32, 8),
+    ("sub_op", ctypes.c_uint32, 8),
+    ("reserved_0", ctypes.c_uint32, 16),
+]
+
+
+class union_SDMA_PKT_TIMESTAMP_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_TIMESTAMP_TAG_0._pack_ = 1
+union_SDMA_PKT_TIMESTAMP_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_TIMESTAMP_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_TIMESTAMP_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_TIMESTAMP_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_TIMESTAMP_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_TIMESTAMP_TAG_1_0._fields_ = [
+    ("addr_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_TIMESTAMP_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_TIMESTAMP_TAG_1._pack_ = 1
+union_SDMA_PKT_TIMESTAMP_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_TIMESTAMP_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_TIMESTAMP_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_TIMESTAMP_TAG_2_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_TIMESTAMP_TAG_2_0._pack_ = 1
+struct_SDMA_PKT_TIMESTAMP_TAG_2_0._fields_ = [
+    ("addr_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_TIMESTAMP_TAG_2(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_TIMESTAMP_TAG_2._pack_ = 1
+union_SDMA_PKT_TIMESTAMP_TAG_2._anonymous_ = ("_0",)
+union_SDMA_PKT_TIMESTAMP_TAG_2._fields_ = [
+    ("_0", struct_SDMA_PKT_TIMESTAMP_TAG_2_0),
+    ("DW_2_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_TIMESTAMP_TAG._pack_ = 1
+struct_SDMA_PKT_TIMESTAMP_TAG._fields_ = [
+    ("HEADER_UNION", union_SDMA_PKT_TIMESTAMP_TAG_0),
+    ("ADDR_LO_UNION", union_SDMA_PKT_TIMESTAMP_TAG_1),
+    ("ADDR_HI_UNION", union_SDMA_PKT_TIMESTAMP_TAG_2),
+]
+
+
+class struct_SDMA_PKT_ATOMIC_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_ATOMIC_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_ATOMIC_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG_0_0._fields_ = [
+    ("op", ctypes.c_uint32, 8),
+    ("sub_op", ctypes.c_uint32, 8),
+    ("l", ctypes.c_uint32, 1),
+    ("reserved_0", ctypes.c_uint32, 8),
+    ("operation", ctypes.c_uint32, 7),
+]
+
+
+class union_SDMA_PKT_ATOMIC_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_ATOMIC_TAG_0._pack_ = 1
+union_SDMA_PKT_ATOMIC_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_ATOMIC_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_ATOMIC_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_ATOMIC_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_ATOMIC_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG_1_0._fields_ = [
+    ("addr_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_ATOMIC_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_ATOMIC_TAG_1._pack_ = 1
+union_SDMA_PKT_ATOMIC_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_ATOMIC_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_ATOMIC_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_ATOMIC_TAG_2_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_ATOMIC_TAG_2_0._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG_2_0._fields_ = [
+    ("addr_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_ATOMIC_TAG_2(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_ATOMIC_TAG_2._pack_ = 1
+union_SDMA_PKT_ATOMIC_TAG_2._anonymous_ = ("_0",)
+union_SDMA_PKT_ATOMIC_TAG_2._fields_ = [
+    ("_0", struct_SDMA_PKT_ATOMIC_TAG_2_0),
+    ("DW_2_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_ATOMIC_TAG_3_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_ATOMIC_TAG_3_0._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG_3_0._fields_ = [
+    ("src_data_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_ATOMIC_TAG_3(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_ATOMIC_TAG_3._pack_ = 1
+union_SDMA_PKT_ATOMIC_TAG_3._anonymous_ = ("_0",)
+union_SDMA_PKT_ATOMIC_TAG_3._fields_ = [
+    ("_0", struct_SDMA_PKT_ATOMIC_TAG_3_0),
+    ("DW_3_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_ATOMIC_TAG_4_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_ATOMIC_TAG_4_0._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG_4_0._fields_ = [
+    ("src_data_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_ATOMIC_TAG_4(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_ATOMIC_TAG_4._pack_ = 1
+union_SDMA_PKT_ATOMIC_TAG_4._anonymous_ = ("_0",)
+union_SDMA_PKT_ATOMIC_TAG_4._fields_ = [
+    ("_0", struct_SDMA_PKT_ATOMIC_TAG_4_0),
+    ("DW_4_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_ATOMIC_TAG_5_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_ATOMIC_TAG_5_0._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG_5_0._fields_ = [
+    ("cmp_data_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_ATOMIC_TAG_5(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_ATOMIC_TAG_5._pack_ = 1
+union_SDMA_PKT_ATOMIC_TAG_5._anonymous_ = ("_0",)
+union_SDMA_PKT_ATOMIC_TAG_5._fields_ = [
+    ("_0", struct_SDMA_PKT_ATOMIC_TAG_5_0),
+    ("DW_5_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_ATOMIC_TAG_6_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_ATOMIC_TAG_6_0._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG_6_0._fields_ = [
+    ("cmp_data_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_ATOMIC_TAG_6(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_ATOMIC_TAG_6._pack_ = 1
+union_SDMA_PKT_ATOMIC_TAG_6._anonymous_ = ("_0",)
+union_SDMA_PKT_ATOMIC_TAG_6._fields_ = [
+    ("_0", struct_SDMA_PKT_ATOMIC_TAG_6_0),
+    ("DW_6_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_ATOMIC_TAG_7_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_ATOMIC_TAG_7_0._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG_7_0._fields_ = [
+    ("loop_interval", ctypes.c_uint32, 13),
+    ("reserved_0", ctypes.c_uint32, 19),
+]
+
+
+class union_SDMA_PKT_ATOMIC_TAG_7(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_ATOMIC_TAG_7._pack_ = 1
+union_SDMA_PKT_ATOMIC_TAG_7._anonymous_ = ("_0",)
+union_SDMA_PKT_ATOMIC_TAG_7._fields_ = [
+    ("_0", struct_SDMA_PKT_ATOMIC_TAG_7_0),
+    ("DW_7_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_ATOMIC_TAG._pack_ = 1
+struct_SDMA_PKT_ATOMIC_TAG._fields_ = [
+    ("HEADER_UNION", union_SDMA_PKT_ATOMIC_TAG_0),
+    ("ADDR_LO_UNION", union_SDMA_PKT_ATOMIC_TAG_1),
+    ("ADDR_HI_UNION", union_SDMA_PKT_ATOMIC_TAG_2),
+    ("SRC_DATA_LO_UNION", union_SDMA_PKT_ATOMIC_TAG_3),
+    ("SRC_DATA_HI_UNION", union_SDMA_PKT_ATOMIC_TAG_4),
+    ("CMP_DATA_LO_UNION", union_SDMA_PKT_ATOMIC_TAG_5),
+    ("CMP_DATA_HI_UNION", union_SDMA_PKT_ATOMIC_TAG_6),
+    ("LOOP_INTERVAL_UNION", union_SDMA_PKT_ATOMIC_TAG_7),
+]
+
+
+class struct_SDMA_PKT_HDP_FLUSH_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_HDP_FLUSH_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_HDP_FLUSH_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_HDP_FLUSH_TAG_0_0._fields_ = [
+    ("data", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_HDP_FLUSH_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_HDP_FLUSH_TAG_0._pack_ = 1
+union_SDMA_PKT_HDP_FLUSH_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_HDP_FLUSH_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_HDP_FLUSH_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_HDP_FLUSH_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_HDP_FLUSH_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_HDP_FLUSH_TAG_1_0._fields_ = [
+    ("data", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_HDP_FLUSH_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_HDP_FLUSH_TAG_1._pack_ = 1
+union_SDMA_PKT_HDP_FLUSH_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_HDP_FLUSH_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_HDP_FLUSH_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_HDP_FLUSH_TAG_2_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_HDP_FLUSH_TAG_2_0._pack_ = 1
+struct_SDMA_PKT_HDP_FLUSH_TAG_2_0._fields_ = [
+    ("data", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_HDP_FLUSH_TAG_2(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_HDP_FLUSH_TAG_2._pack_ = 1
+union_SDMA_PKT_HDP_FLUSH_TAG_2._anonymous_ = ("_0",)
+union_SDMA_PKT_HDP_FLUSH_TAG_2._fields_ = [
+    ("_0", struct_SDMA_PKT_HDP_FLUSH_TAG_2_0),
+    ("DW_2_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_HDP_FLUSH_TAG_3_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_HDP_FLUSH_TAG_3_0._pack_ = 1
+struct_SDMA_PKT_HDP_FLUSH_TAG_3_0._fields_ = [
+    ("data", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_HDP_FLUSH_TAG_3(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_HDP_FLUSH_TAG_3._pack_ = 1
+union_SDMA_PKT_HDP_FLUSH_TAG_3._anonymous_ = ("_0",)
+union_SDMA_PKT_HDP_FLUSH_TAG_3._fields_ = [
+    ("_0", struct_SDMA_PKT_HDP_FLUSH_TAG_3_0),
+    ("DW_3_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_HDP_FLUSH_TAG_4_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_HDP_FLUSH_TAG_4_0._pack_ = 1
+struct_SDMA_PKT_HDP_FLUSH_TAG_4_0._fields_ = [
+    ("data", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_HDP_FLUSH_TAG_4(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_HDP_FLUSH_TAG_4._pack_ = 1
+union_SDMA_PKT_HDP_FLUSH_TAG_4._anonymous_ = ("_0",)
+union_SDMA_PKT_HDP_FLUSH_TAG_4._fields_ = [
+    ("_0", struct_SDMA_PKT_HDP_FLUSH_TAG_4_0),
+    ("DW_4_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_HDP_FLUSH_TAG_5_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_HDP_FLUSH_TAG_5_0._pack_ = 1
+struct_SDMA_PKT_HDP_FLUSH_TAG_5_0._fields_ = [
+    ("data", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_HDP_FLUSH_TAG_5(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_HDP_FLUSH_TAG_5._pack_ = 1
+union_SDMA_PKT_HDP_FLUSH_TAG_5._anonymous_ = ("_0",)
+union_SDMA_PKT_HDP_FLUSH_TAG_5._fields_ = [
+    ("_0", struct_SDMA_PKT_HDP_FLUSH_TAG_5_0),
+    ("DW_5_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_HDP_FLUSH_TAG._pack_ = 1
+struct_SDMA_PKT_HDP_FLUSH_TAG._fields_ = [
+    ("DW_0_UNION", union_SDMA_PKT_HDP_FLUSH_TAG_0),
+    ("DW_1_UNION", union_SDMA_PKT_HDP_FLUSH_TAG_1),
+    ("DW_2_UNION", union_SDMA_PKT_HDP_FLUSH_TAG_2),
+    ("DW_3_UNION", union_SDMA_PKT_HDP_FLUSH_TAG_3),
+    ("DW_4_UNION", union_SDMA_PKT_HDP_FLUSH_TAG_4),
+    ("DW_5_UNION", union_SDMA_PKT_HDP_FLUSH_TAG_5),
+]
+
+
+class struct_SDMA_PKT_INDIRECT_TAG(ctypes.Structure):
+    pass
+
+
+class struct_SDMA_PKT_INDIRECT_TAG_0_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_INDIRECT_TAG_0_0._pack_ = 1
+struct_SDMA_PKT_INDIRECT_TAG_0_0._fields_ = [
+    ("op", ctypes.c_uint32, 8),
+    ("sub_op", ctypes.c_uint32, 8),
+    ("vmid", ctypes.c_uint32, 4),
+    ("reserved_0", ctypes.c_uint32, 11),
+    ("priv", ctypes.c_uint32, 1),
+]
+
+
+class union_SDMA_PKT_INDIRECT_TAG_0(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_INDIRECT_TAG_0._pack_ = 1
+union_SDMA_PKT_INDIRECT_TAG_0._anonymous_ = ("_0",)
+union_SDMA_PKT_INDIRECT_TAG_0._fields_ = [
+    ("_0", struct_SDMA_PKT_INDIRECT_TAG_0_0),
+    ("DW_0_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_INDIRECT_TAG_1_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_INDIRECT_TAG_1_0._pack_ = 1
+struct_SDMA_PKT_INDIRECT_TAG_1_0._fields_ = [
+    ("ib_base_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_INDIRECT_TAG_1(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_INDIRECT_TAG_1._pack_ = 1
+union_SDMA_PKT_INDIRECT_TAG_1._anonymous_ = ("_0",)
+union_SDMA_PKT_INDIRECT_TAG_1._fields_ = [
+    ("_0", struct_SDMA_PKT_INDIRECT_TAG_1_0),
+    ("DW_1_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_INDIRECT_TAG_2_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_INDIRECT_TAG_2_0._pack_ = 1
+struct_SDMA_PKT_INDIRECT_TAG_2_0._fields_ = [
+    ("ib_base_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_INDIRECT_TAG_2(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_INDIRECT_TAG_2._pack_ = 1
+union_SDMA_PKT_INDIRECT_TAG_2._anonymous_ = ("_0",)
+union_SDMA_PKT_INDIRECT_TAG_2._fields_ = [
+    ("_0", struct_SDMA_PKT_INDIRECT_TAG_2_0),
+    ("DW_2_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_INDIRECT_TAG_3_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_INDIRECT_TAG_3_0._pack_ = 1
+struct_SDMA_PKT_INDIRECT_TAG_3_0._fields_ = [
+    ("ib_size", ctypes.c_uint32, 20),
+    ("reserved_0", ctypes.c_uint32, 12),
+]
+
+
+class union_SDMA_PKT_INDIRECT_TAG_3(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_INDIRECT_TAG_3._pack_ = 1
+union_SDMA_PKT_INDIRECT_TAG_3._anonymous_ = ("_0",)
+union_SDMA_PKT_INDIRECT_TAG_3._fields_ = [
+    ("_0", struct_SDMA_PKT_INDIRECT_TAG_3_0),
+    ("DW_3_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_INDIRECT_TAG_4_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_INDIRECT_TAG_4_0._pack_ = 1
+struct_SDMA_PKT_INDIRECT_TAG_4_0._fields_ = [
+    ("csa_addr_31_0", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_INDIRECT_TAG_4(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_INDIRECT_TAG_4._pack_ = 1
+union_SDMA_PKT_INDIRECT_TAG_4._anonymous_ = ("_0",)
+union_SDMA_PKT_INDIRECT_TAG_4._fields_ = [
+    ("_0", struct_SDMA_PKT_INDIRECT_TAG_4_0),
+    ("DW_4_DATA", ctypes.c_uint32),
+]
+
+
+class struct_SDMA_PKT_INDIRECT_TAG_5_0(ctypes.Structure):
+    pass
+
+
+struct_SDMA_PKT_INDIRECT_TAG_5_0._pack_ = 1
+struct_SDMA_PKT_INDIRECT_TAG_5_0._fields_ = [
+    ("csa_addr_63_32", ctypes.c_uint32, 32),
+]
+
+
+class union_SDMA_PKT_INDIRECT_TAG_5(ctypes.Union):
+    pass
+
+
+union_SDMA_PKT_INDIRECT_TAG_5._pack_ = 1
+union_SDMA_PKT_INDIRECT_TAG_5._anonymous_ = ("_0",)
+union_SDMA_PKT_INDIRECT_TAG_5._fields_ = [
+    ("_0", struct_SDMA_PKT_INDIRECT_TAG_5_0),
+    ("DW_5_DATA", ctypes.c_uint32),
+]
+
+struct_SDMA_PKT_INDIRECT_TAG._pack_ = 1
+struct_SDMA_PKT_INDIRECT_TAG._fields_ = [
+    ("HEADER_UNION", union_SDMA_PKT_INDIRECT_TAG_0),
+    ("BASE_LO_UNION", union_SDMA_PKT_INDIRECT_TAG_1),
+    ("BASE_HI_UNION", union_SDMA_PKT_INDIRECT_TAG_2),
+    ("IB_SIZE_UNION", union_SDMA_PKT_INDIRECT_TAG_3),
+    ("CSA_ADDR_LO_UNION", union_SDMA_PKT_INDIRECT_TAG_4),
+    ("CSA_ADDR_HI_UNION", union_SDMA_PKT_INDIRECT_TAG_5),
+]
+
+
+SDMA_OP_NOP = 0
+SDMA_OP_COPY = 1
+SDMA_OP_WRITE = 2
+SDMA_OP_INDIRECT = 4
+SDMA_OP_FENCE = 5
+SDMA_OP_TRAP = 6
+SDMA_OP_SEM = 7
+SDMA_OP_POLL_REGMEM = 8
+SDMA_OP_COND_EXE = 9
+SDMA_OP_ATOMIC = 10
+SDMA_OP_CONST_FILL = 11
+SDMA_OP_TIMESTAMP = 13
+SDMA_OP_GCR = 17
+SDMA_SUBOP_COPY_LINEAR = 0
+SDMA_SUBOP_COPY_LINEAR_RECT = 4
+SDMA_SUBOP_TIMESTAMP_GET_GLOBAL = 2
+SDMA_ATOMIC_ADD64 = 47
+
+# nvd.h
+PACKET_TYPE3 = 3
+
+
+def PACKET3(op, n):
+    return (PACKET_TYPE3 << 30) | (((op) & 0xFF) << 8) | ((n) & 0x3FFF) << 16
+
+
+def PACKET3_COMPUTE(op, n):
+    return PACKET3(op, n) | 1 << 1
+
+
+PACKET3_NOP = 0x10
+PACKET3_INDIRECT_BUFFER = 0x3F
+PACKET3_INDIRECT_BUFFER_CONST = 0x33
+PACKET3_WRITE_DATA = 0x37
+PACKET3_WAIT_REG_MEM = 0x3C
+PACKET3_RELEASE_MEM = 0x49
+PACKET3_ACQUIRE_MEM = 0x58
+PACKET3_DISPATCH_DIRECT = 0x15
+PACKET3_SET_SH_REG = 0x76
+
+
+INDIRECT_BUFFER_VALID = 1 << 23
+
+
+def INDIRECT_BUFFER_CACHE_POLICY(x):
+    return (x) << 28
@@ -0,0 +1,105 @@
+# mypy: ignore-errors
+# test stand-in for the clang2py output of the ROCm HSA headers, see conftest.py
+import ctypes
+
+HSA_PACKET_TYPE_VENDOR_SPECIFIC = 0
+HSA_PACKET_TYPE_INVALID = 1
+HSA_PACKET_TYPE_KERNEL_DISPATCH = 2
+HSA_PACKET_TYPE_BARRIER_AND = 3
+HSA_PACKET_TYPE_AGENT_DISPATCH = 4
+HSA_PACKET_TYPE_BARRIER_OR = 5
+HSA_PACKET_HEADER_TYPE = 0
+HSA_PACKET_HEADER_BARRIER = 8
+HSA_PACKET_HEADER_SCACQUIRE_FENCE_SCOPE = 9
+HSA_PACKET_HEADER_ACQUIRE_FENCE_SCOPE = 9
+HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE = 11
+HSA_PACKET_HEADER_RELEASE_FENCE_SCOPE = 11
+HSA_FENCE_SCOPE_NONE = 0
+HSA_FENCE_SCOPE_AGENT = 1
+HSA_FENCE_SCOPE_SYSTEM = 2
+HSA_KERNEL_DISPATCH_PACKET_SETUP_DIMENSIONS = 0
+
+
+class struct_hsa_signal_s(ctypes.Structure):
+    _fields_ = [("handle", ctypes.c_uint64)]
+
+
+hsa_signal_t = struct_hsa_signal_s
+
+
+class struct_hsa_queue_s(ctypes.Structure):
+    _fields_ = [
+        ("type", ctypes.c_uint32),
+        ("features", ctypes.c_uint32),
+        ("base_address", ctypes.c_void_p),
+        ("doorbell_signal", hsa_signal_t),
+        ("size", ctypes.c_uint32),
+        ("reserved1", ctypes.c_uint32),
+        ("id", ctypes.c_uint64),
+    ]
+
+
+class struct_amd_queue_s(ctypes.Structure):
+    _fields_ = [
+        ("hsa_queue", struct_hsa_queue_s),
+        ("reserved1", ctypes.c_uint32 * 4),
+        ("write_dispatch_id", ctypes.c_uint64),
+        ("group_segment_aperture_base_hi", ctypes.c_uint32),
+        ("private_segment_aperture_base_hi", ctypes.c_uint32),
+        ("max_cu_id", ctypes.c_uint32),
+        ("max_wave_id", ctypes.c_uint32),
+        ("max_legacy_doorbell_dispatch_id_plus_1", ctypes.c_uint64),
+        ("legacy_doorbell_lock", ctypes.c_uint32),
+        ("reserved2", ctypes.c_uint32 * 9),
+        ("read_dispatch_id", ctypes.c_uint64),
+        ("read_dispatch_id_field_base_byte_offset", ctypes.c_uint32),
+        ("compute_tmpring_size", ctypes.c_uint32),
+        ("scratch_resource_descriptor", ctypes.c_uint32 * 4),
+        ("scratch_backing_memory_location", ctypes.c_uint64),
+        ("scratch_backing_memory_byte_size", ctypes.c_uint64),
+        ("scratch_workitem_byte_size", ctypes.c_uint32),
+        ("queue_properties", ctypes.c_uint32),
+        ("reserved3", ctypes.c_uint32 * 2),
+        ("queue_inactive_signal", hsa_signal_t),
+        ("reserved4", ctypes.c_uint32 * 14),
+    ]
+
+
+amd_queue_t = struct_amd_queue_s
+
+
+class struct_hsa_kernel_dispatch_packet_s(ctypes.Structure):
+    _fields_ = [
+        ("header", ctypes.c_uint16),
+        ("setup", ctypes.c_uint16),
+        ("workgroup_size_x", ctypes.c_uint16),
+        ("workgroup_size_y", ctypes.c_uint16),
+        ("workgroup_size_z", ctypes.c_uint16),
+        ("reserved0", ctypes.c_uint16),
+        ("grid_size_x", ctypes.c_uint32),
+        ("grid_size_y", ctypes.c_uint32),
+        ("grid_size_z", ctypes.c_uint32),
+        ("private_segment_size", ctypes.c_uint32),
+        ("group_segment_size", ctypes.c_uint32),
+        ("kernel_object", ctypes.c_uint64),
+        ("kernarg_address", ctypes.c_void_p),
+        ("reserved2", ctypes.c_uint64),
+        ("completion_signal", hsa_signal_t),
+    ]
+
+
+hsa_kernel_dispatch_packet_t = struct_hsa_kernel_dispatch_packet_s
+
+
+class struct_hsa_barrier_and_packet_s(ctypes.Structure):
+    _fields_ = [
+        ("header", ctypes.c_uint16),
+        ("reserved0", ctypes.c_uint16),
+        ("reserved1", ctypes.c_uint32),
+        ("dep_signal", hsa_signal_t * 5),
+        ("reserved2", ctypes.c_uint64),
+        ("completion_signal", hsa_signal_t),
+    ]
+
+
+hsa_barrier_and_packet_t = struct_hsa_barrier_and_packet_s
@@ -0,0 +1,709 @@
+# mypy: ignore-errors
+# test stand-in for the clang2py output of kfd_ioctl.h, see conftest.py
+import ctypes, os
+
+KFD_IOCTL_MAJOR_VERSION = 1
+KFD_IOCTL_MINOR_VERSION = 11
+KFD_IOC_QUEUE_TYPE_COMPUTE = 0
+KFD_IOC_QUEUE_TYPE_SDMA = 1
+KFD_IOC_QUEUE_TYPE_COMPUTE_AQL = 2
+KFD_IOC_QUEUE_TYPE_SDMA_XGMI = 3
+KFD_MAX_QUEUE_PERCENTAGE = 100
+KFD_MAX_QUEUE_PRIORITY = 15
+KFD_MIN_QUEUE_RING_SIZE = 1024
+KFD_IOC_CACHE_POLICY_COHERENT = 0
+KFD_IOC_CACHE_POLICY_NONCOHERENT = 1
+NUM_OF_SUPPORTED_GPUS = 7
+MAX_ALLOWED_NUM_POINTS = 100
+MAX_ALLOWED_AW_BUFF_SIZE = 4096
+MAX_ALLOWED_WAC_BUFF_SIZE = 128
+KFD_INVALID_FD = 4294967295
+KFD_IOC_EVENT_SIGNAL = 0
+KFD_IOC_EVENT_NODECHANGE = 1
+KFD_IOC_EVENT_DEVICESTATECHANGE = 2
+KFD_IOC_EVENT_HW_EXCEPTION = 3
+KFD_IOC_EVENT_SYSTEM_EVENT = 4
+KFD_IOC_EVENT_DEBUG_EVENT = 5
+KFD_IOC_EVENT_PROFILE_EVENT = 6
+KFD_IOC_EVENT_QUEUE_EVENT = 7
+KFD_IOC_EVENT_MEMORY = 8
+KFD_IOC_WAIT_RESULT_COMPLETE = 0
+KFD_IOC_WAIT_RESULT_TIMEOUT = 1
+KFD_IOC_WAIT_RESULT_FAIL = 2
+KFD_SIGNAL_EVENT_LIMIT = 4096
+KFD_HW_EXCEPTION_WHOLE_GPU_RESET = 0
+KFD_HW_EXCEPTION_PER_ENGINE_RESET = 1
+KFD_HW_EXCEPTION_GPU_HANG = 0
+KFD_HW_EXCEPTION_ECC = 1
+KFD_MEM_ERR_NO_RAS = 0
+KFD_MEM_ERR_SRAM_ECC = 1
+KFD_MEM_ERR_POISON_CONSUMED = 2
+KFD_MEM_ERR_GPU_HANG = 3
+KFD_IOC_ALLOC_MEM_FLAGS_VRAM = 1
+KFD_IOC_ALLOC_MEM_FLAGS_GTT = 2
+KFD_IOC_ALLOC_MEM_FLAGS_USERPTR = 4
+KFD_IOC_ALLOC_MEM_FLAGS_DOORBELL = 8
+KFD_IOC_ALLOC_MEM_FLAGS_MMIO_REMAP = 16
+KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE = 2147483648
+KFD_IOC_ALLOC_MEM_FLAGS_EXECUTABLE = 1073741824
+KFD_IOC_ALLOC_MEM_FLAGS_PUBLIC = 536870912
+KFD_IOC_ALLOC_MEM_FLAGS_NO_SUBSTITUTE = 268435456
+KFD_IOC_ALLOC_MEM_FLAGS_AQL_QUEUE_MEM = 134217728
+KFD_IOC_ALLOC_MEM_FLAGS_COHERENT = 67108864
+KFD_IOC_ALLOC_MEM_FLAGS_UNCACHED = 33554432
+KFD_SMI_EVENT_MSG_SIZE = 96
+KFD_IOCTL_SVM_FLAG_HOST_ACCESS = 1
+KFD_IOCTL_SVM_FLAG_COHERENT = 2
+KFD_IOCTL_SVM_FLAG_HIVE_LOCAL = 4
+KFD_IOCTL_SVM_FLAG_GPU_RO = 8
+KFD_IOCTL_SVM_FLAG_GPU_EXEC = 16
+KFD_IOCTL_SVM_FLAG_GPU_READ_MOSTLY = 32
+KFD_IOCTL_SVM_FLAG_GPU_ALWAYS_MAPPED = 64
+AMDKFD_COMMAND_START = 1
+AMDKFD_COMMAND_END = 36
+KFD_SMI_EVENT_NONE = 0
+KFD_SMI_EVENT_VMFAULT = 1
+KFD_SMI_EVENT_THERMAL_THROTTLE = 2
+KFD_SMI_EVENT_GPU_PRE_RESET = 3
+KFD_SMI_EVENT_GPU_POST_RESET = 4
+KFD_SMI_EVENT_MIGRATE_START = 5
+KFD_SMI_EVENT_MIGRATE_END = 6
+KFD_SMI_EVENT_PAGE_FAULT_START = 7
+KFD_SMI_EVENT_PAGE_FAULT_END = 8
+KFD_SMI_EVENT_QUEUE_EVICTION = 9
+KFD_SMI_EVENT_QUEUE_RESTORE = 10
+KFD_SMI_EVENT_UNMAP_FROM_GPU = 11
+KFD_SMI_EVENT_ALL_PROCESS = 64
+KFD_MIGRATE_TRIGGER_PREFETCH = 0
+KFD_MIGRATE_TRIGGER_PAGEFAULT_GPU = 1
+KFD_MIGRATE_TRIGGER_PAGEFAULT_CPU = 2
+KFD_MIGRATE_TRIGGER_TTM_EVICTION = 3
+KFD_QUEUE_EVICTION_TRIGGER_SVM = 0
+KFD_QUEUE_EVICTION_TRIGGER_USERPTR = 1
+KFD_QUEUE_EVICTION_TRIGGER_TTM = 2
+KFD_QUEUE_EVICTION_TRIGGER_SUSPEND = 3
+KFD_QUEUE_EVICTION_CRIU_CHECKPOINT = 4
+KFD_QUEUE_EVICTION_CRIU_RESTORE = 5
+KFD_SVM_UNMAP_TRIGGER_MMU_NOTIFY = 0
+KFD_SVM_UNMAP_TRIGGER_MMU_NOTIFY_MIGRATE = 1
+KFD_SVM_UNMAP_TRIGGER_UNMAP_FROM_CPU = 2
+KFD_CRIU_OP_PROCESS_INFO = 0
+KFD_CRIU_OP_CHECKPOINT = 1
+KFD_CRIU_OP_UNPAUSE = 2
+KFD_CRIU_OP_RESTORE = 3
+KFD_CRIU_OP_RESUME = 4
+KFD_MMIO_REMAP_HDP_MEM_FLUSH_CNTL = 0
+KFD_MMIO_REMAP_HDP_REG_FLUSH_CNTL = 4
+KFD_IOCTL_SVM_OP_SET_ATTR = 0
+KFD_IOCTL_SVM_OP_GET_ATTR = 1
+KFD_IOCTL_SVM_LOCATION_SYSMEM = 0
+KFD_IOCTL_SVM_LOCATION_UNDEFINED = 4294967295
+KFD_IOCTL_SVM_ATTR_PREFERRED_LOC = 0
+KFD_IOCTL_SVM_ATTR_PREFETCH_LOC = 1
+KFD_IOCTL_SVM_ATTR_ACCESS = 2
+KFD_IOCTL_SVM_ATTR_ACCESS_IN_PLACE = 3
+KFD_IOCTL_SVM_ATTR_NO_ACCESS = 4
+KFD_IOCTL_SVM_ATTR_SET_FLAGS = 5
+KFD_IOCTL_SVM_ATTR_CLR_FLAGS = 6
+KFD_IOCTL_SVM_ATTR_GRANULARITY = 7
+
+
+class struct_kfd_ioctl_get_version_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_get_version_args._pack_ = 1
+struct_kfd_ioctl_get_version_args._fields_ = [
+    ("major_version", ctypes.c_uint32),
+    ("minor_version", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_create_queue_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_create_queue_args._pack_ = 1
+struct_kfd_ioctl_create_queue_args._fields_ = [
+    ("ring_base_address", ctypes.c_uint64),
+    ("write_pointer_address", ctypes.c_uint64),
+    ("read_pointer_address", ctypes.c_uint64),
+    ("doorbell_offset", ctypes.c_uint64),
+    ("ring_size", ctypes.c_uint32),
+    ("gpu_id", ctypes.c_uint32),
+    ("queue_type", ctypes.c_uint32),
+    ("queue_percentage", ctypes.c_uint32),
+    ("queue_priority", ctypes.c_uint32),
+    ("queue_id", ctypes.c_uint32),
+    ("eop_buffer_address", ctypes.c_uint64),
+    ("eop_buffer_size", ctypes.c_uint64),
+    ("ctx_save_restore_address", ctypes.c_uint64),
+    ("ctx_save_restore_size", ctypes.c_uint32),
+    ("ctl_stack_size", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_destroy_queue_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_destroy_queue_args._pack_ = 1
+struct_kfd_ioctl_destroy_queue_args._fields_ = [
+    ("queue_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_update_queue_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_update_queue_args._pack_ = 1
+struct_kfd_ioctl_update_queue_args._fields_ = [
+    ("ring_base_address", ctypes.c_uint64),
+    ("queue_id", ctypes.c_uint32),
+    ("ring_size", ctypes.c_uint32),
+    ("queue_percentage", ctypes.c_uint32),
+    ("queue_priority", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_set_cu_mask_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_set_cu_mask_args._pack_ = 1
+struct_kfd_ioctl_set_cu_mask_args._fields_ = [
+    ("queue_id", ctypes.c_uint32),
+    ("num_cu_mask", ctypes.c_uint32),
+    ("cu_mask_ptr", ctypes.c_uint64),
+]
+
+
+class struct_kfd_ioctl_get_queue_wave_state_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_get_queue_wave_state_args._pack_ = 1
+struct_kfd_ioctl_get_queue_wave_state_args._fields_ = [
+    ("ctl_stack_address", ctypes.c_uint64),
+    ("ctl_stack_used_size", ctypes.c_uint32),
+    ("save_area_used_size", ctypes.c_uint32),
+    ("queue_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_get_available_memory_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_get_available_memory_args._pack_ = 1
+struct_kfd_ioctl_get_available_memory_args._fields_ = [
+    ("available", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_set_memory_policy_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_set_memory_policy_args._pack_ = 1
+struct_kfd_ioctl_set_memory_policy_args._fields_ = [
+    ("alternate_aperture_base", ctypes.c_uint64),
+    ("alternate_aperture_size", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("default_policy", ctypes.c_uint32),
+    ("alternate_policy", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_get_clock_counters_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_get_clock_counters_args._pack_ = 1
+struct_kfd_ioctl_get_clock_counters_args._fields_ = [
+    ("gpu_clock_counter", ctypes.c_uint64),
+    ("cpu_clock_counter", ctypes.c_uint64),
+    ("system_clock_counter", ctypes.c_uint64),
+    ("system_clock_freq", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_process_device_apertures(ctypes.Structure):
+    pass
+
+
+struct_kfd_process_device_apertures._pack_ = 1
+struct_kfd_process_device_apertures._fields_ = [
+    ("lds_base", ctypes.c_uint64),
+    ("lds_limit", ctypes.c_uint64),
+    ("scratch_base", ctypes.c_uint64),
+    ("scratch_limit", ctypes.c_uint64),
+    ("gpuvm_base", ctypes.c_uint64),
+    ("gpuvm_limit", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_get_process_apertures_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_get_process_apertures_args._pack_ = 1
+struct_kfd_ioctl_get_process_apertures_args._fields_ = [
+    ("process_apertures", struct_kfd_process_device_apertures * NUM_OF_SUPPORTED_GPUS),
+    ("num_of_nodes", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_get_process_apertures_new_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_get_process_apertures_new_args._pack_ = 1
+struct_kfd_ioctl_get_process_apertures_new_args._fields_ = [
+    ("kfd_process_device_apertures_ptr", ctypes.c_uint64),
+    ("num_of_nodes", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_dbg_register_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_dbg_register_args._pack_ = 1
+struct_kfd_ioctl_dbg_register_args._fields_ = [
+    ("gpu_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_dbg_unregister_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_dbg_unregister_args._pack_ = 1
+struct_kfd_ioctl_dbg_unregister_args._fields_ = [
+    ("gpu_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_dbg_address_watch_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_dbg_address_watch_args._pack_ = 1
+struct_kfd_ioctl_dbg_address_watch_args._fields_ = [
+    ("content_ptr", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("buf_size_in_bytes", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_dbg_wave_control_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_dbg_wave_control_args._pack_ = 1
+struct_kfd_ioctl_dbg_wave_control_args._fields_ = [
+    ("content_ptr", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("buf_size_in_bytes", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_create_event_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_create_event_args._pack_ = 1
+struct_kfd_ioctl_create_event_args._fields_ = [
+    ("event_page_offset", ctypes.c_uint64),
+    ("event_trigger_data", ctypes.c_uint32),
+    ("event_type", ctypes.c_uint32),
+    ("auto_reset", ctypes.c_uint32),
+    ("node_id", ctypes.c_uint32),
+    ("event_id", ctypes.c_uint32),
+    ("event_slot_index", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_destroy_event_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_destroy_event_args._pack_ = 1
+struct_kfd_ioctl_destroy_event_args._fields_ = [
+    ("event_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_set_event_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_set_event_args._pack_ = 1
+struct_kfd_ioctl_set_event_args._fields_ = [
+    ("event_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_reset_event_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_reset_event_args._pack_ = 1
+struct_kfd_ioctl_reset_event_args._fields_ = [
+    ("event_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_memory_exception_failure(ctypes.Structure):
+    pass
+
+
+struct_kfd_memory_exception_failure._pack_ = 1
+struct_kfd_memory_exception_failure._fields_ = [
+    ("NotPresent", ctypes.c_uint32),
+    ("ReadOnly", ctypes.c_uint32),
+    ("NoExecute", ctypes.c_uint32),
+    ("imprecise", ctypes.c_uint32),
+]
+
+
+class struct_kfd_hsa_memory_exception_data(ctypes.Structure):
+    pass
+
+
+struct_kfd_hsa_memory_exception_data._pack_ = 1
+struct_kfd_hsa_memory_exception_data._fields_ = [
+    ("failure", struct_kfd_memory_exception_failure),
+    ("va", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("ErrorType", ctypes.c_uint32),
+]
+
+
+class struct_kfd_hsa_hw_exception_data(ctypes.Structure):
+    pass
+
+
+struct_kfd_hsa_hw_exception_data._pack_ = 1
+struct_kfd_hsa_hw_exception_data._fields_ = [
+    ("reset_type", ctypes.c_uint32),
+    ("reset_cause", ctypes.c_uint32),
+    ("memory_lost", ctypes.c_uint32),
+    ("gpu_id", ctypes.c_uint32),
+]
+
+
+class struct_kfd_event_data(ctypes.Structure):
+    pass
+
+
+struct_kfd_event_data._pack_ = 1
+struct_kfd_event_data._fields_ = [
+    ("_union", ctypes.c_ubyte * 32),
+    ("kfd_event_data_ext", ctypes.c_uint64),
+    ("event_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_wait_events_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_wait_events_args._pack_ = 1
+struct_kfd_ioctl_wait_events_args._fields_ = [
+    ("events_ptr", ctypes.c_uint64),
+    ("num_events", ctypes.c_uint32),
+    ("wait_for_all", ctypes.c_uint32),
+    ("timeout", ctypes.c_uint32),
+    ("wait_result", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_set_scratch_backing_va_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_set_scratch_backing_va_args._pack_ = 1
+struct_kfd_ioctl_set_scratch_backing_va_args._fields_ = [
+    ("va_addr", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_get_tile_config_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_get_tile_config_args._pack_ = 1
+struct_kfd_ioctl_get_tile_config_args._fields_ = [
+    ("tile_config_ptr", ctypes.c_uint64),
+    ("macro_tile_config_ptr", ctypes.c_uint64),
+    ("num_tile_configs", ctypes.c_uint32),
+    ("num_macro_tile_configs", ctypes.c_uint32),
+    ("gpu_id", ctypes.c_uint32),
+    ("gb_addr_config", ctypes.c_uint32),
+    ("num_banks", ctypes.c_uint32),
+    ("num_ranks", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_set_trap_handler_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_set_trap_handler_args._pack_ = 1
+struct_kfd_ioctl_set_trap_handler_args._fields_ = [
+    ("tba_addr", ctypes.c_uint64),
+    ("tma_addr", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_acquire_vm_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_acquire_vm_args._pack_ = 1
+struct_kfd_ioctl_acquire_vm_args._fields_ = [
+    ("drm_fd", ctypes.c_uint32),
+    ("gpu_id", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_alloc_memory_of_gpu_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_alloc_memory_of_gpu_args._pack_ = 1
+struct_kfd_ioctl_alloc_memory_of_gpu_args._fields_ = [
+    ("va_addr", ctypes.c_uint64),
+    ("size", ctypes.c_uint64),
+    ("handle", ctypes.c_uint64),
+    ("mmap_offset", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("flags", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_free_memory_of_gpu_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_free_memory_of_gpu_args._pack_ = 1
+struct_kfd_ioctl_free_memory_of_gpu_args._fields_ = [("handle", ctypes.c_uint64)]
+
+
+class struct_kfd_ioctl_map_memory_to_gpu_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_map_memory_to_gpu_args._pack_ = 1
+struct_kfd_ioctl_map_memory_to_gpu_args._fields_ = [
+    ("handle", ctypes.c_uint64),
+    ("device_ids_array_ptr", ctypes.c_uint64),
+    ("n_devices", ctypes.c_uint32),
+    ("n_success", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_unmap_memory_from_gpu_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_unmap_memory_from_gpu_args._pack_ = 1
+struct_kfd_ioctl_unmap_memory_from_gpu_args._fields_ = [
+    ("handle", ctypes.c_uint64),
+    ("device_ids_array_ptr", ctypes.c_uint64),
+    ("n_devices", ctypes.c_uint32),
+    ("n_success", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_alloc_queue_gws_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_alloc_queue_gws_args._pack_ = 1
+struct_kfd_ioctl_alloc_queue_gws_args._fields_ = [
+    ("queue_id", ctypes.c_uint32),
+    ("num_gws", ctypes.c_uint32),
+    ("first_gws", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_get_dmabuf_info_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_get_dmabuf_info_args._pack_ = 1
+struct_kfd_ioctl_get_dmabuf_info_args._fields_ = [
+    ("size", ctypes.c_uint64),
+    ("metadata_ptr", ctypes.c_uint64),
+    ("metadata_size", ctypes.c_uint32),
+    ("gpu_id", ctypes.c_uint32),
+    ("flags", ctypes.c_uint32),
+    ("dmabuf_fd", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_import_dmabuf_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_import_dmabuf_args._pack_ = 1
+struct_kfd_ioctl_import_dmabuf_args._fields_ = [
+    ("va_addr", ctypes.c_uint64),
+    ("handle", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("dmabuf_fd", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_smi_events_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_smi_events_args._pack_ = 1
+struct_kfd_ioctl_smi_events_args._fields_ = [
+    ("gpuid", ctypes.c_uint32),
+    ("anon_fd", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_criu_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_criu_args._pack_ = 1
+struct_kfd_ioctl_criu_args._fields_ = [
+    ("devices", ctypes.c_uint64),
+    ("bos", ctypes.c_uint64),
+    ("priv_data", ctypes.c_uint64),
+    ("priv_data_size", ctypes.c_uint64),
+    ("num_devices", ctypes.c_uint32),
+    ("num_bos", ctypes.c_uint32),
+    ("num_objects", ctypes.c_uint32),
+    ("pid", ctypes.c_uint32),
+    ("op", ctypes.c_uint32),
+]
+
+
+class struct_kfd_criu_device_bucket(ctypes.Structure):
+    pass
+
+
+struct_kfd_criu_device_bucket._pack_ = 1
+struct_kfd_criu_device_bucket._fields_ = [
+    ("user_gpu_id", ctypes.c_uint32),
+    ("actual_gpu_id", ctypes.c_uint32),
+    ("drm_fd", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_criu_bo_bucket(ctypes.Structure):
+    pass
+
+
+struct_kfd_criu_bo_bucket._pack_ = 1
+struct_kfd_criu_bo_bucket._fields_ = [
+    ("addr", ctypes.c_uint64),
+    ("size", ctypes.c_uint64),
+    ("offset", ctypes.c_uint64),
+    ("restored_offset", ctypes.c_uint64),
+    ("gpu_id", ctypes.c_uint32),
+    ("alloc_flags", ctypes.c_uint32),
+    ("dmabuf_fd", ctypes.c_uint32),
+    ("pad", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_svm_attribute(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_svm_attribute._pack_ = 1
+struct_kfd_ioctl_svm_attribute._fields_ = [
+    ("type", ctypes.c_uint32),
+    ("value", ctypes.c_uint32),
+]
+
+
+class struct_kfd_ioctl_svm_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_svm_args._pack_ = 1
+struct_kfd_ioctl_svm_args._fields_ = [
+    ("start_addr", ctypes.c_uint64),
+    ("size", ctypes.c_uint64),
+    ("op", ctypes.c_uint32),
+    ("nattr", ctypes.c_uint32),
+    ("attrs", struct_kfd_ioctl_svm_attribute * 0),
+]
+
+
+class struct_kfd_ioctl_set_xnack_mode_args(ctypes.Structure):
+    pass
+
+
+struct_kfd_ioctl_set_xnack_mode_args._pack_ = 1
+struct_kfd_ioctl_set_xnack_mode_args._fields_ = [("xnack_enabled", ctypes.c_int32)]
+
+# AMDKFD_IOC_GET_VERSION = _IOR('K', nr, type) ( 0x01 , struct kfd_ioctl_get_version_args ) # macro
+# AMDKFD_IOC_CREATE_QUEUE = _IOWR('K', nr, type) ( 0x02 , struct kfd_ioctl_create_queue_args ) # macro
+# AMDKFD_IOC_DESTROY_QUEUE = _IOWR('K', nr, type) ( 0x03 , struct kfd_ioctl_destroy_queue_args ) # macro
+# AMDKFD_IOC_SET_MEMORY_POLICY = _IOW('K', nr, type) ( 0x04 , struct kfd_ioctl_set_memory_policy_args ) # macro
+# AMDKFD_IOC_GET_CLOCK_COUNTERS = _IOWR('K', nr, type) ( 0x05 , struct kfd_ioctl_get_clock_counters_args ) # macro
+# AMDKFD_IOC_GET_PROCESS_APERTURES = _IOR('K', nr, type) ( 0x06 , struct kfd_ioctl_get_process_apertures_args ) # macro
+# AMDKFD_IOC_UPDATE_QUEUE = _IOW('K', nr, type) ( 0x07 , struct kfd_ioctl_update_queue_args ) # macro
+# AMDKFD_IOC_CREATE_EVENT = _IOWR('K', nr, type) ( 0x08 , struct kfd_ioctl_create_event_args ) # macro
+# AMDKFD_IOC_DESTROY_EVENT = _IOW('K', nr, type) ( 0x09 , struct kfd_ioctl_destroy_event_args ) # macro
+# AMDKFD_IOC_SET_EVENT = _IOW('K', nr, type) ( 0x0A , struct kfd_ioctl_set_event_args ) # macro
+# AMDKFD_IOC_RESET_EVENT = _IOW('K', nr, type) ( 0x0B , struct kfd_ioctl_reset_event_args ) # macro
+# AMDKFD_IOC_WAIT_EVENTS = _IOWR('K', nr, type) ( 0x0C , struct kfd_ioctl_wait_events_args ) # macro
+# AMDKFD_IOC_DBG_REGISTER_DEPRECATED = _IOW('K', nr, type) ( 0x0D , struct kfd_ioctl_dbg_register_args ) # macro
+# AMDKFD_IOC_DBG_UNREGISTER_DEPRECATED = _IOW('K', nr, type) ( 0x0E , struct kfd_ioctl_dbg_unregister_args ) # macro
+# AMDKFD_IOC_DBG_ADDRESS_WATCH_DEPRECATED = _IOW('K', nr, type) ( 0x0F , struct kfd_ioctl_dbg_address_watch_args ) # macro
+# AMDKFD_IOC_DBG_WAVE_CONTROL_DEPRECATED = _IOW('K', nr, type) ( 0x10 , struct kfd_ioctl_dbg_wave_control_args ) # macro
+# AMDKFD_IOC_SET_SCRATCH_BACKING_VA = _IOWR('K', nr, type) ( 0x11 , struct kfd_ioctl_set_scratch_backing_va_args ) # macro
+# AMDKFD_IOC_GET_TILE_CONFIG = _IOWR('K', nr, type) ( 0x12 , struct kfd_ioctl_get_tile_config_args ) # macro
+# AMDKFD_IOC_SET_TRAP_HANDLER = _IOW('K', nr, type) ( 0x13 , struct kfd_ioctl_set_trap_handler_args ) # macro
+# AMDKFD_IOC_GET_PROCESS_APERTURES_NEW = _IOWR('K', nr, type) ( 0x14 , struct kfd_ioctl_get_process_apertures_new_args ) # macro
+# AMDKFD_IOC_ACQUIRE_VM = _IOW('K', nr, type) ( 0x15 , struct kfd_ioctl_acquire_vm_args ) # macro
+# AMDKFD_IOC_ALLOC_MEMORY_OF_GPU = _IOWR('K', nr, type) ( 0x16 , struct kfd_ioctl_alloc_memory_of_gpu_args ) # macro
+# AMDKFD_IOC_FREE_MEMORY_OF_GPU = _IOW('K', nr, type) ( 0x17 , struct kfd_ioctl_free_memory_of_gpu_args ) # macro
+# AMDKFD_IOC_MAP_MEMORY_TO_GPU = _IOWR('K', nr, type) ( 0x18 , struct kfd_ioctl_map_memory_to_gpu_args ) # macro
+# AMDKFD_IOC_UNMAP_MEMORY_FROM_GPU = _IOWR('K', nr, type) ( 0x19 , struct kfd_ioctl_unmap_memory_from_gpu_args ) # macro
+# AMDKFD_IOC_SET_CU_MASK = _IOW('K', nr, type) ( 0x1A , struct kfd_ioctl_set_cu_mask_args ) # macro
+# AMDKFD_IOC_GET_QUEUE_WAVE_STATE = _IOWR('K', nr, type) ( 0x1B , struct kfd_ioctl_get_queue_wave_state_args ) # macro
+# AMDKFD_IOC_GET_DMABUF_INFO = _IOWR('K', nr, type) ( 0x1C , struct kfd_ioctl_get_dmabuf_info_args ) # macro
+# AMDKFD_IOC_IMPORT_DMABUF = _IOWR('K', nr, type) ( 0x1D , struct kfd_ioctl_import_dmabuf_args ) # macro
+# AMDKFD_IOC_ALLOC_QUEUE_GWS = _IOWR('K', nr, type) ( 0x1E , struct kfd_ioctl_alloc_queue_gws_args ) # macro
+# AMDKFD_IOC_SMI_EVENTS = _IOWR('K', nr, type) ( 0x1F , struct kfd_ioctl_smi_events_args ) # macro
+# AMDKFD_IOC_SVM = _IOWR('K', nr, type) ( 0x20 , struct kfd_ioctl_svm_args ) # macro
+# AMDKFD_IOC_SET_XNACK_MODE = _IOWR('K', nr, type) ( 0x21 , struct kfd_ioctl_set_xnack_mode_args ) # macro
+# AMDKFD_IOC_CRIU_OP = _IOWR('K', nr, type) ( 0x22 , struct kfd_ioctl_criu_args ) # macro
+# AMDKFD_IOC_AVAILABLE_MEMORY = _IOWR('K', nr, type) ( 0x23 , struct kfd_ioctl_get_available_memory_args ) # macro
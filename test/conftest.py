@@ -0,0 +1,109 @@
+import importlib, importlib.util, pathlib, sys, types
+import pytest
+
+AUTOGEN_MODULES = ["kfd", "hsa", "amd_gpu"]
+AUTOGEN_STUBS = pathlib.Path(__file__).parent / "autogen"
+
+# the stand-ins are loaded below, not collected as tests
+collect_ignore = ["autogen"]
+
+
+def load_autogen_stubs():
+    """
+    Loads the test stand-ins for the bindings autogen_stubs.sh did not generate.
+
+    Generated files always win, so the tests run against the real headers
+    wherever they exist. Returns the names that were stubbed.
+    """
+    parent = importlib.import_module("fuzzyHSA.kfd")
+    package_dir = pathlib.Path(parent.__file__).parent / "autogen"
+    missing = [n for n in AUTOGEN_MODULES if not (package_dir / f"{n}.py").exists()]
+    if not missing:
+        return missing
+    if package_dir.is_dir():
+        package = importlib.import_module("fuzzyHSA.kfd.autogen")
+    else:
+        package = types.ModuleType("fuzzyHSA.kfd.autogen")
+        package.__path__ = []
+        sys.modules[package.__name__] = package
+        parent.autogen = package
+    for name in missing:
+        fullname = f"{package.__name__}.{name}"
+        path = AUTOGEN_STUBS / f"{name}.py"
+        spec = importlib.util.spec_from_file_location(fullname, path)
+        module = importlib.util.module_from_spec(spec)
+        sys.modules[fullname] = module
+        spec.loader.exec_module(module)
+        setattr(package, name, module)
+    return missing
+
+
+STUBBED = load_autogen_stubs()
+
+
+@pytest.fixture
+def generated_bindings():
+    """Skips tests that need the generated bindings themselves, like the CLI's startup check."""
+    if STUBBED:
+        pytest.skip(f"{', '.join(STUBBED)} not generated, run autogen_stubs.sh")
+
+
+def write_topology(root: pathlib.Path, nodes):
+    """
+    Writes a fake KFD topology ``nodes`` tree.
+
+    ``nodes`` maps node ids to dicts with ``properties``, an optional ``gpu_id``
+    (0 or missing for CPU nodes), and optional ``io_links``, ``mem_banks`` and
+    ``caches`` lists of property dicts.
+    """
+    root.mkdir(parents=True, exist_ok=True)
+    for node_id, node in nodes.items():
+        node_dir = root / str(node_id)
+        node_dir.mkdir()
+        (node_dir / "gpu_id").write_text(f"{node.get('gpu_id', 0)}\n")
+        (node_dir / "name").write_text(f"{node.get('name', '')}\n")
+        (node_dir / "properties").write_text(
+            "".join(f"{k} {v}\n" for k, v in node["properties"].items())
+        )
+        for kind in ("io_links", "mem_banks", "caches"):
+            (node_dir / kind).mkdir()
+            for i, props in enumerate(node.get(kind, [])):
+                (node_dir / kind / str(i)).mkdir()
+                (node_dir / kind / str(i) / "properties").write_text(
+                    "".join(f"{k} {v}\n" for k, v in props.items())
+                )
+    return root
+
+
+def cpu_node(cores=16):
+    return {"properties": {"cpu_cores_count": cores, "simd_count": 0}}
+
+
+def gpu_node(gpu_id, links, render_minor=128, target=110000):
+    return {
+        "gpu_id": gpu_id,
+        "properties": {
+            "cpu_cores_count": 0,
+            "simd_count": 256,
+            "drm_render_minor": render_minor,
+            "gfx_target_version": target,
+        },
+        "io_links": [
+            {"type": 2, "node_from": -1, "node_to": to, "weight": weight}
+            for to, weight in links
+        ],
+    }
+
+
+@pytest.fixture
+def dual_socket_topology(tmp_path):
+    """Two CPU sockets with one GPU behind each, the second linked to socket 1."""
+    return write_topology(
+        tmp_path / "nodes",
+        {
+            0: cpu_node(),
+            1: cpu_node(),
+            2: gpu_node(0x1111, [(0, 20), (1, 41)], render_minor=128),
+            3: gpu_node(0x2222, [(0, 41), (1, 20)], render_minor=129),
+        },
+    )
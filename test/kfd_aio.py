@@ -0,0 +1,120 @@
+import asyncio, mmap, time
+import pytest
+from fuzzyHSA.kfd.aio import AsyncKFDDevice
+from fuzzyHSA.kfd.emulated import EmulatedKFD, EmulatedKFDDevice, emulated_context
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+LATENCY = 0.05
+GTT = {
+    "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+    "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+    "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT,
+}
+
+
+def slow_device() -> EmulatedKFDDevice:
+    latency = {"alloc_memory_of_gpu": LATENCY, "free_memory_of_gpu": LATENCY}
+    return EmulatedKFDDevice(context=emulated_context(ioctls=EmulatedKFD(latency)))
+
+
+async def max_loop_gap(work) -> float:
+    """Runs ``work`` while a ticker measures the longest stall of the event loop."""
+    gaps, done = [0.0], asyncio.Event()
+
+    async def ticker():
+        last = time.perf_counter()
+        while not done.is_set():
+            await asyncio.sleep(0.001)
+            now = time.perf_counter()
+            gaps.append(now - last)
+            last = now
+
+    task = asyncio.create_task(ticker())
+    await work
+    done.set()
+    await task
+    return max(gaps)
+
+
+class TestAsyncKFDDevice:
+    def test_ioctls_do_not_stall_the_loop(self):
+        async def main():
+            async with AsyncKFDDevice(slow_device(), owns_device=True) as device:
+
+                async def allocate_and_free():
+                    mems = [await device.allocate_memory(4096, GTT) for _ in range(4)]
+                    await asyncio.gather(*(device.free_gpu_memory(m) for m in mems))
+                    return len(device.context.allocations)
+
+                start = time.perf_counter()
+                gap = await max_loop_gap(allocate_and_free())
+                return gap, time.perf_counter() - start
+
+        gap, elapsed = asyncio.run(main())
+
+        assert elapsed >= 8 * LATENCY  # one ioctl thread keeps the calls serialized
+        assert gap < LATENCY / 2
+
+    def test_wait_event_and_async_with_cleanup(self):
+        async def main():
+            async with EmulatedKFDDevice() as device:
+                event = await device.create_event(auto_reset=False)
+                waiting = asyncio.ensure_future(device.wait_event(event.event_id))
+                await asyncio.sleep(0.01)
+                assert not waiting.done()
+                device.set_event(event.event_id)
+                fired = await asyncio.wait_for(waiting, 1)
+                with pytest.raises(asyncio.TimeoutError):
+                    await device.wait_event(event.event_id, lambda: False, timeout=0.01)
+                await device.destroy_event(event.event_id)
+                return fired, event.event_id, device.device
+
+        fired, event_id, device = asyncio.run(main())
+
+        assert fired == event_id
+        assert device.context is None
+
+    def test_wait_event_again_after_timeout(self):
+        async def main():
+            async with EmulatedKFDDevice() as device:
+                event = await device.create_event(auto_reset=False)
+                with pytest.raises(asyncio.TimeoutError):
+                    await device.wait_event(event.event_id, timeout=0.01)
+                await asyncio.sleep(0.01)
+                assert len(device._waiter) == 0  # the timed out watch was dropped
+                device.set_event(event.event_id)
+                fired = await device.wait_event(event.event_id, timeout=1)
+                other = await device.create_event(auto_reset=False)
+                device.set_event(other.event_id)
+                later = await device.wait_event(other.event_id, timeout=1)
+                alive = device._waiter._thread.is_alive()
+                await device.destroy_event(event.event_id)
+                await device.destroy_event(other.event_id)
+                return (fired, later, alive), (event.event_id, other.event_id, True)
+
+        got, expected = asyncio.run(main())
+
+        assert got == expected
+
+    def test_submit_retries_until_ring_space(self):
+        async def main():
+            async with EmulatedKFDDevice() as device:
+                queue = await device.create_queue(
+                    kfd.KFD_IOC_QUEUE_TYPE_SDMA, ring_size=0x1000
+                )
+                stream = bytes(0x800)
+                await device.submit(queue, stream)
+                await device.submit(queue, stream)
+                retry = asyncio.ensure_future(device.submit(queue, stream))
+                await asyncio.sleep(0.01)
+                assert not retry.done()
+                queue.read_pointer.value = 0x800  # the engine consumed the first stream
+                start = await asyncio.wait_for(retry, 1)
+                with pytest.raises(TimeoutError):
+                    await device.submit(queue, stream, timeout=0.01)
+                await device.destroy_queue(queue)
+                return start, len(device.context.allocations)
+
+        start, allocations = asyncio.run(main())
+
+        assert start == 0x1000 and allocations == 0
@@ -0,0 +1,133 @@
+import ctypes
+import pytest
+from fuzzyHSA.kfd import aql
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.queues import QueuePool, cwsr_sizes
+import fuzzyHSA.kfd.autogen.hsa as hsa  # importing generated files via the fuzzyHSA package
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+AQL = kfd.KFD_IOC_QUEUE_TYPE_COMPUTE_AQL
+
+
+class HostQueue:
+    """An AQL ring, amd_queue_t and doorbell in plain host memory."""
+
+    def __init__(self, slots=8):
+        self.ring = (ctypes.c_uint8 * (slots * aql.AQL_PACKET_SIZE))()
+        self.amd_queue = hsa.amd_queue_t()
+        self.doorbell = ctypes.c_uint64()
+        aql.invalidate_ring(ctypes.addressof(self.ring), len(self.ring))
+        base = ctypes.addressof(self.amd_queue)
+        self.writer = aql.AQLRingWriter(
+            ctypes.addressof(self.ring),
+            len(self.ring),
+            base + hsa.amd_queue_t.write_dispatch_id.offset,
+            base + hsa.amd_queue_t.read_dispatch_id.offset,
+            ctypes.addressof(self.doorbell),
+        )
+
+    def packet(self, index):
+        offset = index * aql.AQL_PACKET_SIZE
+        return hsa.hsa_barrier_and_packet_t.from_buffer(self.ring, offset)
+
+
+class TestAQLRingWriter:
+    def test_batch_rings_doorbell_once(self):
+        q = HostQueue()
+
+        first = q.writer.submit([aql.barrier_and_packet(i + 1) for i in range(3)])
+
+        assert first == 0 and q.amd_queue.write_dispatch_id == 3
+        assert q.doorbell.value == 2 and q.writer.doorbell_writes == 1
+        assert [q.packet(i).completion_signal.handle for i in range(4)] == [1, 2, 3, 0]
+        assert q.packet(0).header >> hsa.HSA_PACKET_HEADER_TYPE & 0xFF == (
+            hsa.HSA_PACKET_TYPE_BARRIER_AND
+        )
+        assert q.packet(3).header == aql.INVALID_HEADER
+
+    def test_headers_pointer_and_doorbell_are_release_stores(self):
+        q = HostQueue()
+        stores = []
+
+        class RecordingAtomics:
+            def store(self, addr, value):
+                stores.append(addr)
+                ctypes.c_int64.from_address(addr).value = value
+
+        q.writer.atomics = RecordingAtomics()
+        q.writer.submit([aql.barrier_and_packet(1), aql.barrier_and_packet(2)])
+
+        base = ctypes.addressof(q.amd_queue)
+        assert stores == [
+            ctypes.addressof(q.ring),
+            ctypes.addressof(q.ring) + aql.AQL_PACKET_SIZE,
+            base + hsa.amd_queue_t.write_dispatch_id.offset,
+            ctypes.addressof(q.doorbell),
+        ]
+
+    def test_wraps_after_consumption(self):
+        q = HostQueue(slots=4)
+        q.writer.submit([aql.barrier_and_packet(i) for i in range(4)])
+        q.amd_queue.read_dispatch_id = 2
+
+        q.writer.submit([aql.barrier_and_packet(10), aql.barrier_and_packet(11)])
+
+        assert [q.packet(i).completion_signal.handle for i in range(4)] == [
+            10,
+            11,
+            2,
+            3,
+        ]
+        assert q.doorbell.value == 5 and q.writer.doorbell_writes == 2
+
+    def test_full_ring_times_out(self):
+        q = HostQueue(slots=2)
+        q.writer.submit([aql.barrier_and_packet(), aql.barrier_and_packet()])
+
+        with pytest.raises(TimeoutError):
+            q.writer.submit([aql.barrier_and_packet()], timeout=0.01)
+
+
+class TestComputeQueue:
+    def test_create_queue_on_emulated_device(self):
+        with EmulatedKFDDevice() as device:
+            queue = device.create_queue()
+            gart = queue.gart.va_addr
+
+            assert queue.queue_type == AQL
+            assert queue.args.write_pointer_address == gart + 56
+            assert queue.args.read_pointer_address == gart + 128
+            assert queue.args.eop_buffer_address == queue.buffers["eop"].va_addr
+            assert queue.args.ctx_save_restore_size == 0x2C02000
+
+            writer = queue.ring_writer()
+            writer.submit([aql.barrier_and_packet(7)] * 2)
+            assert ctypes.c_uint64.from_address(queue.doorbell).value == 1
+
+            queue.destroy()
+            assert len(device.context.allocations) == 0
+
+    def test_pooled_compute_queue_is_invalidated(self):
+        with EmulatedKFDDevice() as device, QueuePool(device, {AQL: 1}) as pool:
+            with pool.lease(AQL) as first:
+                first.ring_writer().submit([aql.barrier_and_packet()])
+                first.read_pointer.value = 1  # the packet processor consumed it
+            with pool.lease(AQL) as queue:
+                header = ctypes.c_uint16.from_address(queue.ring.va_addr).value
+
+                assert queue is first and header == aql.INVALID_HEADER
+                assert queue.write_pointer.value == 1
+
+    def test_cwsr_sizes_follow_cu_count(self):
+        small, _ = cwsr_sizes({"simd_count": 32, "simd_per_cu": 4})
+        large, ctl_stack = cwsr_sizes({"simd_count": 440, "simd_per_cu": 4})
+
+        assert small < large and ctl_stack % 4096 == 0
+
+    def test_cwsr_sizes_follow_gfx_version_and_kernel(self):
+        gfx9 = {"simd_count": 440, "simd_per_cu": 4, "gfx_target_version": 90010}
+        gfx11 = {**gfx9, "gfx_target_version": 110000}
+
+        assert cwsr_sizes(gfx9)[1] < cwsr_sizes(gfx11)[1]
+        kernel = {**gfx11, "cwsr_size": 0x1234000, "ctl_stack_size": 0x5000}
+        assert cwsr_sizes(kernel) == (0x1234000, 0x5000)
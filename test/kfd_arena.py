@@ -0,0 +1,127 @@
+import mmap
+import pytest
+from fuzzyHSA.kfd.arena import coalesce
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+GTT = {
+    "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+    "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+    "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT,
+}
+SDMA = kfd.KFD_IOC_QUEUE_TYPE_SDMA
+
+
+def teardown_calls(device, start):
+    return [name for name, _ in device.KFD_IOCTL.calls[start:]]
+
+
+class TestArena:
+    def test_teardown_in_dependency_order(self):
+        with EmulatedKFDDevice() as device:
+            outer = device.allocate_memory(4096, GTT)
+            with device.arena() as arena:
+                queue = device.create_queue(SDMA, ring_size=0x1000)
+                event = device.create_event(auto_reset=False)
+                mems = [
+                    device.allocate_memory(4096, GTT, map_to_gpu=True) for _ in range(3)
+                ]
+                device.map_memory_to_gpu(outer)
+                start = len(device.KFD_IOCTL.calls)
+
+            calls = teardown_calls(device, start)
+            assert calls == [
+                "destroy_queue",
+                "destroy_event",
+                "unmap_memory_from_gpu",  # the outer allocation's mapping
+                *["unmap_memory_from_gpu"] * 5,  # ring, pointer page and mems
+                *["free_memory_of_gpu"] * 5,
+            ]
+            assert (
+                outer.mapped_gpu_ids == []
+                and outer.handle in device.context.allocations
+            )
+            assert list(device.context.allocations.handles()) == [
+                outer.handle,
+                device.event_page.handle,
+            ]
+            assert not device.KFD_IOCTL.queues and not device.KFD_IOCTL.events
+            assert not arena.allocations and not device._arenas
+            device.free_gpu_memory(outer)
+
+    def test_explicit_releases_are_forgotten(self):
+        with EmulatedKFDDevice() as device:
+            with device.arena():
+                queue = device.create_queue(SDMA, ring_size=0x1000)
+                mem = device.allocate_memory(4096, GTT, map_to_gpu=True)
+                kept = device.allocate_memory(4096, GTT)
+                with device.arena():
+                    inner = device.allocate_memory(4096, GTT)
+                    event = device.create_event()
+                    device.destroy_event(event.event_id)
+                assert inner.handle not in device.context.allocations
+                queue.destroy()
+                device.free_gpu_memory(mem)
+                start = len(device.KFD_IOCTL.calls)
+
+            assert teardown_calls(device, start) == ["free_memory_of_gpu"]
+            assert kept.handle not in device.context.allocations
+
+    def test_teardown_continues_past_failures(self):
+        with EmulatedKFDDevice() as device:
+            with pytest.raises(OSError):
+                with device.arena() as arena:
+                    device.allocate_memory(4096, GTT, map_to_gpu=True)
+                    arena.defer(lambda: device.destroy_event(12345))
+
+            assert len(device.context.allocations) == 0
+
+    def test_failed_unmap_keeps_allocation_recorded(self, monkeypatch):
+        with EmulatedKFDDevice() as device:
+            unmap = device.KFD_IOCTL.unmap_memory_from_gpu
+
+            def failing_unmap(fd, **kwargs):
+                result = unmap(fd, **kwargs)
+                result.n_success = 0
+                return result
+
+            with pytest.raises(OSError):
+                with device.arena():
+                    mem = device.allocate_memory(4096, GTT, map_to_gpu=True)
+                    monkeypatch.setattr(
+                        device.KFD_IOCTL, "unmap_memory_from_gpu", failing_unmap
+                    )
+
+            assert "free_memory_of_gpu" not in device.KFD_IOCTL.call_names()
+            assert mem.handle in device.context.allocations
+            monkeypatch.undo()
+            device.free_gpu_memory(mem)
+
+    def test_arena_frees_what_a_failed_free_left(self, monkeypatch):
+        with EmulatedKFDDevice() as device:
+            free = device.KFD_IOCTL.free_memory_of_gpu
+
+            def failing_free(fd, **kwargs):
+                monkeypatch.setattr(device.KFD_IOCTL, "free_memory_of_gpu", free)
+                raise OSError("free_memory_of_gpu failed")
+
+            with device.arena():
+                mem = device.allocate_memory(4096, GTT, map_to_gpu=True)
+                monkeypatch.setattr(
+                    device.KFD_IOCTL, "free_memory_of_gpu", failing_free
+                )
+                with pytest.raises(OSError):
+                    device.free_gpu_memory(mem)
+                assert mem.handle in device.context.allocations
+
+            assert len(device.context.allocations) == 0
+
+    def test_adjacent_host_ranges_share_one_munmap(self):
+        page = mmap.PAGESIZE
+        ranges = [(5 * page, page), (page, 100), (2 * page, 2 * page), (9 * page, page)]
+
+        assert coalesce(ranges) == [
+            (page, 3 * page),
+            (5 * page, page),
+            (9 * page, page),
+        ]
@@ -0,0 +1,88 @@
+import os
+import pytest
+from fuzzyHSA.kfd.context import KFDContext
+from fuzzyHSA.kfd.emulated import EmulatedKFD, EmulatedKFDDevice, emulated_context
+from fuzzyHSA.kfd.topology import Topology
+
+
+def open_null() -> int:
+    return os.open(os.devnull, os.O_RDWR | os.O_CLOEXEC)
+
+
+@pytest.fixture
+def context(dual_socket_topology):
+    return KFDContext(Topology.parse(dual_socket_topology), open_null, EmulatedKFD())
+
+
+class TestKFDContext:
+    def test_devices_share_context_until_last_close(self):
+        context = emulated_context()
+        a = EmulatedKFDDevice(0x1000, context=context)
+        b = EmulatedKFDDevice(0x2000, context=context)
+        a.event_page = "page"
+
+        assert context.refcount == 2 and b.event_page == "page"
+        assert a.KFD_IOCTL is b.KFD_IOCTL
+        a.close()
+        a.close()
+        assert context.refcount == 1 and not context.closed
+        b.close()
+        assert context.closed
+
+    def test_release_closes_fd(self, context):
+        fd = context.acquire().kfd
+        context.release()
+
+        assert context.closed
+        with pytest.raises(OSError):
+            os.fstat(fd)
+        with pytest.raises(RuntimeError):
+            context.acquire()
+
+    def test_duplicate_opens_independent_fd(self, context):
+        other = context.duplicate()
+
+        assert other.kfd != context.kfd
+        assert other.topology is context.topology
+        other.close()
+        assert not context.closed
+
+    def test_fork_child_reopens(self, context):
+        context.event_page = "parent page"
+        parent_fd = context.kfd
+        read_end, write_end = os.pipe()
+        pid = os.fork()
+        if pid == 0:
+            ok = (
+                KFDContext._default is None
+                and context.kfd >= 0
+                and context.event_page is None
+            )
+            os.write(write_end, b"1" if ok else b"0")
+            os._exit(0)
+        os.waitpid(pid, 0)
+
+        assert os.read(read_end, 1) == b"1"
+        assert context.kfd == parent_fd and context.event_page == "parent page"
+        context.close()
+
+    def test_fork_child_resets_devices(self):
+        device = EmulatedKFDDevice(0x1000)
+        doorbell = device.map_doorbell(8)
+        device.hdp_flusher()
+        read_end, write_end = os.pipe()
+        pid = os.fork()
+        if pid == 0:
+            ok = (
+                device._doorbell_page is None
+                and device._mmio_page is None
+                and device.context.vms == {0x1000}
+                and device.map_doorbell(8) > 0
+            )
+            os.write(write_end, b"1" if ok else b"0")
+            os._exit(0)
+        os.waitpid(pid, 0)
+
+        assert os.read(read_end, 1) == b"1"
+        assert device.map_doorbell(8) == doorbell and device._mmio_page is not None
+        device.close()
@@ -0,0 +1,111 @@
+import struct
+import time
+import pytest
+from fuzzyHSA.kfd import decoder, sdma
+import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu  # importing generated files via the fuzzyHSA package
+
+PKTS = sdma.SDMA_PKTS
+
+
+@pytest.fixture
+def sdma_ring():
+    """A 256-byte SDMA ring that wrapped: a fence and trap at the start, copies at the end."""
+    ring = bytearray(256)
+    head = sdma.SDMAStream()
+    head.fence([0x9000], [3])
+    head.trap(int_context=1)
+    ring[: head.nbytes] = head.dwords.tobytes()
+    tail = sdma.SDMAStream()
+    tail.copy_linear([0x2000, 0x3000], [0x1000, 0x1000], [64, 128])
+    # 56 bytes of copies, then 64 bytes of NOP padding up to the end
+    ring[136 : 136 + tail.nbytes] = tail.dwords.tobytes()
+    return ring, 136, 256 + head.nbytes
+
+
+@pytest.fixture
+def pm4_ring():
+    dwords = [
+        amd_gpu.PACKET3(amd_gpu.PACKET3_WRITE_DATA, 3),
+        0x500,
+        0x8000,
+        0,
+        42,
+        0x80000000,  # type 2 filler
+        amd_gpu.PACKET3(0xEE, 0),
+        0xDEAD,
+        amd_gpu.PACKET3(amd_gpu.PACKET3_RELEASE_MEM, 5),
+    ]
+    return struct.pack(f"<{len(dwords)}I", *dwords) + bytes(
+        20
+    )  # cut inside RELEASE_MEM
+
+
+class TestSDMADecoder:
+    def test_wrapped_window(self, sdma_ring):
+        ring, rptr, wptr = sdma_ring
+
+        decoded = decoder.decode_ring(ring, rptr, wptr)
+
+        assert [(r.offset, r.name, r.dwords) for r in decoded] == [
+            (136, "copy_linear", 7),
+            (164, "copy_linear", 7),
+            (192, "nop", 16),
+            (0, "fence", 4),
+            (16, "trap", 2),
+        ]
+        assert decoded.at(170) is decoded[1] and decoded.at(20) is decoded[4]
+        assert decoded.at(100) is None
+        copy = decoded.fields(decoded[1])
+        assert (copy["src_addr"], copy["dst_addr"], copy["count"]) == (
+            0x1000,
+            0x3000,
+            127,
+        )
+        assert decoded.fields(decoded[3])["data"] == 3
+
+    def test_unknown_and_truncated_packets(self):
+        fence = bytes(PKTS.fence(op=amd_gpu.SDMA_OP_FENCE, addr=0x40, data=1))
+        data = struct.pack("<I", 0xFF) + bytes(PKTS.poll_regmem(op=8, hdp_flush=1))
+
+        decoded = decoder.decode(data + fence[:8])
+
+        assert [(r.name, r.dwords, r.complete) for r in decoded] == [
+            ("unknown", 1, True),
+            ("hdp_flush", 6, True),
+            ("fence", 2, False),
+        ]
+        assert "(truncated)" in decoded.format().splitlines()[-1]
+
+    def test_megabyte_ring_is_scanned_quickly(self):
+        stream = sdma.SDMAStream()
+        count = (1 << 20) // (4 * sdma.COPY_LINEAR_DWORDS)
+        stream.copy_linear(range(count), range(count), [64] * count)
+        data = stream.dwords.tobytes()
+
+        start = time.perf_counter()
+        decoded = decoder.decode(data)
+        elapsed = time.perf_counter() - start
+
+        assert len(decoded) == count and decoded[-1].name == "copy_linear"
+        assert elapsed < 1.0
+
+
+class TestPM4Decoder:
+    def test_headers(self, pm4_ring):
+        decoded = decoder.decode(pm4_ring, "pm4")
+
+        assert [(r.offset, r.name, r.dwords) for r in decoded] == [
+            (0, "write_data", 5),
+            (20, "type2", 1),
+            (24, "packet3_0xee", 2),
+            (32, "release_mem", 6),
+        ]
+        assert decoded.fields(decoded[0])["payload"] == [0x500, 0x8000, 0, 42]
+        assert not decoded[-1].complete
+
+    def test_window_without_wrap(self, pm4_ring):
+        ring = pm4_ring + bytes(64 - len(pm4_ring))
+
+        decoded = decoder.decode_ring(ring, 64 + 20, 64 + 32, "pm4")
+
+        assert [r.name for r in decoded] == ["type2", "packet3_0xee"]
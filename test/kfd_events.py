@@ -0,0 +1,137 @@
+import ctypes
+import threading
+import time
+import pytest
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.events import EventPool, EventWaiter
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+
+class TestEvents:
+    def test_first_event_registers_the_event_page(self):
+        with EmulatedKFDDevice() as device:
+            a = device.create_event()
+            b = device.create_event(auto_reset=False)
+
+            calls = device.KFD_IOCTL.calls
+            offsets = [
+                args["event_page_offset"]
+                for name, args in calls
+                if name == "create_event"
+            ]
+            assert offsets == [device.event_page.handle, 0]
+            assert (a.event_id, b.event_id) == (0, 1) and b.event_slot_index == 1
+
+    def test_set_reset_and_wait(self):
+        with EmulatedKFDDevice() as device:
+            auto = device.create_event().event_id
+            manual = device.create_event(auto_reset=False).event_id
+            device.set_event(auto)
+            device.set_event(manual)
+
+            first = device.wait_events([auto, manual], wait_for_all=True, timeout_ms=0)
+            again = device.wait_events([auto], timeout_ms=0)
+            still = device.wait_events([manual], timeout_ms=0)
+            device.reset_event(manual)
+
+            assert first == still == kfd.KFD_IOC_WAIT_RESULT_COMPLETE
+            assert again == kfd.KFD_IOC_WAIT_RESULT_TIMEOUT
+            assert device.wait_events([manual], timeout_ms=0) == again
+
+    def test_pool_reuses_reset_events(self):
+        with EmulatedKFDDevice() as device:
+            with EventPool(device, 2) as pool:
+                event = pool.acquire()
+                device.set_event(event.event_id)
+                pool.release(event)
+                events = [pool.acquire() for _ in range(3)]
+
+                assert event in events and len(pool) == 3
+                assert not device.KFD_IOCTL.events[event.event_id]["signaled"]
+            assert device.KFD_IOCTL.events == {}
+
+
+class TestEventWaiter:
+    def test_many_events_complete_futures(self):
+        with EmulatedKFDDevice() as device, EventPool(device, 200) as pool:
+            events = [pool.acquire() for _ in range(200)]
+            with EventWaiter(device) as waiter:
+                futures = [waiter.watch(e.event_id) for e in events]
+                setter = threading.Thread(
+                    target=lambda: [device.set_event(e.event_id) for e in events]
+                )
+                setter.start()
+
+                done = [f.result(timeout=5) for f in futures]
+                setter.join()
+
+                assert done == [e.event_id for e in events] and len(waiter) == 0
+
+    def test_check_decides_completion(self):
+        fence = ctypes.c_uint64(0)
+        with EmulatedKFDDevice() as device, EventPool(device, 1, True) as pool:
+            event = pool.acquire()
+            with EventWaiter(device, timeout_ms=10) as waiter:
+                future = waiter.watch(event.event_id, check=lambda: fence.value >= 2)
+                fence.value = 1
+                device.set_event(event.event_id)
+                with pytest.raises(TimeoutError):
+                    future.result(timeout=0.05)
+
+                fence.value = 2
+                device.set_event(event.event_id)
+
+                assert future.result(timeout=5) == event.event_id
+
+    def test_signaled_manual_reset_event_is_rearmed(self):
+        fence = ctypes.c_uint64(0)
+        with EmulatedKFDDevice() as device, EventPool(device, 1) as pool:
+            event = pool.acquire()
+            with EventWaiter(device) as waiter:
+                future = waiter.watch(event.event_id, check=lambda: fence.value >= 1)
+                device.set_event(event.event_id)
+                with pytest.raises(TimeoutError):
+                    future.result(timeout=0.2)
+
+                assert waiter.wakeups < 10  # no busy loop on the signaled event
+                assert not device.KFD_IOCTL.events[event.event_id]["signaled"]
+                fence.value = 1
+                device.set_event(event.event_id)
+                assert future.result(timeout=5) == event.event_id
+
+    def test_close_cancels_pending(self):
+        with EmulatedKFDDevice() as device, EventPool(device, 1) as pool:
+            waiter = EventWaiter(device)
+            future = waiter.watch(pool.acquire().event_id)
+
+            waiter.close()
+
+            assert future.cancelled() and len(device.KFD_IOCTL.events) == 1
+
+    def test_repeated_errors_back_off(self, monkeypatch):
+        with EmulatedKFDDevice() as device:
+            waiter = EventWaiter(device, timeout_ms=50)
+            calls = []
+
+            def failing_wait(events, timeout_ms):
+                calls.append(timeout_ms)
+                raise OSError("wait_events failed")
+
+            monkeypatch.setattr(device, "wait_events", failing_wait)
+            device.set_event(waiter._wake)
+            time.sleep(0.3)
+            monkeypatch.undo()
+            waiter.close()
+
+            assert 0 < len(calls) < 30
+
+    def test_closing_the_device_first_ends_the_thread(self):
+        device = EmulatedKFDDevice()
+        waiter = EventWaiter(device, timeout_ms=10)
+        future = waiter.watch(device.create_event(auto_reset=False).event_id)
+
+        device.close()
+        waiter._thread.join(timeout=5)
+
+        assert not waiter._thread.is_alive() and future.exception(timeout=5)
+        waiter.close()
@@ -0,0 +1,47 @@
+import ctypes, os, shutil
+import pytest
+from fuzzyHSA.kfd import hdp, vram
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+HAS_CC = bool(os.environ.get("CC") or shutil.which("cc"))
+
+
+class TestHDPFlush:
+    @pytest.mark.parametrize(
+        "use_native",
+        [
+            False,
+            pytest.param(
+                True, marks=pytest.mark.skipif(not HAS_CC, reason="no C compiler")
+            ),
+        ],
+    )
+    def test_flush_writes_mem_flush_register(self, use_native):
+        page = (ctypes.c_uint32 * 1024)()
+        flusher = hdp.HDPFlush(ctypes.addressof(page), use_native=use_native)
+
+        flusher.flush()
+
+        assert page[hdp.HDP_MEM_FLUSH_CNTL // 4] == 1
+        assert page[hdp.HDP_REG_FLUSH_CNTL // 4] == 0
+        assert flusher.flushes == 1 and (flusher._flush is not None) == use_native
+
+    def test_device_maps_mmio_remap_page_once(self):
+        device = EmulatedKFDDevice()
+        driver = device.KFD_IOCTL
+        with device.arena():
+            mem = device.allocate_memory(4096, vram.vram_config())
+            vram.upload(mem, b"data")
+            device.hdp_flush()
+        device.hdp_flush()
+
+        page = device._mmio_page
+        register = os.pread(driver.bo_file().fileno(), 4, page.mmap_offset)
+        assert page.flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_MMIO_REMAP and page.host_mapped
+        assert int.from_bytes(register, "little") == 1
+        assert driver.call_names().count("alloc_memory_of_gpu") == 2
+        assert list(driver.allocations) == [page.handle]
+        assert device.hdp_flusher().flushes == 2
+        device.close()
+        assert not driver.allocations
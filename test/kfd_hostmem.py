@@ -0,0 +1,44 @@
+import csv, io
+from fuzzyHSA import fuzzer
+from fuzzyHSA.bench import hostmem
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+
+
+class TestHostmemBench:
+    def test_anonymous_baseline_without_device(self):
+        rows = hostmem.run(size=1 << 16, repeat=1)
+
+        assert [r["name"] for r in rows] == ["anonymous"]
+        assert all(rows[0][c] is None or rows[0][c] > 0 for c in hostmem.COLUMNS)
+
+    def test_flag_combinations_on_emulated_device(self, monkeypatch):
+        combinations = hostmem.FLAG_COMBINATIONS[:2] + [("refused", 1 << 40)]
+        with EmulatedKFDDevice() as device:
+            allocate = device.allocate_memory
+
+            def refuse(size, config, **kwargs):
+                if config["kfd_flags"] & 1 << 40:
+                    raise RuntimeError(
+                        "IOCTL operation failed with system error: EINVAL"
+                    )
+                return allocate(size, config, **kwargs)
+
+            monkeypatch.setattr(device, "allocate_memory", refuse)
+            rows = hostmem.run(
+                device, size=1 << 16, repeat=1, combinations=combinations
+            )
+
+            assert len(device.context.allocations) == 0
+        table = list(csv.DictReader(io.StringIO(hostmem.format_csv(rows))))
+        assert [r["name"] for r in table] == ["anonymous", "gtt", "gtt_w", "refused"]
+        assert float(table[1]["seq_write"]) > 0 and table[1]["error"] == ""
+        assert "EINVAL" in table[3]["error"] and "error: IOCTL" in hostmem.format_table(
+            rows
+        )
+
+    def test_cli(self, capsys, generated_bindings):
+        fuzzer.main(["bench", "hostmem", "--size", "64K", "--repeat", "1", "--csv"])
+
+        out = capsys.readouterr().out
+        assert out.splitlines()[0].startswith("name,kfd_flags,seq_read")
+        assert fuzzer.parse_size("16M") == 16 << 20 and fuzzer.parse_size("123") == 123
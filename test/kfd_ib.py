@@ -0,0 +1,104 @@
+import ctypes
+import struct
+import pytest
+from fuzzyHSA.kfd import decoder, sdma
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.ib import IB_ALIGNMENT, IBChain, IBPool, pm4_indirect_buffer
+import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu  # importing generated files via the fuzzyHSA package
+
+
+def ib_bytes(ib):
+    return ctypes.string_at(ib.addr, ib.used)
+
+
+class TestIBChain:
+    def test_stream_is_split_at_packet_boundaries(self):
+        stream = sdma.SDMAStream()
+        stream.copy_linear(range(0, 640, 64), range(640, 1280, 64), [64] * 10)
+        with EmulatedKFDDevice() as device, IBPool(device, ib_size=128) as pool:
+            chain = IBChain(pool)
+            chain.append(stream)
+            ring_stream = chain.ring_stream()
+
+            contents = b"".join(ib_bytes(ib) for ib in chain.ibs)
+            copies = [r for r in decoder.decode(contents) if r.name == "copy_linear"]
+            assert [ib.used for ib in chain.ibs] == [128, 128, 64]
+            assert ib_bytes(chain.ibs[1])[:112] == stream.dwords.tobytes()[112:224]
+            assert len(copies) == 10
+
+            packets = decoder.decode(ring_stream)
+            indirects = [r for r in packets if r.name == "indirect"]
+            assert [r.offset % IB_ALIGNMENT for r in indirects] == [8] * 3
+            fields = [packets.fields(r) for r in indirects]
+            assert [(f["ib_base"], f["ib_size"]) for f in fields] == [
+                (ib.addr, ib.used // 4) for ib in chain.ibs
+            ]
+
+    def test_submit_aligns_and_rings_doorbell_once(self):
+        ring = (ctypes.c_uint8 * 256)()
+        pointers = (ctypes.c_uint64 * 3)()
+        base = ctypes.addressof(pointers)
+        writer = sdma.SDMARingWriter(
+            ctypes.addressof(ring), len(ring), base, base + 8, base + 16
+        )
+        writer.submit(b"\0" * 12)
+        with EmulatedKFDDevice() as device, IBPool(device) as pool:
+            chain = IBChain(pool)
+            chain.append(b"\0" * 40)
+
+            start = chain.submit(writer)
+
+            assert start == 32 and pointers[0] == 64
+            assert writer.doorbell_writes == 2
+            ib = chain.ibs[0]
+            chain.release()
+            assert pool.acquire() is ib and ib.used == 0
+
+    def test_pool_reuses_ibs_and_frees_blocks(self):
+        with EmulatedKFDDevice() as device:
+            pool = IBPool(device, ib_size=64, ibs_per_block=2)
+            fences = sdma.SDMAStream()
+            fences.fence([0x9000] * 12, range(12))
+            chain = IBChain(pool)
+            chain.append(fences)
+            first = [ib.addr for ib in chain.ibs]
+            chain.release()
+            chain.append(fences)
+
+            assert len(pool.blocks) == 2 and len(device.context.allocations) == 2
+            assert sorted(ib.addr for ib in chain.ibs) == sorted(first)
+            with pytest.raises(ValueError):  # a 21-dword NOP does not fit
+                IBChain(pool).append(struct.pack("<I", 20 << 16) + bytes(80))
+            pool.close()
+            assert len(device.context.allocations) == 0
+
+
+class TestPM4IndirectBuffer:
+    def test_packet_matches_nvd_h(self):
+        packet = pm4_indirect_buffer(0x1_2345_6788, 0x100, vmid=2)
+
+        # PACKET3(PACKET3_INDIRECT_BUFFER, 2) and INDIRECT_BUFFER_VALID (1 << 23)
+        assert struct.unpack("<4I", packet) == (
+            0xC0023F00,
+            0x23456788,
+            0x1,
+            0x40 | 0x800000 | 2 << 24,
+        )
+
+    def test_chain_packets(self):
+        header = amd_gpu.PACKET3(amd_gpu.PACKET3_WRITE_DATA, 3)
+        with EmulatedKFDDevice() as device, IBPool(device) as pool:
+            chain = IBChain(pool, "pm4", vmid=3)
+            chain.append(struct.pack("<5I", header, 0, 0x1000, 0, 1))
+
+            ib_packet = decoder.decode(chain.ring_stream(), "pm4")
+            payload = ib_packet.fields(ib_packet[0])["payload"]
+
+            assert [r.name for r in ib_packet] == ["indirect_buffer"]
+            assert payload == [
+                chain.ibs[0].addr & 0xFFFFFFFF,
+                chain.ibs[0].addr >> 32,
+                5 | 1 << 23 | 3 << 24,
+            ]
+            with pytest.raises(AssertionError):
+                chain.submit(None)
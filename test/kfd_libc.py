@@ -0,0 +1,57 @@
+import ctypes, errno, mmap
+import pytest
+from fuzzyHSA.kfd import libc
+from fuzzyHSA.kfd.ops import MemoryManager
+
+
+class TestLibcBinding:
+    def test_binding_is_shared(self):
+        assert MemoryManager().libc is MemoryManager().libc is libc.libc
+
+    def test_mmap_failure_reports_errno(self):
+        with pytest.raises(OSError) as info:
+            libc.mmap(0, mmap.PROT_READ, mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS)
+        assert info.value.errno == errno.EINVAL
+
+    def test_munmap_failure_reports_errno(self):
+        with pytest.raises(OSError) as info:
+            MemoryManager().munmap(1, mmap.PAGESIZE)  # unaligned address
+        assert info.value.errno == errno.EINVAL
+
+    def test_madvise_and_prefault(self):
+        manager = MemoryManager()
+        size = 64 * mmap.PAGESIZE
+        addr = manager.mmap(
+            size=size,
+            prot=mmap.PROT_READ | mmap.PROT_WRITE,
+            flags=mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+            fd=-1,
+            populate=True,
+        )
+        try:
+            manager.madvise(addr, size, libc.MADV_WILLNEED)
+            ctypes.memset(addr, 0x5A, size)
+            manager.madvise(addr, size, libc.MADV_DONTNEED)
+            assert (
+                ctypes.string_at(addr, 4) == b"\0\0\0\0"
+            )  # DONTNEED drops private pages
+            manager.prefault(addr, size)
+        finally:
+            manager.munmap(addr, size)
+
+    def test_prefault_matches_protection(self):
+        manager = MemoryManager()
+        size = 4 * mmap.PAGESIZE
+        for prot in (mmap.PROT_READ, 0):
+            addr = manager.mmap(
+                size=size, prot=prot, flags=mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS, fd=-1
+            )
+            try:
+                if prot:
+                    manager.prefault(addr, size, prot)
+                else:
+                    with pytest.raises(OSError) as info:
+                        manager.prefault(addr, size, prot)
+                    assert info.value.errno == errno.EACCES
+            finally:
+                manager.munmap(addr, size)
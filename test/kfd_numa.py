@@ -0,0 +1,90 @@
+import mmap, os
+import pytest
+from fuzzyHSA.kfd import numa
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+HAS_NODE0 = (numa.SYSFS_NUMA_NODES / "node0" / "cpulist").exists()
+
+
+class TestNUMAPlacement:
+    def test_nearest_cpu_node_follows_lowest_weight_link(self, dual_socket_topology):
+        assert numa.nearest_cpu_node(2, dual_socket_topology) == 0
+        assert numa.nearest_cpu_node(3, dual_socket_topology) == 1
+        assert numa.nearest_cpu_node(1, dual_socket_topology) == 1
+
+    def test_parse_cpulist(self, tmp_path):
+        (tmp_path / "node1").mkdir()
+        (tmp_path / "node1" / "cpulist").write_text("0-3,8,10-11\n")
+        assert numa.numa_cpus(1, tmp_path) == {0, 1, 2, 3, 8, 10, 11}
+
+    @pytest.mark.skipif(not HAS_NODE0, reason="no NUMA information in sysfs")
+    def test_pin_to_numa_node_restricts_affinity(self):
+        original = os.sched_getaffinity(0)
+        try:
+            cpus = numa.pin_to_numa_node(0)
+            assert cpus <= numa.numa_cpus(0)
+        finally:
+            os.sched_setaffinity(0, original)
+
+    @pytest.mark.skipif(not HAS_NODE0, reason="no NUMA information in sysfs")
+    def test_local_allocation_is_bound_userptr(self):
+        device = EmulatedKFDDevice(numa_node=0)
+        config = {
+            "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+            "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+            "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT,
+            "numa_node": "local",
+        }
+        mem = device.allocate_memory(16 * mmap.PAGESIZE, config)
+
+        assert mem.flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_USERPTR
+        assert not mem.flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT
+        assert mem.mmap_offset == mem.va_addr
+        try:
+            policy = numa.memory_policy(mem.va_addr)
+        except OSError as e:
+            pytest.skip(f"get_mempolicy unavailable: {e}")
+        finally:
+            device.free_gpu_memory(mem)
+        assert policy == (numa.MPOL_BIND, {0})
+
+    def test_numa_node_rejects_vram(self):
+        device = EmulatedKFDDevice(numa_node=0)
+        config = {
+            "mmap_prot": 0,
+            "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+            "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_VRAM,
+            "numa_node": 0,
+        }
+        with pytest.raises(ValueError):
+            device.allocate_memory(mmap.PAGESIZE, config)
+
+    def test_failed_placement_unmaps_the_range(self, monkeypatch):
+        device = EmulatedKFDDevice(numa_node=0)
+        config = {
+            "mmap_prot": 0,  # prefault refuses inaccessible ranges
+            "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+            "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT,
+            "numa_node": 0,
+        }
+        monkeypatch.setattr(numa, "bind_memory", lambda addr, size, nodes: None)
+        mapped, unmapped = [], []
+        mmap_, munmap = device.mmap, device.munmap
+
+        def recording_mmap(*args, **kwargs):
+            mapped.append(mmap_(*args, **kwargs))
+            return mapped[-1]
+
+        def recording_munmap(addr, size):
+            unmapped.append((addr, size))
+            munmap(addr, size)
+
+        monkeypatch.setattr(device, "mmap", recording_mmap)
+        monkeypatch.setattr(device, "munmap", recording_munmap)
+
+        with pytest.raises(OSError):
+            device.allocate_memory(mmap.PAGESIZE, config)
+
+        assert unmapped == [(mapped[0], mmap.PAGESIZE)]
+        assert len(device.context.allocations) == 0
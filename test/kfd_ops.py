@@ -101,7 +101,9 @@ class TestKFDDeviceHardwareIntegration:
         results = {}
         for name, operation in operations:
             try:
-                operation(kfd_device)
+                # the arena releases whatever the operation created
+                with kfd_device.arena() as arena:
+                    operation(kfd_device, arena)
                 results[name] = "Passed"
             except Exception as e:
                 results[name] = f"Failed with error: {str(e)}"
@@ -116,12 +118,12 @@ class TestKFDDeviceHardwareIntegration:
             )
             assert False, f"Some IOCTL operations failed:\n{error_messages}"
 
-    def _test_acquire_vm(self, kfd_device):
+    def _test_acquire_vm(self, kfd_device, arena):
         kfd_device.KFD_IOCTL.acquire_vm(
             kfd_device.kfd, drm_fd=kfd_device.drm_fd, gpu_id=kfd_device.gpu_id
         )
 
-    def _test_alloc_memory_of_gpu(self, kfd_device):
+    def _test_alloc_memory_of_gpu(self, kfd_device, arena):
         size = 0x1000
         addr_flags = mmap.MAP_SHARED | mmap.MAP_ANONYMOUS
 
@@ -136,8 +138,9 @@ class TestKFDDeviceHardwareIntegration:
             flags=flags,
             mmap_offset=0,
         )
+        arena.add_allocation(kfd_device.context.allocations.add(mem))
 
-    def _test_map_memory_to_gpu(self, kfd_device):
+    def _test_map_memory_to_gpu(self, kfd_device, arena):
         size = 0x1000
         addr_flags = mmap.MAP_SHARED | mmap.MAP_ANONYMOUS
 
@@ -152,6 +155,7 @@ class TestKFDDeviceHardwareIntegration:
             flags=flags,
             mmap_offset=0,
         )
+        arena.add_allocation(kfd_device.context.allocations.add(mem))
 
         mem.__setattr__(
             "mapped_gpu_ids", getattr(mem, "mapped_gpu_ids", []) + [kfd_device.gpu_id]
@@ -166,7 +170,7 @@ class TestKFDDeviceHardwareIntegration:
         )
         assert stm.n_success == len(mem.mapped_gpu_ids)
 
-    def _test_create_event(self, kfd_device):
+    def _test_create_event(self, kfd_device, arena):
         memory_flags_config = {
             "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
             "mmap_flags": mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
@@ -179,15 +183,16 @@ class TestKFDDeviceHardwareIntegration:
         }
 
         memory_size = 0x8000
-        KFDDevice.event_page = kfd_device.allocate_memory(
+        kfd_device.event_page = kfd_device.allocate_memory(
             memory_size, memory_flags_config, map_to_gpu=True
         )
         sync_event = kfd_device.KFD_IOCTL.create_event(
-            KFDDevice.kfd, event_page_offset=KFDDevice.event_page.handle, auto_reset=1
+            kfd_device.kfd, event_page_offset=kfd_device.event_page.handle, auto_reset=1
         )
         assert sync_event is not None, "Failed to create event."
+        arena.defer(lambda: kfd_device.destroy_event(sync_event.event_id))
 
-    def _test_create_queue(self, kfd_device):
+    def _test_create_queue(self, kfd_device, arena):
         """
         Test the functionality of creating a queue on the KFD device.
         """
@@ -222,7 +227,7 @@ class TestKFDDeviceHardwareIntegration:
         )
 
         sdma_queue = kfd_device.KFD_IOCTL.create_queue(
-            KFDDevice.kfd,
+            kfd_device.kfd,
             ring_base_address=sdma_ring.va_addr,
             ring_size=sdma_ring.size,
             gpu_id=kfd_device.gpu_id,
@@ -232,6 +237,11 @@ class TestKFDDeviceHardwareIntegration:
             write_pointer_address=gart_sdma.va_addr,
             read_pointer_address=gart_sdma.va_addr + 8,
         )
+        arena.defer(
+            lambda: kfd_device.KFD_IOCTL.destroy_queue(
+                kfd_device.kfd, queue_id=sdma_queue.queue_id
+            )
+        )
 
         try:
             assert sdma_queue.queue_id >= 0, "Queue ID should be a non-negative integer"
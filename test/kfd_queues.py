@@ -0,0 +1,77 @@
+import pytest
+from fuzzyHSA.bench import queue_pool
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.queues import QueuePool, create_sdma_queue
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+SDMA = kfd.KFD_IOC_QUEUE_TYPE_SDMA
+
+
+@pytest.fixture
+def emulated_device():
+    device = EmulatedKFDDevice()
+    yield device
+    device.close()
+
+
+class TestQueuePool:
+    def test_sdma_queue_layout(self, emulated_device):
+        queue = create_sdma_queue(emulated_device)
+
+        assert queue.queue_type == SDMA and queue.ring.size == 0x100000
+        assert queue.args.write_pointer_address == queue.gart.va_addr
+        assert queue.args.read_pointer_address == queue.gart.va_addr + 8
+        assert queue.ring.host_mapped and queue.gart.host_mapped
+        queue.destroy()
+        assert not emulated_device.KFD_IOCTL.queues
+        assert len(emulated_device.context.allocations) == 0
+
+    def test_idle_queues_are_reused_at_their_write_pointer(self, emulated_device):
+        with QueuePool(emulated_device, {SDMA: 2}) as pool:
+            for i in range(5):
+                with pool.lease(SDMA) as queue:
+                    assert queue.read_pointer.value == queue.write_pointer.value
+                    queue.write_pointer.value += 64
+                    queue.read_pointer.value += 64  # the engine consumed it
+
+            assert (pool.created, pool.reused, pool.discarded) == (2, 5, 0)
+            assert sum(q.write_pointer.value for q in pool._all) == 5 * 64
+        names = emulated_device.KFD_IOCTL.call_names()
+        assert names.count("create_queue") == names.count("destroy_queue") == 2
+        assert names.count("update_queue") == 0
+        assert len(emulated_device.context.allocations) == 0
+
+    def test_busy_queues_are_replaced(self, emulated_device):
+        with QueuePool(emulated_device, {SDMA: 1}) as pool:
+            with pool.lease(SDMA) as busy:
+                busy.write_pointer.value = 128
+            with pool.lease(SDMA) as queue:
+                assert queue is not busy and queue.write_pointer.value == 0
+
+            assert (pool.created, pool.discarded) == (2, 1)
+        names = emulated_device.KFD_IOCTL.call_names()
+        assert names.count("create_queue") == names.count("destroy_queue") == 2
+        assert len(emulated_device.context.allocations) == 0
+
+    def test_queues_created_inside_an_arena_outlive_it(self, emulated_device):
+        with QueuePool(emulated_device) as pool:
+            with emulated_device.arena():
+                with pool.lease(SDMA) as queue:
+                    queue.write_pointer.value += 64
+                    queue.read_pointer.value += 64
+            with pool.lease(SDMA) as again:
+                assert again is queue and emulated_device.KFD_IOCTL.queues
+                assert queue.ring.handle in emulated_device.context.allocations
+        assert not emulated_device.KFD_IOCTL.queues
+        assert len(emulated_device.context.allocations) == 0
+
+    def test_pool_grows_when_empty(self, emulated_device):
+        with QueuePool(emulated_device) as pool:
+            first, second = pool.acquire(SDMA), pool.acquire(SDMA)
+
+            assert first.queue_id != second.queue_id and pool.created == 2
+
+    def test_benchmark_pooling_is_faster(self):
+        rates = queue_pool.run(count=20)
+
+        assert rates["pooled"] > rates["unpooled"]
@@ -0,0 +1,99 @@
+import random, threading
+import pytest
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.race import (
+    InterleavingRunner,
+    destroy_vs_update_queue,
+    free_vs_map,
+    fuzz_races,
+    random_rounds,
+)
+
+
+@pytest.fixture
+def emulated_device():
+    device = EmulatedKFDDevice()
+    yield device
+    device.close()
+
+
+def recorder(log, name):
+    return name, lambda: log.append(name)
+
+
+class TestInterleaving:
+    def test_rounds_are_seeded_and_cover_all_steps(self):
+        draw = lambda seed: random_rounds([3, 1, 2, 4], random.Random(seed), 3)
+
+        rounds = draw(7)
+
+        assert rounds == draw(7) and rounds != draw(8)
+        assert all(1 <= len(r) <= 3 and len(set(r)) == len(r) for r in rounds)
+        assert [sum(t in r for r in rounds) for t in range(4)] == [3, 1, 2, 4]
+
+    def test_serial_rounds_follow_schedule(self):
+        log = []
+        scripts = [
+            [recorder(log, "a0"), recorder(log, "a1")],
+            [recorder(log, "b0")],
+        ]
+
+        result = InterleavingRunner(scripts, [(1,), (0,), (0,)]).run()
+
+        assert not result.hung and log == ["b0", "a0", "a1"]
+
+    def test_parallel_round_overlaps(self):
+        # both steps only finish if they run at the same time
+        meet = threading.Barrier(2, timeout=5)
+        scripts = [[("meet", meet.wait)], [("meet", meet.wait)]]
+
+        result = InterleavingRunner(scripts, [(0, 1)]).run()
+
+        assert not result.hung and [r.error for r in result.trace] == [None, None]
+
+    def test_hang_is_reported(self):
+        stuck = threading.Event()
+        scripts = [[("stuck", stuck.wait)], [("never", lambda: None)]]
+
+        result = InterleavingRunner(scripts, [(0,), (1,)], timeout=0.2).run()
+        stuck.set()
+
+        assert result.hung and result.trace == []
+
+
+class TestRaceScenarios:
+    def test_free_vs_map_replays(self, emulated_device):
+        serial = lambda d: fuzz_races(d, free_vs_map, range(20), max_parallel=1)
+
+        first, second = serial(emulated_device), serial(emulated_device)
+
+        assert [r.outcomes() for r in first] == [r.outcomes() for r in second]
+        outcomes = {tuple(r.outcomes()) for r in first}
+        assert (
+            (0, "free_memory_of_gpu", None),
+            (1, "map_memory_to_gpu", "RuntimeError"),
+        ) in outcomes
+        assert len(emulated_device.context.allocations) == 0
+
+    def test_destroy_vs_update_queue(self, emulated_device):
+        results = fuzz_races(
+            emulated_device, destroy_vs_update_queue, range(10), max_parallel=2
+        )
+
+        assert not any(r.hung for r in results)
+        assert all(len(r.trace) == 3 for r in results)
+        names = emulated_device.KFD_IOCTL.call_names()
+        assert names.count("create_queue") == 10 and names.count("update_queue") == 20
+
+        def updated_before_destroy(result):
+            destroy = next(r for r in result.trace if r.name == "destroy_queue")
+            return any(
+                r.name == "update_queue" and r.error is None and r.round < destroy.round
+                for r in result.trace
+            )
+
+        assert any(updated_before_destroy(r) for r in results)
+        destroys = [r for res in results for r in res.trace if r.name == "destroy_queue"]
+        assert all(r.error is None for r in destroys)
+        assert not emulated_device.KFD_IOCTL.queues
+        assert len(emulated_device.context.allocations) == 0
@@ -0,0 +1,96 @@
+import ctypes
+from fuzzyHSA.kfd import sdma
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.ops import KFDDevice
+import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu  # importing generated files via the fuzzyHSA package
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+PKTS = sdma.SDMA_PKTS
+
+
+class HostRing:
+    def __init__(self, size=256):
+        self.ring = (ctypes.c_uint8 * size)()
+        self.pointers = (ctypes.c_uint64 * 3)()  # wptr, rptr, doorbell
+        base, u64 = ctypes.addressof(self.pointers), ctypes.sizeof(ctypes.c_uint64)
+        self.writer = sdma.SDMARingWriter(
+            ctypes.addressof(self.ring), size, base, base + u64, base + 2 * u64
+        )
+
+
+class TestSDMAPackets:
+    def test_packets_are_built_once_with_merged_addresses(self):
+        assert KFDDevice.create_sdma_packets() is PKTS is sdma.create_sdma_packets()
+        pkt = PKTS.copy_linear(src_addr=0x1_2345_6789, dst_addr=0xAB_0000_0004)
+
+        assert ctypes.sizeof(pkt) == ctypes.sizeof(
+            amd_gpu.struct_SDMA_PKT_COPY_LINEAR_TAG
+        )
+        words = (ctypes.c_uint32 * 7).from_buffer_copy(pkt)
+        assert list(words[3:]) == [0x23456789, 0x1, 0x4, 0xAB]
+
+    def test_stream_matches_packet_structures(self):
+        stream = sdma.SDMAStream()
+        stream.copy_linear([0x2000, 0x1_0000_3000], [0x1000, 0x5000], [64, 4096])
+        stream.constant_fill([0x8000], [0xDEADBEEF], [256])
+        stream.fence([0x9000], [7])
+        stream.trap(int_context=5)
+
+        expected = b"".join(
+            bytes(p)
+            for p in [
+                PKTS.copy_linear(op=1, count=63, src_addr=0x1000, dst_addr=0x2000),
+                PKTS.copy_linear(
+                    op=1, count=4095, src_addr=0x5000, dst_addr=0x1_0000_3000
+                ),
+                PKTS.constant_fill(
+                    op=11,
+                    fillsize=2,
+                    dst_addr=0x8000,
+                    src_data_31_0=0xDEADBEEF,
+                    count=255,
+                ),
+                PKTS.fence(op=5, mtype=3, addr=0x9000, data=7),
+                PKTS.trap(op=6, int_context=5),
+            ]
+        )
+        assert stream.dwords.tobytes() == expected
+
+    def test_large_copies_are_split(self):
+        stream = sdma.SDMAStream()
+        stream.copy_linear([0x100000000], [0], [2 * sdma.MAX_COPY_SIZE + 8])
+
+        assert len(stream) == 3 * sdma.COPY_LINEAR_DWORDS
+        counts = stream.dwords[1 :: sdma.COPY_LINEAR_DWORDS]
+        assert list(counts) == [sdma.MAX_COPY_SIZE - 1] * 2 + [7]
+        assert stream.dwords[2 * sdma.COPY_LINEAR_DWORDS + 3] == 2 * sdma.MAX_COPY_SIZE
+
+
+class TestSDMARingWriter:
+    def test_wrap_pads_with_nops(self):
+        r = HostRing(size=64)
+        first, second = sdma.SDMAStream(), sdma.SDMAStream()
+        first.copy_linear([0], [0], [4])  # 28 bytes
+        second.fence([0x10], [1])  # 16 bytes
+        r.pointers[1] = 56
+
+        r.writer.submit(first)
+        r.writer.submit(first)
+        start = r.writer.submit(second)
+
+        assert start == 64 and r.pointers[0] == r.pointers[2] == 80
+        assert bytes(r.ring[56:64]) == bytes(8)
+        assert bytes(r.ring[:16]) == second.dwords.tobytes()
+        assert r.writer.doorbell_writes == 3
+
+    def test_sdma_queue_writer(self):
+        with EmulatedKFDDevice() as device:
+            queue = device.create_queue(kfd.KFD_IOC_QUEUE_TYPE_SDMA)
+            stream = sdma.SDMAStream()
+            stream.trap()
+
+            queue.ring_writer().submit(stream)
+
+            assert queue.write_pointer.value == 8
+            assert ctypes.c_uint64.from_address(queue.doorbell).value == 8
+            queue.destroy()
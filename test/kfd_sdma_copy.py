@@ -0,0 +1,70 @@
+import csv, ctypes, io
+from fuzzyHSA import fuzzer
+from fuzzyHSA.bench import sdma_copy
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+
+
+class TestSDMACopyBench:
+    def test_sweeps_on_the_emulated_engine(self):
+        with EmulatedKFDDevice() as device:
+            results = sdma_copy.run(
+                device, sizes=[4096, 1 << 16], depths=[1, 4], depth_size=8192, repeat=2
+            )
+
+            assert len(device.context.allocations) == 0
+            assert device.KFD_IOCTL.queues == {}
+        sizes, depths = results["sizes"], results["depths"]
+        assert [(r["direction"], r["size"]) for r in sizes[:2]] == [
+            ("host_gtt", 4096),
+            ("host_gtt", 1 << 16),
+        ]
+        assert len(sizes) == 6 and len(depths) == 6
+        assert all(r["latency_us"] > 0 and r["bandwidth"] > 0 for r in sizes)
+        assert "vram_vram" in sdma_copy.format_table(results)
+
+    def test_copies_land(self):
+        with EmulatedKFDDevice() as device, device.arena():
+            bench = sdma_copy.CopyBench(device, emulate=True)
+            with sdma_copy.buffers(bench, "gtt_vram", 8192) as (dst, src):
+                device.prefault(src, 8192)
+                ctypes_src = (ctypes.c_uint8 * 8192).from_address(src)
+                ctypes_src[:] = bytes(range(256)) * 32
+
+                bench.wait(bench.submit(dst, src, 8192))
+
+                assert bytes((ctypes.c_uint8 * 8192).from_address(dst)) == bytes(
+                    ctypes_src
+                )
+
+    def test_host_pages_outlive_their_userptr(self, monkeypatch):
+        with EmulatedKFDDevice() as device:
+            bench = sdma_copy.CopyBench(device, emulate=True)
+            allocations, munmap = device.context.allocations, device.munmap
+            live_at_munmap = []
+
+            def recording_munmap(addr, size):
+                live_at_munmap.append((addr, size, len(allocations)))
+                munmap(addr, size)
+
+            monkeypatch.setattr(device, "munmap", recording_munmap)
+            with sdma_copy.buffers(bench, "host_gtt", 8192) as (_, src):
+                live = len(allocations)
+
+            # both buffers of the arena were freed before any of their pages went
+            assert any(
+                a <= src < a + size and live_then == live - 2
+                for a, size, live_then in live_at_munmap
+            )
+
+    def test_cli_csv(self, capsys, generated_bindings):
+        fuzzer.main(
+            ["bench", "sdma", "--max-size", "16K", "--depth-size", "4K"]
+            + ["--depths", "2", "--directions", "vram_vram", "--repeat", "1", "--csv"]
+        )
+
+        rows = list(csv.DictReader(io.StringIO(capsys.readouterr().out)))
+        assert [(r["sweep"], r["size"], r["depth"]) for r in rows] == [
+            ("size", "4096", "1"),
+            ("size", "16384", "1"),
+            ("depth", "4096", "2"),
+        ]
@@ -0,0 +1,137 @@
+import ctypes
+import pytest
+from fuzzyHSA.kfd import sdma
+from fuzzyHSA.kfd.emulated import EmulatedKFD, EmulatedKFDDevice, emulated_context
+from fuzzyHSA.kfd.sdma_emu import SDMAEngine
+from kfd_sdma import HostRing
+import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu  # importing generated files via the fuzzyHSA package
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+
+def engine_for(r, trap=None):
+    base, u64 = ctypes.addressof(r.pointers), ctypes.sizeof(ctypes.c_uint64)
+    return SDMAEngine(ctypes.addressof(r.ring), len(r.ring), base, base + u64, trap)
+
+
+def addr(buf):
+    return ctypes.addressof((ctypes.c_char * len(buf)).from_buffer(buf))
+
+
+class TestSDMAEngine:
+    def test_copies_and_fences_across_the_ring_end(self):
+        r = HostRing(size=64)
+        engine = engine_for(r)
+        src, dst, fence = bytearray(b"sdma" * 4), bytearray(16), ctypes.c_uint32()
+        stream = sdma.SDMAStream()
+        stream.copy_linear([addr(dst)], [addr(src)], [16])
+        stream.fence([ctypes.addressof(fence)], [7])
+        r.pointers[0] = r.pointers[1] = 48  # the stream is padded to the start
+
+        r.writer.submit(stream)
+        executed = engine.process()
+
+        assert executed == engine.packets == 6  # 4 padding nops, copy, fence
+        assert dst == src and fence.value == 7
+        assert r.pointers[1] == r.pointers[0] == 64 + stream.nbytes
+
+    def test_constant_fills(self):
+        r = HostRing(size=256)
+        engine = engine_for(r)
+        dst = bytearray(b"x" * 48)
+        stream = sdma.SDMAStream()
+        stream.constant_fill([addr(dst)], [0x04030201], [20])
+        stream.constant_fill([addr(dst) + 20], [0x55555555], [8])
+        r.writer.submit(stream)
+        r.writer.submit(
+            bytes(
+                sdma.packet(
+                    "constant_fill",
+                    fillsize=0,
+                    dst_addr=addr(dst) + 28,
+                    src_data_31_0=0x1AB,
+                    count=2,
+                )
+            )
+        )
+
+        engine.process()
+
+        assert dst == bytes(range(1, 5)) * 5 + b"\x55" * 8 + b"\xab" * 3 + b"x" * 17
+
+    def test_poll_regmem_stalls_until_the_condition_holds(self):
+        r = HostRing(size=256)
+        traps = []
+        engine = engine_for(r, traps.append)
+        flag, fence = ctypes.c_uint32(), ctypes.c_uint32()
+        poll = sdma.packet(
+            "poll_regmem",
+            mem_poll=1,
+            func=5,
+            addr=ctypes.addressof(flag),
+            value=2,
+            mask=0xFF,
+        )
+        stream = sdma.SDMAStream()
+        stream.fence([ctypes.addressof(fence)], [1])
+        r.writer.submit(stream)
+        r.writer.submit(bytes(poll))
+        stream.trap(int_context=9)
+        r.writer.submit(stream)
+
+        stalled = engine.process(), engine.stalled, fence.value, r.pointers[1]
+        flag.value = 0x103  # masked to 3 >= 2
+        resumed = engine.process()
+
+        assert stalled == (1, True, 1, 16)
+        assert resumed == 3 and not engine.stalled and traps == [9]
+        assert r.pointers[1] == r.pointers[0]
+
+    def test_unsupported_packet_stops_the_engine(self):
+        r = HostRing(size=64)
+        engine = engine_for(r)
+        stream = sdma.SDMAStream()
+        stream.fence([ctypes.addressof(r.pointers) + 16], [0])
+        r.writer.submit(stream)
+        r.writer.submit(bytes(sdma.SDMA_PKTS.timestamp(op=amd_gpu.SDMA_OP_TIMESTAMP)))
+
+        with pytest.raises(RuntimeError, match="timestamp at rptr 0x10"):
+            engine.process()
+
+        assert r.pointers[1] == 16
+
+
+class TestEmulatedSDMAQueues:
+    def test_streams_execute_end_to_end(self):
+        context = emulated_context(ioctls=EmulatedKFD(sdma_engine=True))
+        with EmulatedKFDDevice(context=context) as device, device.arena():
+            queue = device.create_queue(kfd.KFD_IOC_QUEUE_TYPE_SDMA, ring_size=256)
+            engine = device.KFD_IOCTL.sdma_engines[queue.queue_id]
+            event = device.create_event(auto_reset=True)
+            writer = queue.ring_writer()
+            src, dst = bytearray(range(64)), bytearray(64 * 40)
+            fence = ctypes.c_uint32()
+            for i in range(40):  # 44 bytes each, wraps the ring several times
+                stream = sdma.SDMAStream()
+                stream.copy_linear([addr(dst) + 64 * i], [addr(src)], [64])
+                stream.fence([ctypes.addressof(fence)], [i + 1])
+                writer.submit(stream)
+            stream = sdma.SDMAStream()
+            stream.trap(int_context=event.event_id)
+            writer.submit(stream)
+
+            complete = kfd.KFD_IOC_WAIT_RESULT_COMPLETE
+            assert device.wait_events([event.event_id], timeout_ms=5000) == complete
+            assert fence.value == 40 and dst == bytes(range(64)) * 40
+            assert queue.read_pointer.value == queue.write_pointer.value
+            queue.destroy()
+            assert device.KFD_IOCTL.sdma_engines == {} and engine.error is None
+
+    def test_interrupt_without_event_signals_every_signal_event(self):
+        with EmulatedKFDDevice() as device, device.arena():
+            a, b = device.create_event(), device.create_event()
+
+            device.KFD_IOCTL.interrupt(0xFFFFFF)
+
+            ids = [a.event_id, b.event_id]
+            result = device.wait_events(ids, wait_for_all=True, timeout_ms=0)
+            assert result == kfd.KFD_IOC_WAIT_RESULT_COMPLETE
@@ -0,0 +1,101 @@
+import ctypes
+import os
+import shutil
+import subprocess
+import sys
+import threading
+import time
+import pytest
+from fuzzyHSA.kfd import signals
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+
+IMPLEMENTATIONS = [signals.default_atomics(), signals.PythonAtomics()]
+
+
+def delayed(seconds, fn):
+    thread = threading.Timer(seconds, fn)
+    thread.start()
+    return thread
+
+
+@pytest.mark.parametrize("atomics", IMPLEMENTATIONS, ids=lambda a: type(a).__name__)
+class TestAtomics:
+    def test_load_store_cmpxchg(self, atomics):
+        slot = ctypes.c_int64(5)
+        addr = ctypes.addressof(slot)
+
+        failed = atomics.cmpxchg(addr, 4, 9)
+        swapped = atomics.cmpxchg(addr, 5, -1)
+        atomics.store(addr, atomics.load(addr) - 1)
+
+        assert (failed, swapped, slot.value) == (5, 5, -2)
+        assert atomics.fetch_add(addr, 3) == -2 and slot.value == 1
+
+    def test_fetch_add_from_threads(self, atomics):
+        slot = ctypes.c_int64(0)
+        addr = ctypes.addressof(slot)
+
+        def add():
+            for _ in range(2000):
+                atomics.fetch_add(addr, 1)
+
+        threads = [threading.Thread(target=add) for _ in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        assert slot.value == 8000
+
+
+class TestSignalWaiter:
+    @pytest.mark.skipif(shutil.which("cc") is None, reason="needs a C compiler")
+    def test_native_helper_builds(self):
+        assert isinstance(signals.default_atomics(), signals.NativeAtomics)
+
+    def test_import_builds_no_helper(self):
+        code = (
+            "import conftest, fuzzyHSA.kfd.signals, fuzzyHSA.kfd.native as native;"
+            "assert native.build.cache_info().misses == 0"
+        )
+        path = [os.path.dirname(__file__), *sys.path]
+        env = {**os.environ, "PYTHONPATH": os.pathsep.join(path)}
+
+        subprocess.run([sys.executable, "-c", code], check=True, env=env)
+
+    def test_spin_sees_store_from_other_thread(self):
+        slot = ctypes.c_int64(1)
+        waiter = signals.SignalWaiter(spin_us=2_000_000)
+        producer = delayed(
+            0.01, lambda: signals.default_atomics().store(ctypes.addressof(slot), 0)
+        )
+
+        value = waiter.wait(ctypes.addressof(slot), signals.CONDITION_LT, 1)
+        producer.join()
+
+        assert value == 0 and (waiter.spin_hits, waiter.sleeps) == (1, 0)
+
+    def test_sleeps_in_wait_events_after_budget(self):
+        slot = ctypes.c_int64(1)
+        with EmulatedKFDDevice() as device:
+            event = device.create_event().event_id
+            waiter = signals.SignalWaiter(device, event, spin_us=0, sleep_ms=5000)
+
+            def produce():
+                slot.value = 0
+                device.set_event(event)
+
+            producer = delayed(0.02, produce)
+            start = time.monotonic()
+            value = waiter.wait(ctypes.addressof(slot), signals.CONDITION_EQ, 0)
+            producer.join()
+
+            assert value == 0 and waiter.spin_hits == 0 and waiter.sleeps == 1
+            assert time.monotonic() - start < 2
+
+    def test_timeout(self):
+        slot = ctypes.c_int64(1)
+        waiter = signals.SignalWaiter(spin_us=10, sleep_ms=1)
+
+        with pytest.raises(TimeoutError):
+            waiter.wait(ctypes.addressof(slot), signals.CONDITION_GTE, 2, timeout=0.02)
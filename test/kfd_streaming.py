@@ -0,0 +1,61 @@
+import ctypes, os, shutil, subprocess, sys
+import pytest
+from fuzzyHSA.bench import stream_copy
+from fuzzyHSA.kfd import streaming
+
+HAS_CC = bool(os.environ.get("CC") or shutil.which("cc"))
+IMPLEMENTATIONS = [streaming.copier(), streaming.PythonCopier()]
+SOURCE = bytes(range(256)) * 40
+
+
+@pytest.mark.parametrize("copier", IMPLEMENTATIONS, ids=lambda c: type(c).__name__)
+class TestCopier:
+    @pytest.mark.parametrize("offset", [0, 1, 15])
+    @pytest.mark.parametrize("size", [0, 7, 255, 256, 4099])
+    def test_copy_fill_read_stay_in_bounds(self, copier, offset, size):
+        dst = (ctypes.c_char * (size + 32))()
+        addr = ctypes.addressof(dst) + offset
+        out = bytearray(size)
+
+        copier.copy(addr, SOURCE[3 : 3 + size], size)
+        copier.read(out, addr, size)
+        copied = dst.raw
+        copier.fill(addr, 0xAB, size)
+
+        assert copied[offset : offset + size] == out == SOURCE[3 : 3 + size]
+        assert dst.raw[offset : offset + size] == b"\xab" * size
+        assert dst.raw[:offset] + dst.raw[offset + size :] == bytes(32)
+
+    def test_sources(self, copier):
+        src = (ctypes.c_uint32 * 100)(*range(100))
+        dst = (ctypes.c_uint32 * 100)()
+
+        copier.copy(ctypes.addressof(dst), memoryview(src), 400)
+
+        assert list(dst) == list(range(100))
+
+
+@pytest.mark.skipif(not HAS_CC, reason="no C compiler")
+def test_native_helper_builds():
+    assert isinstance(streaming.copier(), streaming.NativeCopier)
+
+
+def test_import_builds_no_helper():
+    # conftest stands in for the bindings in the child as well
+    code = (
+        "import conftest, fuzzyHSA.kfd.ops, fuzzyHSA.kfd.ib;"
+        "import fuzzyHSA.kfd.native as native;"
+        "assert native.build.cache_info().misses == 0"
+    )
+
+    path = [os.path.dirname(__file__), *sys.path]
+    env = {**os.environ, "PYTHONPATH": os.pathsep.join(path)}
+
+    subprocess.run([sys.executable, "-c", code], check=True, env=env)
+
+
+def test_benchmark_reports_rates():
+    results = stream_copy.run(size=1 << 20, repeat=1)
+
+    assert set(results) >= {"memmove", "stream_copy", "stream_fill", "stream_read"}
+    assert all(gbps > 0 for gbps in results.values())
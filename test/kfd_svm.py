@@ -0,0 +1,91 @@
+import mmap
+import pytest
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.svm import (
+    IntervalMap,
+    SVMDivergence,
+    SVMRangeManager,
+    fuzz_svm_attributes,
+)
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+PAGE = mmap.PAGESIZE
+BASE = 0x7F0000000000
+
+
+@pytest.fixture
+def svm():
+    return SVMRangeManager(EmulatedKFDDevice())
+
+
+class TestIntervalMap:
+    def test_update_splits_and_merges(self):
+        imap = IntervalMap(0)
+        imap.update(0, 100, lambda v: 1)
+        imap.update(40, 60, lambda v: 2)
+        assert list(imap.segments(0, 100)) == [(0, 40, 1), (40, 60, 2), (60, 100, 1)]
+
+        imap.update(40, 60, lambda v: 1)
+        assert len(imap) == 1
+        assert list(imap.segments(90, 120)) == [(90, 100, 1), (100, 120, 0)]
+
+    def test_adjacent_updates_coalesce(self):
+        imap = IntervalMap(None)
+        for i in range(64):
+            imap.update(i * PAGE, (i + 1) * PAGE, lambda v: "gpu")
+        assert len(imap) == 1 and imap.get(63 * PAGE) == "gpu"
+
+
+class TestSVMRangeManager:
+    def test_per_page_updates_flush_as_one_ioctl(self, svm):
+        for i in range(256):
+            svm.set_attributes(
+                BASE + i * PAGE, PAGE, preferred_loc=0x1000, granularity=4
+            )
+
+        assert svm.flush() == 1
+        name, _ = svm.device.KFD_IOCTL.calls[-1]
+        assert name == "svm"
+        result = svm.query(BASE, 256 * PAGE)
+        assert result[kfd.KFD_IOCTL_SVM_ATTR_PREFERRED_LOC] == 0x1000
+        assert result[kfd.KFD_IOCTL_SVM_ATTR_GRANULARITY] == 4
+
+    def test_unchanged_attributes_are_not_resent(self, svm):
+        svm.set_attributes(BASE, 16 * PAGE, preferred_loc=0)
+        svm.flush()
+        svm.set_attributes(BASE + 4 * PAGE, 4 * PAGE, preferred_loc=0)
+        assert svm.flush() == 0
+
+    def test_differing_runs_issue_one_ioctl_each(self, svm):
+        svm.set_attributes(BASE, 8 * PAGE, preferred_loc=0)
+        svm.set_attributes(BASE + 8 * PAGE, 8 * PAGE, preferred_loc=0x1000)
+        assert svm.flush() == 2
+
+    def test_prefetch_flushes_pending_attributes_first(self, svm):
+        svm.set_attributes(BASE, PAGE, access={0x1000: kfd.KFD_IOCTL_SVM_ATTR_ACCESS})
+        svm.prefetch(BASE, PAGE, 0x1000)
+
+        assert svm.ioctl_count == 2
+        result = svm.query(BASE, PAGE, [0x1000])
+        assert result[kfd.KFD_IOCTL_SVM_ATTR_PREFETCH_LOC] == 0x1000
+        assert result[("access", 0x1000)] == kfd.KFD_IOCTL_SVM_ATTR_ACCESS
+
+
+class TestSVMFuzzing:
+    @pytest.mark.parametrize("seed", range(5))
+    def test_emulated_backend_matches_shadow_model(self, svm, seed):
+        fuzz_svm_attributes(svm, BASE, 32, [0x1000, 0x2000], seed=seed, steps=150)
+
+    def test_divergence_is_reported(self, svm):
+        emulated = svm.device.KFD_IOCTL
+        original = emulated._svm
+
+        def drop_clear_flags(args):
+            for i in range(args.nattr):
+                if args.attrs[i].type == kfd.KFD_IOCTL_SVM_ATTR_CLR_FLAGS:
+                    args.attrs[i].value = 0
+            return original(args)
+
+        emulated._svm = drop_clear_flags
+        with pytest.raises(SVMDivergence):
+            fuzz_svm_attributes(svm, BASE, 16, [0x1000], seed=1, steps=300)
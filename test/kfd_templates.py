@@ -0,0 +1,139 @@
+import ctypes
+import struct
+import pytest
+from fuzzyHSA.kfd import aql, sdma
+from fuzzyHSA.kfd.templates import Patch, TemplateRecorder
+import fuzzyHSA.kfd.autogen.amd_gpu as amd_gpu  # importing generated files via the fuzzyHSA package
+import fuzzyHSA.kfd.autogen.hsa as hsa  # importing generated files via the fuzzyHSA package
+
+PKTS = sdma.SDMA_PKTS
+
+
+def pointers():
+    pointers = (ctypes.c_uint64 * 3)()  # wptr, rptr, doorbell
+    base, u64 = ctypes.addressof(pointers), ctypes.sizeof(ctypes.c_uint64)
+    return pointers, (base, base + u64, base + 2 * u64)
+
+
+def copy_template():
+    rec = TemplateRecorder("sdma")
+    rec.sdma_copy(dst=Patch("dst"), src=Patch("src", 0x1000), size=Patch("size", 64))
+    rec.sdma_fence(addr=Patch("signal"), value=Patch("value", 1))
+    return rec.finish()
+
+
+class TestSDMATemplates:
+    def test_render_patches_addresses_counts_and_values(self):
+        template = copy_template()
+
+        data = template.render(dst=0xAB_0000_0040, size=4096, signal=0x9000, value=7)
+
+        copy = PKTS.copy_linear.from_buffer_copy(data)
+        fence = PKTS.fence.from_buffer_copy(data, ctypes.sizeof(copy))
+        assert (copy.op, copy.sub_op) == (amd_gpu.SDMA_OP_COPY, 0)
+        assert (copy.dst_addr, copy.src_addr, copy.count) == (
+            0xAB_0000_0040,
+            0x1000,
+            4095,
+        )
+        assert (fence.op, fence.mtype, fence.addr, fence.data) == (5, 3, 0x9000, 7)
+
+    def test_recorded_defaults_match_the_stream_encoder(self):
+        stream = sdma.SDMAStream()
+        stream.copy_linear([0], [0x1000], [64])
+        stream.fence([0], [1])
+
+        assert copy_template().data == stream.dwords.tobytes()
+
+    def test_one_name_patches_every_use(self):
+        rec = TemplateRecorder("sdma")
+        rec.sdma_fill(dst=Patch("buf"), value=0, size=Patch("size", 4))
+        rec.sdma_copy(dst=0x5000, src=Patch("buf"), size=Patch("size", 4))
+        template = rec.finish()
+
+        data = template.render(buf=0x1_0000_0000, size=256)
+
+        fill = PKTS.constant_fill.from_buffer_copy(data)
+        copy = PKTS.copy_linear.from_buffer_copy(data, ctypes.sizeof(fill))
+        assert (fill.dst_addr, fill.count, fill.fillsize) == (0x1_0000_0000, 255, 2)
+        assert (copy.src_addr, copy.dst_addr, copy.count) == (
+            0x1_0000_0000,
+            0x5000,
+            255,
+        )
+        with pytest.raises(KeyError):
+            template.render(bogus=1)
+
+    def test_replay_rings_doorbell_once(self):
+        template = copy_template()
+        ring = (ctypes.c_uint8 * 256)()
+        ptrs, addrs = pointers()
+        writer = sdma.SDMARingWriter(ctypes.addressof(ring), len(ring), *addrs)
+
+        template.replay(writer, dst=0x2000, signal=0x9000, value=2)
+        start = template.replay(writer, dst=0x3000, signal=0x9000, value=3)
+
+        assert writer.doorbell_writes == 2 and ptrs[2] == 2 * len(template)
+        assert bytes(ring[start : start + len(template)]) == template.render(
+            dst=0x3000, signal=0x9000, value=3
+        )
+
+    def test_replay_patches_in_the_ring(self):
+        template = copy_template()
+        ring = (ctypes.c_uint8 * 256)()
+        ptrs, addrs = pointers()
+        writer = sdma.SDMARingWriter(ctypes.addressof(ring), len(ring), *addrs)
+        submitted = []
+        submit = writer.submit
+        writer.submit = lambda data, **kw: submitted.append(data) or submit(data, **kw)
+
+        with pytest.raises(KeyError):
+            template.replay(writer, bogus=1)
+        start = template.replay(writer, dst=0x3000, signal=0x9000, value=3)
+
+        # the recorded bytes go to the ring as they are, no rendered copy
+        assert len(submitted) == 1 and submitted[0] is template.data
+        assert writer.doorbell_writes == 1
+        assert bytes(ring[start : start + len(template)]) == template.render(
+            dst=0x3000, signal=0x9000, value=3
+        )
+
+
+class TestAQLAndPM4Templates:
+    def test_aql_replay_patches_kernarg_and_signal(self):
+        pkt = hsa.hsa_kernel_dispatch_packet_t(
+            header=aql.packet_header(hsa.HSA_PACKET_TYPE_KERNEL_DISPATCH),
+            grid_size_x=64,
+        )
+        rec = TemplateRecorder("aql")
+        rec.aql(pkt, kernarg_address=Patch("kernargs"), completion_signal=Patch("sig"))
+        rec.aql(aql.barrier_and_packet(), completion_signal=Patch("sig"))
+        template = rec.finish()
+        ring = (ctypes.c_uint8 * (4 * aql.AQL_PACKET_SIZE))()
+        ptrs, addrs = pointers()
+        writer = aql.AQLRingWriter(ctypes.addressof(ring), len(ring), *addrs)
+
+        template.replay(writer, kernargs=0x7000, sig=0x8000)
+
+        dispatch = hsa.hsa_kernel_dispatch_packet_t.from_buffer(ring)
+        barrier = hsa.hsa_barrier_and_packet_t.from_buffer(ring, aql.AQL_PACKET_SIZE)
+        assert (dispatch.header, dispatch.grid_size_x) == (pkt.header, 64)
+        assert dispatch.kernarg_address == 0x7000
+        assert (
+            dispatch.completion_signal.handle
+            == barrier.completion_signal.handle
+            == 0x8000
+        )
+        assert (ptrs[0], ptrs[2], writer.doorbell_writes) == (2, 1, 1)
+
+    def test_pm4_address_pair(self):
+        header = amd_gpu.PACKET3(amd_gpu.PACKET3_WRITE_DATA, 3)
+        rec = TemplateRecorder("pm4")
+        rec.pm4([header, 0, 0, 0, 0], {2: Patch("addr", size=8), 4: Patch("value")})
+        template = rec.finish()
+
+        data = template.render(addr=0x12_3456_7890, value=5)
+
+        assert struct.unpack("<5I", data) == (header, 0, 0x34567890, 0x12, 5)
+        with pytest.raises(ValueError):
+            template.replay(None, value=1)
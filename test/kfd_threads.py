@@ -0,0 +1,112 @@
+import mmap, threading
+import pytest
+from fuzzyHSA.kfd import ops
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice, emulated_context
+from fuzzyHSA.scheduler import ThreadedScheduler, multi_device_map_program
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+GTT = {
+    "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+    "mmap_flags": mmap.MAP_SHARED | mmap.MAP_ANONYMOUS,
+    "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT | kfd.KFD_IOC_ALLOC_MEM_FLAGS_WRITABLE,
+}
+
+
+@pytest.fixture
+def devices():
+    context = emulated_context()
+    pair = [EmulatedKFDDevice(gpu_id, context=context) for gpu_id in (0x1000, 0x2000)]
+    yield pair
+    for device in pair:
+        device.close()
+
+
+def run_threads(count, target):
+    threads = [threading.Thread(target=target, args=(i,)) for i in range(count)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+
+class TestThreadSafety:
+    def test_allocation_stress(self, devices):
+        errors = []
+
+        def worker(i):
+            device = devices[i % 2]
+            try:
+                for _ in range(50):
+                    mem = device.allocate_memory(mmap.PAGESIZE, GTT)
+                    device.map_memory_to_gpu(mem, [0x1000, 0x2000])
+                    device.free_gpu_memory(mem)
+            except Exception as e:
+                errors.append(e)
+
+        run_threads(16, worker)
+
+        emulated = devices[0].KFD_IOCTL
+        assert not errors
+        assert len(devices[0].context.allocations) == 0 and not emulated.allocations
+        assert len(emulated.calls) == 2 + 16 * 50 * 4  # acquire_vm per device
+
+    def test_racing_frees_release_once(self, devices):
+        mem = devices[0].allocate_memory(mmap.PAGESIZE, GTT, map_to_gpu=True)
+        barrier, outcomes = threading.Barrier(4), []
+
+        def worker(i):
+            barrier.wait()
+            try:
+                devices[i % 2].free_gpu_memory(mem)
+                outcomes.append("freed")
+            except OSError:
+                outcomes.append("rejected")
+
+        run_threads(4, worker)
+
+        assert sorted(outcomes) == ["freed"] + ["rejected"] * 3
+        assert devices[0].KFD_IOCTL.call_names().count("free_memory_of_gpu") == 1
+
+    def test_failed_unmap_keeps_allocation_recorded(self, devices, monkeypatch):
+        device = devices[0]
+        mem = device.allocate_memory(mmap.PAGESIZE, GTT, map_to_gpu=True)
+        unmap = device.KFD_IOCTL.unmap_memory_from_gpu
+
+        def failing_unmap(fd, **kwargs):
+            result = unmap(fd, **kwargs)
+            result.n_success = 0
+            return result
+
+        monkeypatch.setattr(device.KFD_IOCTL, "unmap_memory_from_gpu", failing_unmap)
+        with pytest.raises(OSError):
+            device.free_gpu_memory(mem)
+        assert mem.handle in device.context.allocations
+        monkeypatch.undo()
+
+        device.free_gpu_memory(mem)
+        assert len(device.context.allocations) == 0
+
+    def test_gpu_id_buffers_are_per_thread(self):
+        buffers = {}
+
+        def worker(i):
+            buffers[i] = ops._gpu_id_array([i, i + 1])
+            assert ops._gpu_id_array([i]) is buffers[i]
+
+        run_threads(4, worker)
+
+        assert len({id(b) for b in buffers.values()}) == 4
+        assert all(buffers[i][:2] == [i, i + 1] for i in buffers)
+
+    def test_threaded_scheduler(self, devices):
+        corpus = [
+            {"size": mmap.PAGESIZE, "gpu_ids": [0x1000, 0x2000][: 1 + i % 2]}
+            for i in range(64)
+        ]
+
+        results = ThreadedScheduler(
+            multi_device_map_program, devices, threads_per_device=8
+        ).run(corpus)
+
+        assert results == {0x1000: [1] * 32, 0x2000: [2] * 32}
+        assert len(devices[0].context.allocations) == 0
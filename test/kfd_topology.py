@@ -0,0 +1,57 @@
+import os, pickle, shutil
+import pytest
+from fuzzyHSA.kfd.topology import Topology, TOPOLOGY_ROOT_ENV
+from conftest import cpu_node, gpu_node, write_topology
+
+
+@pytest.fixture
+def topology_root(tmp_path):
+    gpu = gpu_node(0xBEEF, [(0, 20)], render_minor=130, target=90010)
+    gpu["mem_banks"] = [{"heap_type": 1, "size_in_bytes": 1 << 34}]
+    gpu["caches"] = [{"processor_id_low": 4096, "level": 1, "size": 16}] * 2
+    root = write_topology(
+        tmp_path / "nodes", {0: cpu_node(), 1: gpu, 2: {"properties": {}}}
+    )
+    yield root
+    Topology.invalidate()
+
+
+class TestTopology:
+    def test_parses_nodes_and_children(self, topology_root):
+        topology = Topology.load(topology_root)
+
+        assert [n.node_id for n in topology.nodes] == [0, 1, 2]
+        assert list(topology.gpu_ids) == [0xBEEF] and list(topology.node_ids) == [1]
+        gpu = topology.gpu(0xBEEF)
+        assert gpu.properties["drm_render_minor"] == 130
+        assert gpu.mem_banks[0]["size_in_bytes"] == 1 << 34
+        assert len(gpu.caches) == 2 and gpu.io_links[0]["node_to"] == 0
+        assert topology.nearest_cpu_node(1) == 0
+
+    def test_snapshot_is_cached_per_root(self, topology_root):
+        first = Topology.load(topology_root)
+        shutil.rmtree(topology_root)  # a cached snapshot never touches the tree again
+        assert Topology.load(str(topology_root)) is first
+
+    def test_root_from_environment(self, topology_root, monkeypatch):
+        monkeypatch.setenv(TOPOLOGY_ROOT_ENV, str(topology_root))
+        assert Topology.load().root == topology_root
+
+    def test_snapshot_survives_pickle(self, topology_root):
+        topology = pickle.loads(pickle.dumps(Topology.load(topology_root)))
+        assert topology.gpus[0].gpu_id == 0xBEEF and list(topology.gpu_ids) == [0xBEEF]
+
+    def test_forked_children_share_the_snapshot(self, topology_root):
+        topology = Topology.load(topology_root)
+        shutil.rmtree(topology_root)
+        pid = os.fork()
+        if pid == 0:
+            os._exit(
+                0 if Topology.load(topology_root).gpu_ids == topology.gpu_ids else 1
+            )
+        _, status = os.waitpid(pid, 0)
+        assert os.waitstatus_to_exitcode(status) == 0
+
+    def test_missing_topology_raises_runtime_error(self, tmp_path):
+        with pytest.raises(RuntimeError, match="KFD topology"):
+            Topology.load(tmp_path / "missing")
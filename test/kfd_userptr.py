@@ -0,0 +1,102 @@
+import ctypes, mmap
+import pytest
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.userptr import UserptrCache, buffer_address
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+
+@pytest.fixture
+def emulated_device():
+    device = EmulatedKFDDevice()
+    yield device
+    device.close()
+
+
+class TestUserptrCache:
+    def test_allocate_userptr_is_page_aligned(self, emulated_device):
+        buf = bytearray(3 * mmap.PAGESIZE)
+        addr, size = buffer_address(buf)
+
+        mem = emulated_device.allocate_userptr(addr + 16, 100, map_to_gpu=True)
+
+        assert mem.flags & kfd.KFD_IOC_ALLOC_MEM_FLAGS_USERPTR
+        assert mem.va_addr % mmap.PAGESIZE == 0 and mem.size % mmap.PAGESIZE == 0
+        assert mem.va_addr <= addr + 16 and addr + 116 <= mem.va_addr + mem.size
+        assert mem.mmap_offset == mem.va_addr
+
+    def test_hot_buffer_is_pinned_once(self, emulated_device):
+        cache = UserptrCache(emulated_device)
+        buf = bytearray(4 * mmap.PAGESIZE)
+
+        for _ in range(3):
+            with cache.register(buf) as reg:
+                assert reg.refcount == 1
+
+        assert (cache.hits, cache.misses) == (2, 1)
+        assert emulated_device.KFD_IOCTL.call_names().count("alloc_memory_of_gpu") == 1
+
+    def test_subrange_hits_existing_registration(self, emulated_device):
+        cache = UserptrCache(emulated_device)
+        buf = bytearray(4 * mmap.PAGESIZE)
+        addr, size = buffer_address(buf)
+
+        outer = cache.acquire(addr, size)
+        inner = cache.acquire(addr + mmap.PAGESIZE, 64)
+
+        assert inner is outer
+        assert inner.gpu_address(addr + mmap.PAGESIZE) == outer.mem.va_addr + (
+            addr + mmap.PAGESIZE - outer.start
+        )
+
+    def test_eviction_frees_without_unmapping_host_memory(self, emulated_device):
+        cache = UserptrCache(emulated_device, max_bytes=2 * mmap.PAGESIZE)
+        buffers = [bytearray(mmap.PAGESIZE * 2) for _ in range(3)]
+
+        for buf in buffers:
+            with cache.register(buf):
+                pass
+
+        assert cache.pinned_bytes <= 2 * mmap.PAGESIZE
+        assert len(emulated_device.KFD_IOCTL.allocations) == len(cache.entries)
+        buffers[0][0] = 0xAB  # host memory must still be valid after eviction
+        names = emulated_device.KFD_IOCTL.call_names()
+        assert names.index("unmap_memory_from_gpu") < names.index("free_memory_of_gpu")
+
+    def test_referenced_registrations_are_not_evicted(self, emulated_device):
+        cache = UserptrCache(emulated_device, max_bytes=0)
+        buf = bytearray(mmap.PAGESIZE)
+        addr, size = buffer_address(buf)
+
+        reg = cache.acquire(addr, size)
+        assert cache.entries
+        cache.release(reg)
+        assert not cache.entries
+
+    def test_invalidate_unregisters_overlapping_ranges(self, emulated_device):
+        cache = UserptrCache(emulated_device)
+        region = mmap.mmap(-1, 4 * mmap.PAGESIZE)
+        addr = ctypes.addressof(ctypes.c_char.from_buffer(region))
+
+        cache.release(cache.acquire(addr, mmap.PAGESIZE))
+        cache.release(cache.acquire(addr + 2 * mmap.PAGESIZE, mmap.PAGESIZE))
+        cache.invalidate(addr, mmap.PAGESIZE)
+
+        assert len(cache.entries) == 1
+        cache.clear()
+        assert not emulated_device.KFD_IOCTL.allocations
+
+    def test_partial_overlap_grows_registration_to_union(self, emulated_device):
+        cache = UserptrCache(emulated_device)
+        region = mmap.mmap(-1, 4 * mmap.PAGESIZE)
+        addr = ctypes.addressof(ctypes.c_char.from_buffer(region))
+
+        cache.release(cache.acquire(addr, 2 * mmap.PAGESIZE))
+        reg = cache.acquire(addr + mmap.PAGESIZE, 2 * mmap.PAGESIZE)
+
+        assert (reg.start, reg.end) == (addr, addr + 3 * mmap.PAGESIZE)
+        assert list(cache.entries) == [(reg.start, reg.end)]
+        assert len(emulated_device.KFD_IOCTL.allocations) == 1
+        with pytest.raises(RuntimeError):
+            cache.acquire(addr + 2 * mmap.PAGESIZE, 2 * mmap.PAGESIZE)
+        cache.release(reg)
+        cache.clear()
@@ -0,0 +1,65 @@
+import mmap, os
+from types import SimpleNamespace
+import pytest
+from fuzzyHSA.kfd import vram
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice
+from fuzzyHSA.kfd.ops import KFDDevice
+import fuzzyHSA.kfd.autogen.kfd as kfd  # importing generated files via the fuzzyHSA package
+
+GTT = {
+    "mmap_prot": mmap.PROT_READ | mmap.PROT_WRITE,
+    "mmap_flags": mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS,
+    "kfd_flags": kfd.KFD_IOC_ALLOC_MEM_FLAGS_GTT,
+}
+
+
+def backing_bytes(device, mem, size):
+    return os.pread(device.KFD_IOCTL.bo_file().fileno(), size, mem.mmap_offset)
+
+
+class TestHostVisibleVRAM:
+    def test_mapping_goes_through_mmap_offset(self):
+        with EmulatedKFDDevice() as device:
+            a = device.allocate_memory(3 * 4096, vram.vram_config(), map_to_gpu=True)
+            b = device.allocate_memory(4096, vram.vram_config())
+
+            vram.upload(a, b"\x11" * 100, offset=4096)
+            vram.upload(b, bytearray(b"\x22" * 64))
+
+            assert a.host_mapped and b.host_mapped
+            assert b.mmap_offset >= a.mmap_offset + a.size
+            assert backing_bytes(device, a, 4096 + 101)[4096:] == b"\x11" * 100 + b"\0"
+            assert backing_bytes(device, b, 64) == b"\x22" * 64
+            device.free_gpu_memory(a)
+            device.free_gpu_memory(b)
+            assert len(device.context.allocations) == 0
+
+    def test_copies(self):
+        with EmulatedKFDDevice() as device, device.arena():
+            mem = device.allocate_memory(8192, vram.vram_config())
+            staging = device.allocate_memory(4096, GTT)
+            os.pwrite(device.KFD_IOCTL.bo_file().fileno(), b"abc", staging.mmap_offset)
+            vram.fill(mem, 0x5A, 8192)
+            vram.upload(mem, memoryview(b"xyz"), offset=10)
+            vram.upload_from(mem, staging.va_addr, 4, offset=8188)
+
+            assert vram.download(mem, 16) == b"\x5a" * 10 + b"xyz" + b"\x5a" * 3
+            assert vram.download(mem, 4, offset=8188) == bytes(4)  # not the BO bytes
+            with pytest.raises(AssertionError):
+                vram.upload(mem, b"x", offset=8192)
+            with pytest.raises(AssertionError):
+                vram.download(staging, 4)
+
+    def test_explicit_host_map_of_gtt(self):
+        with EmulatedKFDDevice() as device, device.arena():
+            mem = device.allocate_memory(4096, {**GTT, "host_map": True})
+            vram.upload(mem, b"gtt")
+
+            assert backing_bytes(device, mem, 3) == b"gtt"
+
+    def test_mmap_fd_follows_buffer_type(self):
+        device = SimpleNamespace(kfd=3, drm_fd=4)
+
+        assert KFDDevice.mmap_fd(device, kfd.KFD_IOC_ALLOC_MEM_FLAGS_VRAM) == 4
+        assert KFDDevice.mmap_fd(device, kfd.KFD_IOC_ALLOC_MEM_FLAGS_MMIO_REMAP) == 3
+        assert KFDDevice.mmap_fd(device, kfd.KFD_IOC_ALLOC_MEM_FLAGS_DOORBELL) == 3
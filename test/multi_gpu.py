@@ -0,0 +1,91 @@
+import os
+import pytest
+from fuzzyHSA.kfd.emulated import EmulatedKFDDevice, emulated_context
+from fuzzyHSA.kfd.topology import Topology
+from fuzzyHSA.scheduler import (
+    MultiGPUScheduler,
+    multi_device_corpus,
+    multi_device_map_program,
+)
+from conftest import cpu_node, gpu_node, write_topology
+
+
+@pytest.fixture
+def eight_gpus(tmp_path):
+    nodes = {0: cpu_node()}
+    nodes.update({i: gpu_node(0x100 * i, [(0, 20)]) for i in range(1, 9)})
+    yield Topology.load(write_topology(tmp_path / "nodes", nodes))
+    Topology.invalidate()
+
+
+def emulated_factory(topology):
+    # the devices of one worker share an emulated driver, like GPUs of one process
+    contexts = {}
+
+    def factory(index):
+        context = contexts.setdefault(os.getpid(), emulated_context(topology))
+        return EmulatedKFDDevice(gpu_id=topology.gpu_ids[index], context=context)
+
+    return factory
+
+
+def whoami(device, testcase):
+    return device.gpu_id, testcase, os.getpid()
+
+
+def map_and_count_ioctls(device, testcase):
+    before = device.KFD_IOCTL.call_names().count("map_memory_to_gpu")
+    mapped = multi_device_map_program(device, testcase)
+    after = device.KFD_IOCTL.call_names().count("map_memory_to_gpu")
+    return mapped, after - before
+
+
+class TestMultiGPUScheduler:
+    def test_every_gpu_runs_its_own_shard(self, eight_gpus):
+        scheduler = MultiGPUScheduler(
+            whoami,
+            eight_gpus,
+            workers_per_gpu=2,
+            device_factory=emulated_factory(eight_gpus),
+            pin=False,
+        )
+        corpus = list(range(40))
+
+        results = scheduler.run(corpus)
+
+        assert sorted(results) == sorted(eight_gpus.gpu_ids)
+        seen = []
+        for gpu_id, shard_results in results.items():
+            assert {r[0] for r in shard_results} == {gpu_id}
+            assert [r[1] for r in shard_results] == scheduler.shard(corpus)[gpu_id]
+            assert os.getpid() not in {r[2] for r in shard_results}
+            seen += [r[1] for r in shard_results]
+        assert sorted(seen) == corpus
+
+    def test_multi_device_program_maps_with_one_ioctl(self, eight_gpus):
+        corpus = multi_device_corpus(eight_gpus, 24, seed=3)
+        scheduler = MultiGPUScheduler(
+            map_and_count_ioctls,
+            eight_gpus,
+            device_factory=emulated_factory(eight_gpus),
+            pin=False,
+            peers=True,
+        )
+
+        results = scheduler.run(corpus)
+
+        by_gpu = scheduler.shard(corpus)
+        for gpu_id, shard_results in results.items():
+            for testcase, (mapped, ioctls) in zip(by_gpu[gpu_id], shard_results):
+                assert mapped == len(testcase["gpu_ids"]) and ioctls == 1
+
+    def test_multi_device_program_needs_peer_vms(self, eight_gpus):
+        factory = emulated_factory(eight_gpus)
+        device = factory(0)
+        testcase = {"size": 4096, "gpu_ids": list(eight_gpus.gpu_ids[:2])}
+
+        with pytest.raises(ValueError, match="No GPU VM"):
+            multi_device_map_program(device, testcase)
+        factory(1)
+        assert multi_device_map_program(device, testcase) == 2
+        assert device.KFD_IOCTL.call_names().count("acquire_vm") == 2